@@ -26,8 +26,8 @@ class SceneNode{
 public:
     // A SceneNode is created by taking
     // a pointer to an object.
-    // For now, we also specify the shader paths as well (TODO: Implement a shader manager here
-    //                                                          instead for a cleaner code..
+    // For now, we also specify the shader paths as well. Shaders are
+    // shared between nodes through the ShaderManager.
     SceneNode(std::shared_ptr<Object> ob, std::string vertShader, std::string fragShader);
     // Our destructor takes care of destroying
     // all of the children within the node.
@@ -45,8 +45,9 @@ public:
     Transform& GetLocalTransform();
     // Returns a SceneNode's world transform
     Transform& GetWorldTransform();
-    // For now we have one shader per Node.
-    std::shared_ptr<Shader> m_shader; 
+    // Shader used by this node (shared with other nodes
+    // that were created with the same shader files).
+    std::shared_ptr<Shader> m_shader;
     
     // NOTE: Protected members are accessible by anything
     // that we inherit from, as well as ?
@@ -25,12 +25,17 @@ public:
     Shader();
     // Shader Destructor
     ~Shader();
+    // A shader owns an OpenGL program, so it cannot be copied.
+    // Use the ShaderManager to share a program between objects.
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
     // Use this shader in our pipeline.
+    // Does nothing if this shader is already in use.
     void Bind() const;
     // Remove shader from our pipeline
     void Unbind() const;
     // Load a shader
-    std::string LoadShader(const std::string& fname);
+    static std::string LoadShader(const std::string& fname);
     // Create a Shader from a loaded vertex and fragment shader
     void CreateShader(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
     // return the shader id
@@ -49,10 +54,12 @@ private:
     // Shader loading utility programs
     void PrintProgramLog( GLuint program );
     void PrintShaderLog( GLuint shader );
-    // Logs an error message 
-    void Log(const char* system, const char* message);
+    // Logs an error message
+    static void Log(const char* system, const char* message);
     // The unique shaderID
-    GLuint m_shaderID;
+    GLuint m_shaderID{0};
+    // The program most recently passed to glUseProgram
+    static GLuint s_boundShaderID;
 };
 
 #endif
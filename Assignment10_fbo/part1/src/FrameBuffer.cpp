@@ -7,18 +7,16 @@
 
 #include "Framebuffer.hpp"
 #include "Shader.hpp"
+#include "ShaderManager.hpp"
 
 #include <glad/glad.h>
 
 
 Framebuffer::Framebuffer(){
     // (1) ======= Setup shader
-    m_fboShader = std::make_shared<Shader>();
     // Setup shaders for the Framebuffer Object
-    std::string fboVertexShader = m_fboShader->LoadShader("./shaders/fboVert.glsl");
-    std::string fboFragmentShader = m_fboShader->LoadShader("./shaders/fboFrag.glsl");
-    // Actually create our shader
-    m_fboShader->CreateShader(fboVertexShader,fboFragmentShader);       
+    m_fboShader = ShaderManager::Instance().LoadShader("./shaders/fboVert.glsl",
+                                                       "./shaders/fboFrag.glsl");
     // (2) ======= Setup quad to draw to
     // Setup the screen quad
     // x and y of 0.0 put the quad in the top left corner
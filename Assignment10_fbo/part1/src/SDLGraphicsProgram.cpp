@@ -1,6 +1,7 @@
 #include "SDLGraphicsProgram.hpp"
 #include "Camera.hpp"
 #include "Terrain.hpp"
+#include "ShaderManager.hpp"
 // Include the 'Renderer.hpp' which deteremines what
 // the graphics API is going to be for OpenGL
 #include "Renderer.hpp"
@@ -70,6 +71,8 @@ SDLGraphicsProgram::SDLGraphicsProgram(int w, int h){
 
 // Proper shutdown of SDL and destroy initialized objects
 SDLGraphicsProgram::~SDLGraphicsProgram(){
+    // Release our shaders while the OpenGL context still exists
+    ShaderManager::Instance().RemoveAll();
     //Destroy window
 	SDL_DestroyWindow( m_window );
 	// Point m_window to NULL to ensure it points to nothing.
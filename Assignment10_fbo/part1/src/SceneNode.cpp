@@ -1,4 +1,5 @@
 #include "SceneNode.hpp"
+#include "ShaderManager.hpp"
 
 #include <string>
 #include <iostream>
@@ -11,14 +12,10 @@ SceneNode::SceneNode(std::shared_ptr<Object> ob, std::string vertShader, std::st
     // By default no parent.
     m_parent = nullptr;
 	
-    // Create shader
-    m_shader = std::make_shared<Shader>();
-	// Setup shaders for the node.
-	std::string vertexShader   = m_shader->LoadShader(vertShader);
-	std::string fragmentShader = m_shader->LoadShader(fragShader);
-
-	// Actually create our shader
-	m_shader->CreateShader(vertexShader,fragmentShader);       
+    // Setup shaders for the node.
+    // Nodes using the same shader files share one program,
+    // so it is only compiled for the first node.
+    m_shader = ShaderManager::Instance().LoadShader(vertShader,fragShader);
 }
 
 // The destructor 
@@ -49,6 +46,9 @@ void SceneNode::Draw(){
 	m_shader->Bind();
 	// Render our object
 	if(m_object!=nullptr){
+		// The program is shared with other nodes, so our own model
+		// matrix has to be set right before we draw.
+		m_shader->SetUniformMatrix4fv("model", &m_worldTransform.GetInternalMatrix()[0][0]);
 		// Render our object
 		m_object->Render();
 		// For any 'child nodes' also call the drawing routine.
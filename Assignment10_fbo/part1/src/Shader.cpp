@@ -3,24 +3,36 @@
 #include <iostream>
 #include <fstream>
 
+// Many objects share the same shader, so we remember which
+// program is in use and skip redundant calls to glUseProgram.
+GLuint Shader::s_boundShaderID = 0;
+
 // Constructor
 Shader::Shader(){}
 
 // Destructor
 Shader::~Shader(){
+	// The id may be reused by a new program, so forget it.
+	if(s_boundShaderID == m_shaderID){
+		s_boundShaderID = 0;
+	}
 	// Deallocate Program
 	glDeleteProgram(m_shaderID);
 }
 
 // Use our shader
 void Shader::Bind() const{
-	glUseProgram(m_shaderID);
+	if(s_boundShaderID != m_shaderID){
+		glUseProgram(m_shaderID);
+		s_boundShaderID = m_shaderID;
+	}
 }
 
 
 // Turns off our shader
 void Shader::Unbind() const{
 	glUseProgram(0);
+	s_boundShaderID = 0;
 }
 
 void Shader::Log(const char* system, const char* message){
@@ -0,0 +1,62 @@
+#include "ShaderManager.hpp"
+
+#include <functional>
+#include <iostream>
+
+ShaderManager& ShaderManager::Instance(){
+    static ShaderManager* instance = new ShaderManager();
+    return *instance;
+}
+
+// Looks up a shader by the files it came from, so that the
+// shader files are only read from disk the first time.
+std::shared_ptr<Shader> ShaderManager::LoadShader(const std::string& vertexShaderPath,
+                                                  const std::string& fragmentShaderPath){
+    // '\n' cannot appear in either path, so it is a safe separator
+    std::string key = vertexShaderPath + "\n" + fragmentShaderPath;
+    auto it = m_shadersByPath.find(key);
+    if(it != m_shadersByPath.end()){
+        return it->second;
+    }
+
+    std::string vertexShaderSource   = Shader::LoadShader(vertexShaderPath);
+    std::string fragmentShaderSource = Shader::LoadShader(fragmentShaderPath);
+    std::shared_ptr<Shader> shader = CreateShader(vertexShaderSource, fragmentShaderSource);
+    m_shadersByPath[key] = shader;
+    return shader;
+}
+
+// Compiles and links a program only if one with the
+// exact same source has not already been created.
+std::shared_ptr<Shader> ShaderManager::CreateShader(const std::string& vertexShaderSource,
+                                                    const std::string& fragmentShaderSource){
+    std::size_t hash = std::hash<std::string>{}(vertexShaderSource) ^
+                       (std::hash<std::string>{}(fragmentShaderSource) * 31);
+
+    // Check every program with this hash for an exact match
+    auto range = m_shaders.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it){
+        if(it->second.vertexShaderSource == vertexShaderSource &&
+           it->second.fragmentShaderSource == fragmentShaderSource){
+            return it->second.shader;
+        }
+    }
+
+    std::cout << "(ShaderManager.cpp) Compiling a new shader program\n";
+    ShaderEntry entry;
+    entry.vertexShaderSource = vertexShaderSource;
+    entry.fragmentShaderSource = fragmentShaderSource;
+    entry.shader = std::make_shared<Shader>();
+    entry.shader->CreateShader(vertexShaderSource, fragmentShaderSource);
+    m_shaders.emplace(hash, entry);
+    return entry.shader;
+}
+
+unsigned int ShaderManager::GetProgramCount() const{
+    return m_shaders.size();
+}
+
+void ShaderManager::RemoveAll(){
+    m_shadersByPath.clear();
+    m_shaders.clear();
+}
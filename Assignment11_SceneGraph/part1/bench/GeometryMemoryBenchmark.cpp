@@ -0,0 +1,247 @@
+/* Benchmark for the memory used while building and uploading a mesh
+ *
+ * Builds a terrain of 1000 x 1000 vertices (one million vertices and
+ * six million indices), uploads it and reports how much memory the
+ * process needed at its peak, and how much it still holds once the
+ * mesh is on the GPU. Each way of building runs in its own child
+ * process, so every peak is measured from a fresh start:
+ *  - separate: the vertices kept in five separate arrays, interleaved
+ *    into a sixth with push_back and kept after uploading (how
+ *    Geometry used to store them),
+ *  - interleaved: Geometry, which stores its vertices interleaved and
+ *    frees them after Mesh::Upload, without calling Reserve,
+ *  - reserved: the same, calling Geometry::Reserve first,
+ *  - reserved + frames: the same, with ComputeTangentFrames as well.
+ * A hidden window is created so that there is a real OpenGL context.
+ * Note that a software driver (such as llvmpipe) keeps the GPU's copy
+ * in our process as well.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py GeometryMemoryBenchmark
+ *
+ * Run with: ./GeometryMemoryBenchmark [vertices along each side]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "Mesh.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+enum class Method { Separate, Interleaved, Reserved, ReservedFrames };
+
+// What a child process sends back to the parent
+struct Measurement {
+  long baseKB;   // Memory in use before building
+  long afterKB;  // Memory still in use once the mesh is uploaded
+  double ms;     // Time to build and upload
+  bool ok;
+};
+
+// The memory our process is using right now
+static long ResidentKB() {
+  long pages = 0, resident = 0;
+  FILE *file = std::fopen("/proc/self/statm", "r");
+  if (file != nullptr) {
+    if (std::fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+      resident = 0;
+    }
+    std::fclose(file);
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// The height and texture coordinates of the terrain at grid point x, z
+static float Height(unsigned int x, unsigned int z) {
+  return 2.0f * std::sin(x * 0.05f) * std::cos(z * 0.03f);
+}
+
+// Builds the terrain the way Geometry stored vertices before: one
+// array per attribute, then interleaved into another, all of which
+// are kept alive with the mesh.
+struct SeparateArrays {
+  std::vector<float> positions, texCoords, normals, tangents, bitangents;
+  std::vector<float> bufferData;
+  std::vector<unsigned int> indices;
+  GLuint vertexBuffer{0};
+  GLuint indexBuffer{0};
+
+  ~SeparateArrays() {
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+  }
+};
+
+static void BuildSeparate(SeparateArrays &mesh, unsigned int side) {
+  for (unsigned int z = 0; z < side; ++z) {
+    for (unsigned int x = 0; x < side; ++x) {
+      mesh.positions.push_back((float)x);
+      mesh.positions.push_back(Height(x, z));
+      mesh.positions.push_back((float)z);
+      mesh.texCoords.push_back((float)x / (side - 1));
+      mesh.texCoords.push_back((float)z / (side - 1));
+      for (std::vector<float> *placeholder :
+           {&mesh.normals, &mesh.tangents, &mesh.bitangents}) {
+        placeholder->push_back(0.0f);
+        placeholder->push_back(0.0f);
+        placeholder->push_back(1.0f);
+      }
+    }
+  }
+  for (unsigned int z = 0; z + 1 < side; ++z) {
+    for (unsigned int x = 0; x + 1 < side; ++x) {
+      unsigned int first = z * side + x;
+      for (unsigned int index : {first, first + side, first + 1, first + 1,
+                                 first + side, first + side + 1}) {
+        mesh.indices.push_back(index);
+      }
+    }
+  }
+  for (std::size_t i = 0; i < mesh.positions.size() / 3; ++i) {
+    for (int c = 0; c < 3; ++c) mesh.bufferData.push_back(mesh.positions[i * 3 + c]);
+    for (int c = 0; c < 3; ++c) mesh.bufferData.push_back(mesh.normals[i * 3 + c]);
+    for (int c = 0; c < 2; ++c) mesh.bufferData.push_back(mesh.texCoords[i * 2 + c]);
+    for (int c = 0; c < 3; ++c) mesh.bufferData.push_back(mesh.tangents[i * 3 + c]);
+    for (int c = 0; c < 3; ++c) mesh.bufferData.push_back(mesh.bitangents[i * 3 + c]);
+  }
+  // Only the buffers matter here, so no vertex array is made
+  glBindVertexArray(0);
+  glGenBuffers(1, &mesh.vertexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, mesh.bufferData.size() * sizeof(float),
+               mesh.bufferData.data(), GL_STATIC_DRAW);
+  glGenBuffers(1, &mesh.indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(),
+               GL_STATIC_DRAW);
+}
+
+// Builds the terrain with Geometry and uploads it with Mesh
+static void BuildGeometry(Mesh &mesh, unsigned int side, bool reserve,
+                          bool frames) {
+  Geometry &geometry = mesh.GetGeometry();
+  if (reserve) {
+    geometry.Reserve(side * side, (side - 1) * (side - 1) * 6);
+  }
+  for (unsigned int z = 0; z < side; ++z) {
+    for (unsigned int x = 0; x < side; ++x) {
+      geometry.AddVertex((float)x, Height(x, z), (float)z,
+                         (float)x / (side - 1), (float)z / (side - 1));
+    }
+  }
+  for (unsigned int z = 0; z + 1 < side; ++z) {
+    for (unsigned int x = 0; x + 1 < side; ++x) {
+      unsigned int first = z * side + x;
+      geometry.MakeTriangle(first, first + side, first + 1);
+      geometry.MakeTriangle(first + 1, first + side, first + side + 1);
+    }
+  }
+  if (frames) {
+    geometry.ComputeTangentFrames();
+  }
+  mesh.Upload();
+}
+
+// Runs in the child process
+static Measurement Measure(Method method, unsigned int side) {
+  Measurement result{0, 0, 0.0, false};
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_Window *window = SDL_CreateWindow(
+      "geometrymemorybench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+      64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context =
+      window != nullptr ? SDL_GL_CreateContext(window) : nullptr;
+  if (context == nullptr || !gladLoadGLLoader(SDL_GL_GetProcAddress)) {
+    return result;
+  }
+  // Warm the driver up, so its own allocations are not counted
+  {
+    Mesh warmUp;
+    BuildGeometry(warmUp, 2, true, false);
+  }
+  glFinish();
+
+  result.baseKB = ResidentKB();
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<SeparateArrays> separate;
+  std::unique_ptr<Mesh> mesh;
+  if (method == Method::Separate) {
+    separate.reset(new SeparateArrays());
+    BuildSeparate(*separate, side);
+  } else {
+    mesh.reset(new Mesh());
+    BuildGeometry(*mesh, side, method != Method::Interleaved,
+                  method == Method::ReservedFrames);
+  }
+  glFinish();
+  result.ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  result.afterKB = ResidentKB();
+  result.ok = true;
+  return result;
+}
+
+int main(int argc, char **argv) {
+  unsigned int side = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const char *names[] = {"separate", "interleaved", "reserved",
+                         "reserved + frames"};
+  const Method methods[] = {Method::Separate, Method::Interleaved,
+                            Method::Reserved, Method::ReservedFrames};
+
+  std::printf("Terrain of %u x %u vertices (%u vertices, %u indices)\n", side,
+              side, side * side, (side - 1) * (side - 1) * 6);
+  std::printf("Vertex data %.1f MB, index data %.1f MB\n",
+              side * side * 14 * sizeof(float) / 1e6,
+              (side - 1) * (side - 1) * 6 * sizeof(unsigned int) / 1e6);
+  std::printf("%-18s %12s %12s %10s\n", "method", "peak MB", "kept MB",
+              "ms");
+  for (int i = 0; i < 4; ++i) {
+    int channel[2];
+    if (pipe(channel) != 0) {
+      return 1;
+    }
+    std::fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+      // Keep the logging out of the table
+      std::ostringstream sink;
+      std::cout.rdbuf(sink.rdbuf());
+      Measurement result = Measure(methods[i], side);
+      ssize_t written = write(channel[1], &result, sizeof(result));
+      _exit(written == sizeof(result) ? 0 : 1);
+    }
+    Measurement result{0, 0, 0.0, false};
+    ssize_t bytes = read(channel[0], &result, sizeof(result));
+    int status = 0;
+    struct rusage usage;
+    wait4(child, &status, 0, &usage);
+    close(channel[0]);
+    close(channel[1]);
+    if (bytes != sizeof(result) || !result.ok) {
+      std::printf("%-18s failed (no OpenGL context?)\n", names[i]);
+      continue;
+    }
+    // ru_maxrss is in KB on Linux. Both numbers leave out what the
+    // process used before building.
+    std::printf("%-18s %12.1f %12.1f %10.1f\n", names[i],
+                (usage.ru_maxrss - result.baseKB) / 1024.0,
+                (result.afterKB - result.baseKB) / 1024.0, result.ms);
+  }
+  return 0;
+}
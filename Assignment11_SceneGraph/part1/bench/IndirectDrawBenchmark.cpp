@@ -0,0 +1,258 @@
+/* Benchmark for indirect drawing
+ *
+ * Builds scenes of 1,000, 10,000 and 100,000 objects. Each object
+ * uses one of 128 meshes (spheres of 64 different tessellations, in
+ * both vertex formats) and one of two textures, picked at random.
+ * Every mesh lives in the GeometryArena, so all meshes of a vertex
+ * format share one vertex array. Each scene is drawn four ways:
+ *   direct        - one glDrawElementsInstanced per object
+ *   instanced     - one glDrawElementsInstanced per batch (objects
+ *                   sharing a mesh, texture and shader)
+ *   indirect      - one indirect command per object, and one
+ *                   glMultiDrawElementsIndirect per shader and texture
+ *   indirect+inst - one indirect command per batch, and the same
+ *                   calls as 'indirect'
+ * and the time to Update and Render (submit, before the driver has
+ * finished) is printed. Each indirect image is read back and compared
+ * with the direct path that makes the same draws, so the benchmark
+ * also checks that indirect drawing is correct. A hidden window is
+ * created so that there is a real OpenGL context. Indirect drawing
+ * needs OpenGL 4.3, which Mesa's llvmpipe provides.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py IndirectDrawBenchmark
+ *
+ * Run with: ./IndirectDrawBenchmark [object counts...]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "GeometryArena.hpp"
+#include "IndirectDraw.hpp"
+#include "Object.hpp"
+#include "Renderer.hpp"
+#include "SceneNode.hpp"
+#include "ShaderManager.hpp"
+#include "Sphere.hpp"
+#include "VertexArrayCache.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+const int WIDTH = 640, HEIGHT = 480;
+
+// Timings for one way of drawing the scene
+struct Result {
+  double updateMS;
+  double renderMS;
+  double frameMS;
+  unsigned int drawCalls;
+  unsigned int commands;
+  std::vector<unsigned char> pixels;
+};
+
+// One way of drawing
+struct Path {
+  const char *name;
+  bool instancing;
+  bool indirect;
+  // The path whose image this one should match (-1 for none)
+  int compareWith;
+};
+
+static double ElapsedMS(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Draws 'frames' frames and returns the average time of each step,
+// and the pixels of the last frame
+static Result RunFrames(Renderer &renderer, int frames) {
+  Result result{0.0, 0.0, 0.0, 0, 0, {}};
+  for (int frame = 0; frame < frames; ++frame) {
+    glFinish();
+    auto frameStart = std::chrono::steady_clock::now();
+    auto start = frameStart;
+    renderer.Update();
+    result.updateMS += ElapsedMS(start);
+    start = std::chrono::steady_clock::now();
+    renderer.Render();
+    result.renderMS += ElapsedMS(start);
+    glFinish();
+    result.frameMS += ElapsedMS(frameStart);
+  }
+  result.updateMS /= frames;
+  result.renderMS /= frames;
+  result.frameMS /= frames;
+  result.drawCalls = renderer.GetDrawCallCount();
+  result.commands = renderer.GetIndirectCommandCount();
+  result.pixels.resize(WIDTH * HEIGHT * 3);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGB, GL_UNSIGNED_BYTE,
+               result.pixels.data());
+  return result;
+}
+
+// Number of pixels that differ between two images
+static unsigned int CountDifferences(const std::vector<unsigned char> &a,
+                                     const std::vector<unsigned char> &b) {
+  unsigned int different = 0;
+  for (std::size_t i = 0; i < a.size(); i += 3) {
+    different += a[i] != b[i] || a[i + 1] != b[i + 1] || a[i + 2] != b[i + 2];
+  }
+  return different;
+}
+
+// Builds a scene of 'count' objects, draws it every way and prints
+// the results
+static void RunScene(unsigned int count,
+                     const std::vector<std::unique_ptr<Object>> &objects,
+                     const std::vector<Path> &paths) {
+  std::vector<Result> results;
+  {
+    Renderer renderer(WIDTH, HEIGHT);
+    renderer.GetCamera(0)->SetCameraEyePosition(0.0f, 0.0f, 30.0f);
+
+    // An empty root, with every object on a disc facing the camera,
+    // so that they are all on screen (and none are culled) and none
+    // overlap.
+    SceneNode *root = new SceneNode(nullptr);
+    renderer.setRoot(root);
+    std::mt19937 random(count);
+    const float discRadius = 11.0f;
+    float spacing = discRadius * std::sqrt(3.14159f / count);
+    float scale = 0.35f * spacing;
+    for (unsigned int i = 0; i < count; ++i) {
+      SceneNode *node = new SceneNode(objects[random() % objects.size()].get());
+      float angle = i * 2.39996f;
+      float radius = discRadius * std::sqrt((i + 0.5f) / count);
+      node->GetLocalTransform().Translate(radius * std::cos(angle),
+                                          radius * std::sin(angle), 0.0f);
+      node->GetLocalTransform().Scale(scale, scale, scale);
+      root->AddChild(node);
+    }
+
+    // Fewer frames for bigger scenes, since llvmpipe draws them slowly
+    int frames = count >= 100000 ? 3 : (count >= 10000 ? 5 : 20);
+    for (const Path &path : paths) {
+      renderer.SetInstancing(path.instancing);
+      renderer.SetIndirectDrawing(path.indirect);
+      // Warm up (sorts the tree and allocates every buffer)
+      RunFrames(renderer, 2);
+      results.push_back(RunFrames(renderer, frames));
+    }
+    delete root;
+  }
+
+  std::printf("\n%u objects\n", count);
+  std::printf("%-14s %10s %9s %10s %10s %10s  %s\n", "path", "draw calls",
+              "commands", "update ms", "render ms", "frame ms", "image");
+  for (std::size_t p = 0; p < paths.size(); ++p) {
+    const Result &result = results[p];
+    std::printf("%-14s %10u %9u %10.2f %10.3f %10.2f  ", paths[p].name,
+                result.drawCalls, result.commands, result.updateMS,
+                result.renderMS, result.frameMS);
+    if (paths[p].compareWith < 0) {
+      std::printf("reference\n");
+    } else {
+      unsigned int different = CountDifferences(
+          result.pixels, results[paths[p].compareWith].pixels);
+      if (different == 0) {
+        std::printf("same as %s\n", paths[paths[p].compareWith].name);
+      } else {
+        std::printf("%u pixels differ from %s\n", different,
+                    paths[paths[p].compareWith].name);
+      }
+    }
+  }
+  std::printf("Render (submit) time: indirect is %.1fx faster than direct, "
+              "indirect+inst %.1fx faster than instanced\n",
+              results[0].renderMS / results[2].renderMS,
+              results[1].renderMS / results[3].renderMS);
+}
+
+int main(int argc, char **argv) {
+  std::vector<unsigned int> counts;
+  for (int i = 1; i < argc; ++i) {
+    counts.push_back(std::atoi(argv[i]));
+  }
+  if (counts.empty()) {
+    counts = {1000, 10000, 100000};
+  }
+
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+  SDL_Window *window = SDL_CreateWindow(
+      "indirectdrawbench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+      WIDTH, HEIGHT, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context = SDL_GL_CreateContext(window);
+  if (window == nullptr || context == nullptr ||
+      !gladLoadGLLoader(SDL_GL_GetProcAddress)) {
+    std::printf("Unable to create an OpenGL context: %s\n", SDL_GetError());
+    return 1;
+  }
+  std::printf("Renderer: %s, OpenGL %s\n",
+              (const char *)glGetString(GL_RENDERER),
+              (const char *)glGetString(GL_VERSION));
+  if (!IndirectDraw::IsSupported()) {
+    std::printf("Indirect drawing is not supported (needs OpenGL 4.3)\n");
+    return 1;
+  }
+
+  // Keep the per-node logging out of the results
+  std::streambuf *coutBuffer = std::cout.rdbuf();
+  std::ostringstream sink;
+  std::cout.rdbuf(sink.rdbuf());
+
+  const std::vector<Path> paths = {{"direct", false, false, -1},
+                                   {"instanced", true, false, -1},
+                                   {"indirect", false, true, 0},
+                                   {"indirect+inst", true, true, 1}};
+  {
+    // 64 tessellations, in both vertex formats, with both textures
+    std::vector<std::unique_ptr<Object>> objects;
+    for (VertexFormat format : {VertexFormat::Full, VertexFormat::Compact}) {
+      for (unsigned int bands = 0; bands < 64; ++bands) {
+        for (const char *texture : {"rock.ppm", "sun.ppm"}) {
+          Sphere *sphere = new Sphere(3 + bands / 8, 3 + bands % 8, format);
+          sphere->LoadTexture(texture);
+          objects.emplace_back(sphere);
+        }
+      }
+    }
+    unsigned long arenaBytes = GeometryArena::Instance().GetUsedBytes();
+    unsigned int arenaBuffers = GeometryArena::Instance().GetBufferCount();
+
+    std::cout.rdbuf(coutBuffer);
+    std::printf("%zu objects to pick from, meshes in %u buffers (%lu bytes)\n",
+                objects.size(), arenaBuffers, arenaBytes);
+    for (unsigned int count : counts) {
+      std::cout.rdbuf(sink.rdbuf());
+      RunScene(count, objects, paths);
+      std::cout.rdbuf(coutBuffer);
+      sink.str("");
+    }
+    std::cout.rdbuf(sink.rdbuf());
+  }
+  GeometryArena::Instance().RemoveAll();
+  VertexArrayCache::Instance().RemoveAll();
+  ShaderManager::Instance().RemoveAll();
+  JobSystem::Instance().Shutdown();
+  std::cout.rdbuf(coutBuffer);
+
+  SDL_GL_DeleteContext(context);
+  SDL_DestroyWindow(window);
+  SDL_Quit();
+  return 0;
+}
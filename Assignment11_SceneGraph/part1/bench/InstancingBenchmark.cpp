@@ -0,0 +1,154 @@
+/* Benchmark for drawing many moons that share one mesh
+ *
+ * Builds a scene of a sun with 10,000 moons (all using the same
+ * Sphere, like Moon2, Moon3 and Moon4 in SDLGraphicsProgram) and times
+ * Renderer::Update and Renderer::Render with instancing turned off
+ * (one glDrawElements per moon) and on (one glDrawElementsInstanced
+ * per mesh). A hidden window is created so that there is a real
+ * OpenGL context.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py InstancingBenchmark
+ *
+ * Run with: ./InstancingBenchmark [moon count]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "Object.hpp"
+#include "Renderer.hpp"
+#include "SceneNode.hpp"
+#include "ShaderManager.hpp"
+#include "Sphere.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Timings for one way of drawing the scene
+struct Result {
+  double updateMS;
+  double renderMS;
+  double frameMS;
+  unsigned int drawCalls;
+  unsigned int drawn;
+};
+
+static double ElapsedMS(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Draws 'frames' frames and returns the average time of each step
+static Result RunFrames(Renderer &renderer, SceneNode *sun, int frames) {
+  Result result{0.0, 0.0, 0.0, 0, 0};
+  for (int frame = 0; frame < frames; ++frame) {
+    // Keep everything moving, so nothing can be skipped
+    sun->GetLocalTransform().Rotate(0.01f, 0.0f, 1.0f, 0.0f);
+    glFinish();
+    auto frameStart = std::chrono::steady_clock::now();
+    auto start = frameStart;
+    renderer.Update();
+    result.updateMS += ElapsedMS(start);
+    start = std::chrono::steady_clock::now();
+    renderer.Render();
+    // Time to submit the work, before the driver has finished it
+    result.renderMS += ElapsedMS(start);
+    glFinish();
+    result.frameMS += ElapsedMS(frameStart);
+  }
+  result.updateMS /= frames;
+  result.renderMS /= frames;
+  result.frameMS /= frames;
+  result.drawCalls = renderer.GetDrawCallCount();
+  result.drawn = renderer.GetDrawnCount();
+  return result;
+}
+
+int main(int argc, char **argv) {
+  int moonCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+  const int frames = 20;
+  const int width = 640, height = 480;
+
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+  SDL_Window *window = SDL_CreateWindow(
+      "instancingbench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+      width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context = SDL_GL_CreateContext(window);
+  if (window == nullptr || context == nullptr ||
+      !gladLoadGLLoader(SDL_GL_GetProcAddress)) {
+    std::printf("Unable to create an OpenGL context: %s\n", SDL_GetError());
+    return 1;
+  }
+
+  // Keep the per-node logging out of the results
+  std::streambuf *coutBuffer = std::cout.rdbuf();
+  std::ostringstream sink;
+  std::cout.rdbuf(sink.rdbuf());
+
+  Result separate, instanced;
+  {
+    Renderer renderer(width, height);
+    renderer.GetCamera(0)->SetCameraEyePosition(0.0f, 0.0f, 120.0f);
+
+    Sphere sunSphere;
+    sunSphere.LoadTexture("sun.ppm");
+    Sphere moonSphere;
+    moonSphere.LoadTexture("rock.ppm");
+
+    SceneNode *sun = new SceneNode(&sunSphere);
+    sun->GetLocalTransform().Scale(5.0f, 5.0f, 5.0f);
+    renderer.setRoot(sun);
+    // Spread the moons over a disc facing the camera, so they are
+    // all on screen (and none are culled).
+    for (int i = 0; i < moonCount; ++i) {
+      SceneNode *moon = new SceneNode(&moonSphere);
+      float angle = i * 2.39996f;
+      float radius = 1.5f + 8.0f * std::sqrt((float)i / moonCount);
+      moon->GetLocalTransform().Translate(radius * std::cos(angle),
+                                          radius * std::sin(angle), 0.0f);
+      moon->GetLocalTransform().Scale(0.05f, 0.05f, 0.05f);
+      sun->AddChild(moon);
+    }
+
+    // Warm up (sorts the tree and allocates every buffer)
+    renderer.SetInstancing(false);
+    RunFrames(renderer, sun, 2);
+    separate = RunFrames(renderer, sun, frames);
+    renderer.SetInstancing(true);
+    RunFrames(renderer, sun, 2);
+    instanced = RunFrames(renderer, sun, frames);
+
+    delete sun;
+  }
+  ShaderManager::Instance().RemoveAll();
+  JobSystem::Instance().Shutdown();
+  std::cout.rdbuf(coutBuffer);
+
+  std::printf("Renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+  std::printf("%d moons, average of %d frames\n", moonCount, frames);
+  std::printf("%-10s %8s %10s %10s %10s %10s\n", "path", "drawn",
+              "draw calls", "update ms", "render ms", "frame ms");
+  std::printf("%-10s %8u %10u %10.2f %10.2f %10.2f\n", "separate",
+              separate.drawn, separate.drawCalls, separate.updateMS,
+              separate.renderMS, separate.frameMS);
+  std::printf("%-10s %8u %10u %10.2f %10.2f %10.2f\n", "instanced",
+              instanced.drawn, instanced.drawCalls, instanced.updateMS,
+              instanced.renderMS, instanced.frameMS);
+  std::printf("Render (submit) time is %.1fx lower with instancing\n",
+              separate.renderMS / instanced.renderMS);
+
+  SDL_GL_DeleteContext(context);
+  SDL_DestroyWindow(window);
+  SDL_Quit();
+  return 0;
+}
@@ -0,0 +1,103 @@
+/* Benchmark for creating many spheres
+ *
+ * Creates N spheres two ways and times how long it takes:
+ *   unshared - every sphere generates and uploads its own mesh
+ *              (what Sphere::Init used to do)
+ *   registry - every sphere asks the MeshRegistry, so the mesh is
+ *              only generated and uploaded for the first one
+ * and reports how many bytes of vertex and index data end up on the
+ * GPU. A hidden window is created so that there is a real OpenGL
+ * context.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py MeshRegistryBenchmark
+ *
+ * Run with: ./MeshRegistryBenchmark [sphere count]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "Object.hpp"
+#include "Sphere.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// A sphere that always builds its own mesh
+class UnsharedSphere : public Object {
+public:
+  UnsharedSphere() {
+    m_mesh = std::make_shared<Mesh>();
+    Sphere::Build(m_mesh->GetGeometry(), 30, 30);
+    m_mesh->Upload();
+  }
+  unsigned int GetSizeInBytes() const { return m_mesh->GetSizeInBytes(); }
+};
+
+// Creates 'count' objects of type T and returns the time it took in ms.
+// The objects are kept in 'objects' so they are not destroyed yet.
+template <typename T>
+static double CreateMS(int count, std::vector<std::unique_ptr<T>> &objects) {
+  glFinish();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i) {
+    objects.emplace_back(new T());
+  }
+  glFinish();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  int sphereCount = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_Window *window =
+      SDL_CreateWindow("meshbench", SDL_WINDOWPOS_UNDEFINED,
+                       SDL_WINDOWPOS_UNDEFINED, 64, 64,
+                       SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context = SDL_GL_CreateContext(window);
+  if (window == nullptr || context == nullptr ||
+      !gladLoadGLLoader(SDL_GL_GetProcAddress)) {
+    std::printf("Unable to create an OpenGL context: %s\n", SDL_GetError());
+    return 1;
+  }
+
+  std::printf("Renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+  std::printf("%d spheres of 30x30 bands\n", sphereCount);
+  std::printf("%-10s %12s %12s %14s\n", "path", "create ms", "us/sphere",
+              "GPU bytes");
+  {
+    std::vector<std::unique_ptr<UnsharedSphere>> spheres;
+    double ms = CreateMS(sphereCount, spheres);
+    unsigned long long bytes = 0;
+    for (const auto &sphere : spheres) {
+      bytes += sphere->GetSizeInBytes();
+    }
+    std::printf("%-10s %12.2f %12.2f %14llu\n", "unshared", ms,
+                1000.0 * ms / sphereCount, bytes);
+  }
+  {
+    std::vector<std::unique_ptr<Sphere>> spheres;
+    double ms = CreateMS(sphereCount, spheres);
+    std::printf("%-10s %12.2f %12.2f %14u\n", "registry", ms,
+                1000.0 * ms / sphereCount,
+                MeshRegistry::Instance().GetSizeInBytes());
+    std::printf("Meshes loaded: %u, shared by %ld spheres\n",
+                MeshRegistry::Instance().GetMeshCount(),
+                MeshRegistry::Instance().GetReferenceCount(
+                    {PrimitiveType::Sphere, {30, 30}}));
+  }
+
+  SDL_GL_DeleteContext(context);
+  SDL_DestroyWindow(window);
+  SDL_Quit();
+  return 0;
+}
@@ -0,0 +1,177 @@
+/* Benchmark for Image::LoadPPM
+ *
+ * Compares the memory mapped loader in Image.cpp with the original
+ * getline/atoi loader on every PPM in common/textures. Each ASCII file
+ * is also converted to a binary (P6) copy in a temporary directory, so
+ * the binary path can be timed as well.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py PPMBenchmark
+ *
+ * Run with: ./PPMBenchmark [texture directory]
+ */
+#include "Image.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// The loader as it was originally written. Kept here so the
+// benchmark always has the same baseline to compare against.
+static uint8_t *LegacyLoadPPM(const std::string &filepath, int &width,
+                              int &height) {
+  std::ifstream ppmFile(filepath.c_str());
+  uint8_t *pixelData = nullptr;
+  width = 0;
+  height = 0;
+  if (!ppmFile.is_open()) {
+    return nullptr;
+  }
+  std::string line;
+  unsigned int iteration = 0;
+  unsigned int pos = 0;
+  while (getline(ppmFile, line)) {
+    if (line[0] == '#') {
+      continue;
+    }
+    if (line[0] == 'P') {
+      // magic number
+    } else if (iteration == 1) {
+      char *token = strtok((char *)line.c_str(), " ");
+      width = atoi(token);
+      token = strtok(NULL, " ");
+      height = atoi(token);
+      pixelData = new uint8_t[width * height * 3];
+    } else if (iteration == 2) {
+      // max color range
+    } else if (pixelData != nullptr && pos < (unsigned int)width * height * 3) {
+      pixelData[pos] = (uint8_t)atoi(line.c_str());
+      ++pos;
+    }
+    iteration++;
+  }
+  // Flip the same way the original did (copy, then reverse)
+  uint8_t *copyData = new uint8_t[width * height * 3];
+  for (int i = 0; i < width * height * 3; ++i) {
+    copyData[i] = pixelData[i];
+  }
+  unsigned int flipPos = (width * height * 3) - 1;
+  for (int i = 0; i < width * height * 3; i += 3) {
+    pixelData[flipPos] = copyData[i + 2];
+    pixelData[flipPos - 1] = copyData[i + 1];
+    pixelData[flipPos - 2] = copyData[i];
+    flipPos -= 3;
+  }
+  delete[] copyData;
+  return pixelData;
+}
+
+// Writes a binary copy of an image that was loaded without flipping
+static void WriteP6(const std::string &filepath, Image &image) {
+  std::ofstream out(filepath.c_str(), std::ios::binary);
+  out << "P6\n" << image.GetWidth() << " " << image.GetHeight() << "\n255\n";
+  out.write((const char *)image.GetPixelDataPtr(),
+            (std::streamsize)image.GetWidth() * image.GetHeight() * 3);
+}
+
+// Returns the average time of 'runs' calls to 'f' in milliseconds
+template <typename F> static double TimeMS(int runs, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / runs;
+}
+
+int main(int argc, char **argv) {
+  std::string directory = argc > 1 ? argv[1] : "../../common/textures";
+  fs::path binaryDirectory = fs::temp_directory_path() / "ppmbench_p6";
+  fs::create_directories(binaryDirectory);
+
+  std::vector<fs::path> files;
+  for (const auto &entry : fs::directory_iterator(directory)) {
+    if (entry.path().extension() == ".ppm") {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  // Keep the per-file logging from Image::LoadPPM out of the table
+  std::streambuf *coutBuffer = std::cout.rdbuf();
+  std::ostringstream sink;
+
+  const int runs = 3;
+  std::printf("%-52s %10s %10s %10s %8s\n", "file", "legacy ms", "P3 ms",
+              "P6 ms", "speedup");
+  double legacyTotal = 0.0, asciiTotal = 0.0, binaryTotal = 0.0;
+  for (const fs::path &file : files) {
+    std::string path = file.string();
+    std::string binaryPath = (binaryDirectory / file.filename()).string();
+
+    std::cout.rdbuf(sink.rdbuf());
+    // Verify both loaders agree before timing anything
+    int w = 0, h = 0;
+    uint8_t *legacy = LegacyLoadPPM(path, w, h);
+    Image check(path);
+    check.LoadPPM(true);
+    bool same = legacy != nullptr && w == check.GetWidth() &&
+                h == check.GetHeight() &&
+                std::memcmp(legacy, check.GetPixelDataPtr(), w * h * 3) == 0;
+    delete[] legacy;
+    {
+      Image unflipped(path);
+      unflipped.LoadPPM(false);
+      WriteP6(binaryPath, unflipped);
+    }
+
+    double legacyMS = TimeMS(runs, [&]() {
+      int lw, lh;
+      delete[] LegacyLoadPPM(path, lw, lh);
+    });
+    double asciiMS = TimeMS(runs, [&]() {
+      Image image(path);
+      image.LoadPPM(true);
+    });
+    // The binary path does no work until the pages are touched, so
+    // read every byte once (as glTexImage2D would) to keep this fair.
+    volatile unsigned int checksum = 0;
+    double binaryMS = TimeMS(runs, [&]() {
+      Image image(binaryPath);
+      image.LoadPPM(false);
+      const uint8_t *pixels = image.GetPixelDataPtr();
+      unsigned int sum = 0;
+      for (int i = 0; i < image.GetWidth() * image.GetHeight() * 3; ++i) {
+        sum += pixels[i];
+      }
+      checksum = checksum + sum;
+    });
+    std::cout.rdbuf(coutBuffer);
+
+    legacyTotal += legacyMS;
+    asciiTotal += asciiMS;
+    binaryTotal += binaryMS;
+    std::printf("%-52s %10.2f %10.2f %10.3f %7.1fx%s\n",
+                file.filename().string().c_str(), legacyMS, asciiMS, binaryMS,
+                legacyMS / asciiMS,
+                same ? "" : "  (legacy loader disagrees)");
+  }
+  std::printf("%-52s %10.2f %10.2f %10.3f %7.1fx\n", "total", legacyTotal,
+              asciiTotal, binaryTotal, legacyTotal / asciiTotal);
+
+  std::printf("Note: the legacy loader expects one value per line, so it\n"
+              "      misreads files with more than one value on a line.\n");
+
+  fs::remove_all(binaryDirectory);
+  return 0;
+}
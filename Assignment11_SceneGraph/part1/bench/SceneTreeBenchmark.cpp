@@ -0,0 +1,217 @@
+/* Benchmark for updating world transforms with the SceneTree
+ *
+ * Builds a hierarchy of just over 100k nodes (a root, 100 planets,
+ * 10 moons per planet and 99 satellites per moon) and times one
+ * frame's world transform update:
+ *   legacy - recursive update through child pointers, copying
+ *            Transforms, as SceneNode::Update was originally written
+ *   tree   - one linear pass over the sorted SceneTree arrays, with
+ *            the root moving (so every node is recomputed), with 1% of
+ *            the nodes moving, and with nothing moving
+ *   jobs   - the tree split into chunks that are updated on every core
+ *            by the JobSystem (as Renderer::Update does)
+ * Nodes are created in a shuffled order (like SDLGraphicsProgram
+ * creates moons before the planets they orbit), so the tree also has
+ * to sort itself before its first update.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py SceneTreeBenchmark
+ *
+ * Run with: ./SceneTreeBenchmark [satellites per moon] [worker threads]
+ */
+#include "JobSystem.hpp"
+#include "SceneTree.hpp"
+#include "Transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// The node as it was originally written (minus the drawing)
+struct LegacyNode {
+  LegacyNode *m_parent{nullptr};
+  std::vector<LegacyNode *> m_children;
+  Transform m_localTransform;
+  Transform m_worldTransform;
+
+  Transform &GetLocalTransform() { return m_localTransform; }
+  Transform &GetWorldTransform() { return m_worldTransform; }
+
+  void Update() {
+    if (m_parent != nullptr) {
+      m_worldTransform = m_parent->GetWorldTransform() * GetLocalTransform();
+    } else {
+      m_worldTransform = GetLocalTransform();
+    }
+    for (std::size_t i = 0; i < m_children.size(); ++i) {
+      m_children[i]->Update();
+    }
+  }
+};
+
+// Returns the average time of 'runs' calls to 'f' in milliseconds
+template <typename F> static double TimeMS(int runs, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / runs;
+}
+
+int main(int argc, char **argv) {
+  const int planets = 100;
+  const int moonsPerPlanet = 10;
+  const int satellitesPerMoon = argc > 1 ? std::atoi(argv[1]) : 99;
+  const int workers = argc > 2 ? std::atoi(argv[2]) : 0;
+  const int runs = 50;
+
+  // Parent of every node (by creation number), root first
+  std::vector<int> parentOf;
+  parentOf.push_back(-1);
+  for (int p = 0; p < planets; ++p) {
+    int planet = parentOf.size();
+    parentOf.push_back(0);
+    for (int m = 0; m < moonsPerPlanet; ++m) {
+      int moon = parentOf.size();
+      parentOf.push_back(planet);
+      for (int s = 0; s < satellitesPerMoon; ++s) {
+        parentOf.push_back(moon);
+      }
+    }
+  }
+  const int nodeCount = parentOf.size();
+
+  // Create the nodes in a shuffled order, so neither version
+  // happens to get its nodes laid out in traversal order.
+  std::vector<int> creationOrder(nodeCount);
+  for (int i = 0; i < nodeCount; ++i) {
+    creationOrder[i] = i;
+  }
+  std::shuffle(creationOrder.begin(), creationOrder.end(), std::mt19937(5310));
+
+  // ---- legacy ----
+  std::vector<LegacyNode *> legacyNodes(nodeCount);
+  for (int i : creationOrder) {
+    legacyNodes[i] = new LegacyNode();
+  }
+  // ---- tree ----
+  SceneTree &tree = SceneTree::Instance();
+  std::vector<unsigned int> ids(nodeCount);
+  for (int i : creationOrder) {
+    ids[i] = tree.CreateNode(nullptr);
+  }
+
+  for (int i = 0; i < nodeCount; ++i) {
+    float angle = 0.001f * i;
+    legacyNodes[i]->GetLocalTransform().Rotate(angle, 0.0f, 1.0f, 0.0f);
+    legacyNodes[i]->GetLocalTransform().Translate(1.0f, 0.0f, 0.0f);
+    tree.GetLocalTransform(ids[i]).Rotate(angle, 0.0f, 1.0f, 0.0f);
+    tree.GetLocalTransform(ids[i]).Translate(1.0f, 0.0f, 0.0f);
+  }
+  for (int i : creationOrder) {
+    if (parentOf[i] >= 0) {
+      legacyNodes[i]->m_parent = legacyNodes[parentOf[i]];
+      legacyNodes[parentOf[i]]->m_children.push_back(legacyNodes[i]);
+      tree.SetParent(ids[i], ids[parentOf[i]]);
+    }
+  }
+
+  // The first update sorts the tree
+  double sortMS = TimeMS(1, [&]() { tree.Update(ids[0]); });
+
+  // Moving the root means every world transform has to be recomputed
+  double legacyMS = TimeMS(runs, [&]() {
+    legacyNodes[0]->GetLocalTransform().Rotate(0.01f, 0.0f, 1.0f, 0.0f);
+    legacyNodes[0]->Update();
+  });
+  double treeMS = TimeMS(runs, [&]() {
+    tree.GetLocalTransform(ids[0]).Rotate(0.01f, 0.0f, 1.0f, 0.0f);
+    tree.Update(ids[0]);
+  });
+  unsigned int treeRecomputed = tree.GetRecomputedCount();
+
+  // Only some of the nodes move
+  double someMS = TimeMS(runs, [&]() {
+    for (int i = 1; i < nodeCount; i += 100) {
+      tree.GetLocalTransform(ids[i]).Rotate(0.01f, 0.0f, 1.0f, 0.0f);
+    }
+    tree.Update(ids[0]);
+  });
+  unsigned int someRecomputed = tree.GetRecomputedCount();
+
+  // Nothing moves
+  double staticMS = TimeMS(runs, [&]() { tree.Update(ids[0]); });
+  unsigned int staticRecomputed = tree.GetRecomputedCount();
+
+  // Every node is recomputed, in chunks spread over every core
+  JobSystem &jobs = JobSystem::Instance();
+  jobs.Initialize(workers);
+  const unsigned int chunkSize = std::max(
+      256u, (unsigned int)nodeCount / (jobs.GetThreadCount() * 4 + 1));
+  std::vector<unsigned int> parallelChunks;
+  double jobsMS = TimeMS(runs, [&]() {
+    tree.GetLocalTransform(ids[0]).Rotate(0.01f, 0.0f, 1.0f, 0.0f);
+    unsigned int chunkCount = tree.SplitIntoChunks(ids[0], chunkSize);
+    parallelChunks.clear();
+    for (unsigned int i = 0; i < chunkCount; ++i) {
+      if (tree.GetChunk(i).serial) {
+        tree.UpdateChunk(i);
+      } else {
+        parallelChunks.push_back(i);
+      }
+    }
+    jobs.ParallelFor(parallelChunks.size(), [&](unsigned int i) {
+      tree.UpdateChunk(parallelChunks[i]);
+    });
+  });
+  unsigned int jobsRecomputed = tree.GetRecomputedCount();
+  unsigned int threadCount = jobs.GetThreadCount();
+  jobs.Shutdown();
+
+  // Bring the legacy nodes in line with the tree before comparing
+  for (int r = 0; r < runs; ++r) {
+    legacyNodes[0]->GetLocalTransform().Rotate(0.01f, 0.0f, 1.0f, 0.0f);
+    for (int i = 1; i < nodeCount; i += 100) {
+      legacyNodes[i]->GetLocalTransform().Rotate(0.01f, 0.0f, 1.0f, 0.0f);
+    }
+  }
+  legacyNodes[0]->Update();
+
+  // Make sure both versions computed the same thing
+  float maxError = 0.0f;
+  for (int i = 0; i < nodeCount; ++i) {
+    const glm::mat4 &a = legacyNodes[i]->GetWorldTransform().GetInternalMatrix();
+    const glm::mat4 &b = tree.GetWorldMatrix(ids[i]);
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 4; ++r) {
+        maxError = std::max(maxError, std::abs(a[c][r] - b[c][r]));
+      }
+    }
+  }
+
+  std::printf("%d nodes, average of %d updates\n", nodeCount, runs);
+  std::printf("%-20s %10s %10s %12s\n", "path", "ms/frame", "speedup",
+              "recomputed");
+  std::printf("%-20s %10.3f %9.2fx %12d\n", "legacy", legacyMS, 1.0,
+              nodeCount);
+  std::printf("%-20s %10.3f %9.2fx %12u\n", "tree, root moved", treeMS,
+              legacyMS / treeMS, treeRecomputed);
+  std::printf("%-20s %10.3f %9.2fx %12u\n", "tree, 1% moved", someMS,
+              legacyMS / someMS, someRecomputed);
+  std::printf("%-20s %10.3f %9.2fx %12u\n", "tree, nothing moved",
+              staticMS, legacyMS / staticMS, staticRecomputed);
+  std::printf("%-20s %10.3f %9.2fx %12u\n", "jobs, root moved", jobsMS,
+              legacyMS / jobsMS, jobsRecomputed);
+  std::printf("(%u threads, %u nodes per chunk)\n", threadCount, chunkSize);
+  std::printf("First update (including the sort): %.3f ms\n", sortMS);
+  std::printf("Largest difference between the two: %g\n", maxError);
+
+  for (LegacyNode *node : legacyNodes) {
+    delete node;
+  }
+  return 0;
+}
@@ -0,0 +1,179 @@
+/* Benchmark for setting the per-node uniforms in SceneNode::Update
+ *
+ * Times the seven uniforms SceneNode sets for every node, three ways:
+ *   legacy  - glGetUniformLocation on every call (the original setters)
+ *   by name - the name setters, which now use the reflected location table
+ *   handle  - UniformHandle, with no string work at all
+ * A hidden window is created so that there is a real OpenGL context.
+ * The shaders in ./shaders now read these values from uniform buffers,
+ * so the benchmark uses its own shaders with the original uniforms.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py UniformBenchmark
+ *
+ * Run with: ./UniformBenchmark [node count]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "Shader.hpp"
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// A shader with the same uniforms ./shaders/vert.glsl and frag.glsl had
+// before the camera and light moved into the 'FrameData' uniform block.
+static const char *s_vertexSource = R"(#version 330 core
+layout(location=0)in vec3 position;
+layout(location=1)in vec3 normals;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+out vec3 myNormal;
+out vec3 FragPos;
+void main(){
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+    myNormal = normals;
+    FragPos = vec3(model * vec4(position, 1.0f));
+})";
+static const char *s_fragmentSource = R"(#version 330 core
+uniform vec3 lightColor;
+uniform vec3 lightPos;
+uniform float ambientIntensity;
+uniform mat4 view;
+uniform sampler2D u_DiffuseMap;
+in vec3 myNormal;
+in vec3 FragPos;
+out vec4 FragColor;
+void main(){
+    vec3 lightDir = normalize(lightPos - FragPos);
+    float diffImpact = max(dot(normalize(myNormal), lightDir), 0.0);
+    vec3 color = texture(u_DiffuseMap, vec2(view[0][0])).rgb;
+    FragColor = vec4(color * (diffImpact + ambientIntensity) * lightColor, 1.0);
+})";
+
+// The setters exactly as they were originally written
+static void LegacyUpdate(GLuint program, const glm::mat4 &model,
+                         const glm::mat4 &view, const glm::mat4 &projection,
+                         const glm::vec3 &lightPos) {
+  glUniform1i(glGetUniformLocation(program, "u_DiffuseMap"), 0);
+  glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE,
+                     &model[0][0]);
+  glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE,
+                     &view[0][0]);
+  glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE,
+                     &projection[0][0]);
+  glUniform3f(glGetUniformLocation(program, "lightColor"), 1.0f, 1.0f, 1.0f);
+  glUniform3f(glGetUniformLocation(program, "lightPos"), lightPos.x,
+              lightPos.y, lightPos.z);
+  glUniform1f(glGetUniformLocation(program, "ambientIntensity"), 0.5f);
+}
+
+// Runs 'f' once per node and returns the average nanoseconds per node
+template <typename F> static double TimePerNodeNS(int nodes, int frames, F f) {
+  glFinish();
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (int node = 0; node < nodes; ++node) {
+      f(node);
+    }
+  }
+  glFinish();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         ((double)nodes * frames);
+}
+
+int main(int argc, char **argv) {
+  int nodeCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+  const int frames = 20;
+
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_Window *window =
+      SDL_CreateWindow("uniformbench", SDL_WINDOWPOS_UNDEFINED,
+                       SDL_WINDOWPOS_UNDEFINED, 64, 64,
+                       SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context = SDL_GL_CreateContext(window);
+  if (window == nullptr || context == nullptr ||
+      !gladLoadGLLoader(SDL_GL_GetProcAddress)) {
+    std::printf("Unable to create an OpenGL context: %s\n", SDL_GetError());
+    return 1;
+  }
+
+  {
+    Shader shader;
+    shader.CreateShader(s_vertexSource, s_fragmentSource);
+    shader.Bind();
+
+    // Some per-node data so the driver cannot skip anything
+    std::vector<glm::mat4> models(nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+      models[i] = glm::translate(glm::mat4(1.0f), glm::vec3(i, 0.0f, 0.0f));
+    }
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(0.0f),
+                                 glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection =
+        glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 512.0f);
+    glm::vec3 lightPos(0.0f, 0.0f, 19.0f);
+
+    double legacyNS = TimePerNodeNS(nodeCount, frames, [&](int i) {
+      LegacyUpdate(shader.GetID(), models[i], view, projection, lightPos);
+    });
+
+    double byNameNS = TimePerNodeNS(nodeCount, frames, [&](int i) {
+      shader.SetUniform1i("u_DiffuseMap", 0);
+      shader.SetUniformMatrix4fv("model", &models[i][0][0]);
+      shader.SetUniformMatrix4fv("view", &view[0][0]);
+      shader.SetUniformMatrix4fv("projection", &projection[0][0]);
+      shader.SetUniform3f("lightColor", 1.0f, 1.0f, 1.0f);
+      shader.SetUniform3f("lightPos", lightPos.x, lightPos.y, lightPos.z);
+      shader.SetUniform1f("ambientIntensity", 0.5f);
+    });
+
+    UniformHandle<int> diffuseMap = shader.GetUniformHandle<int>("u_DiffuseMap");
+    UniformHandle<glm::mat4> model = shader.GetUniformHandle<glm::mat4>("model");
+    UniformHandle<glm::mat4> viewHandle =
+        shader.GetUniformHandle<glm::mat4>("view");
+    UniformHandle<glm::mat4> projectionHandle =
+        shader.GetUniformHandle<glm::mat4>("projection");
+    UniformHandle<glm::vec3> lightColor =
+        shader.GetUniformHandle<glm::vec3>("lightColor");
+    UniformHandle<glm::vec3> lightPosHandle =
+        shader.GetUniformHandle<glm::vec3>("lightPos");
+    UniformHandle<float> ambient =
+        shader.GetUniformHandle<float>("ambientIntensity");
+    double handleNS = TimePerNodeNS(nodeCount, frames, [&](int i) {
+      shader.SetUniform(diffuseMap, 0);
+      shader.SetUniform(model, models[i]);
+      shader.SetUniform(viewHandle, view);
+      shader.SetUniform(projectionHandle, projection);
+      shader.SetUniform(lightColor, glm::vec3(1.0f, 1.0f, 1.0f));
+      shader.SetUniform(lightPosHandle, lightPos);
+      shader.SetUniform(ambient, 0.5f);
+    });
+
+    std::printf("Renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+    std::printf("%d nodes x %d frames, 7 uniforms per node\n", nodeCount,
+                frames);
+    std::printf("%-10s %12s %10s\n", "path", "ns/node", "speedup");
+    std::printf("%-10s %12.1f %9.2fx\n", "legacy", legacyNS, 1.0);
+    std::printf("%-10s %12.1f %9.2fx\n", "by name", byNameNS,
+                legacyNS / byNameNS);
+    std::printf("%-10s %12.1f %9.2fx\n", "handle", handleNS,
+                legacyNS / handleNS);
+  }
+
+  SDL_GL_DeleteContext(context);
+  SDL_DestroyWindow(window);
+  SDL_Quit();
+  return 0;
+}
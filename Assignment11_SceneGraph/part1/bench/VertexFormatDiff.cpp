@@ -0,0 +1,265 @@
+/* Visual diff of the full and compact vertex formats
+ *
+ * Draws the same scene (a sun, rings of moons at different sizes and a
+ * textured quad) twice into a hidden window: once with every mesh in
+ * VertexFormat::Full and once in VertexFormat::Compact. The two images
+ * are read back and compared, printing the largest and mean difference
+ * of a color channel, how many pixels differ and the PSNR. The
+ * difference (scaled up 16 times, so it can be seen) can be written to
+ * a .ppm file.
+ *
+ * The packing is also checked on the CPU: random unit normals and
+ * tangents, positions and texture coordinates are packed into a
+ * CompactVertex and unpacked again, and the largest errors printed.
+ * Before any packing, the tangent frames Geometry computes for a sphere
+ * are checked too: how far each normal is from the radial direction,
+ * and whether each frame is orthonormal and right-handed.
+ *
+ * Compilation (from the part1 directory):
+ *   python3 bench/build.py VertexFormatDiff
+ *
+ * Run with: ./VertexFormatDiff [difference.ppm]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "MeshRegistry.hpp"
+#include "Object.hpp"
+#include "Renderer.hpp"
+#include "SceneNode.hpp"
+#include "ShaderManager.hpp"
+#include "Sphere.hpp"
+#include "VertexFormat.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+const int WIDTH = 640, HEIGHT = 480;
+
+// Draws the scene with every mesh in 'format' and returns its pixels
+static std::vector<unsigned char> DrawScene(VertexFormat format,
+                                            unsigned int &meshBytes) {
+  std::vector<unsigned char> pixels(WIDTH * HEIGHT * 3);
+  {
+    Renderer renderer(WIDTH, HEIGHT);
+    renderer.GetCamera(0)->SetCameraEyePosition(0.0f, 0.0f, 12.0f);
+
+    Sphere sunSphere(30, 30, format);
+    sunSphere.LoadTexture("sun.ppm");
+    // A finer sphere, where the rounding of each vertex matters more
+    Sphere moonSphere(64, 64, format);
+    moonSphere.LoadTexture("rock.ppm");
+    Object quad;
+    quad.MakeTexturedQuad("rock.ppm", format);
+
+    SceneNode *sun = new SceneNode(&sunSphere);
+    sun->GetLocalTransform().Scale(2.0f, 2.0f, 2.0f);
+    renderer.setRoot(sun);
+    for (int i = 0; i < 24; ++i) {
+      SceneNode *moon = new SceneNode(&moonSphere);
+      float angle = i * 6.2831853f / 24;
+      float radius = 2.0f + 0.05f * i;
+      moon->GetLocalTransform().Translate(radius * std::cos(angle),
+                                          radius * std::sin(angle), 0.5f);
+      // Moons from tiny to bigger than the sun, in sun units
+      float scale = 0.02f + 0.02f * i;
+      moon->GetLocalTransform().Scale(scale, scale, scale);
+      sun->AddChild(moon);
+    }
+    SceneNode *backdrop = new SceneNode(&quad);
+    backdrop->GetLocalTransform().Translate(0.0f, -0.5f, -2.0f);
+    backdrop->GetLocalTransform().Rotate(-0.8f, 1.0f, 0.0f, 0.0f);
+    backdrop->GetLocalTransform().Scale(3.0f, 3.0f, 3.0f);
+    sun->AddChild(backdrop);
+
+    meshBytes = MeshRegistry::Instance().GetSizeInBytes();
+    renderer.Update();
+    renderer.Render();
+    glFinish();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGB, GL_UNSIGNED_BYTE,
+                 pixels.data());
+    delete sun;
+  }
+  ShaderManager::Instance().RemoveAll();
+  return pixels;
+}
+
+// Packs random vertices and prints how far they moved
+static void CheckPacking() {
+  std::mt19937 random(7);
+  std::normal_distribution<float> gaussian;
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  const int count = 1000000;
+  float normalError = 0.0f, tangentError = 0.0f, bitangentError = 0.0f;
+  double normalErrorSum = 0.0, tangentErrorSum = 0.0;
+  float positionError = 0.0f, texCoordError = 0.0f;
+  int signErrors = 0;
+  for (int i = 0; i < count; ++i) {
+    glm::vec3 normal = glm::normalize(
+        glm::vec3(gaussian(random), gaussian(random), gaussian(random)));
+    // A tangent at right angles to the normal, with either handedness
+    glm::vec3 tangent = glm::normalize(glm::cross(
+        normal, glm::vec3(gaussian(random), gaussian(random),
+                          gaussian(random))));
+    float handedness = uniform(random) < 0.5f ? -1.0f : 1.0f;
+    glm::vec3 bitangent = handedness * glm::cross(normal, tangent);
+    // Positions inside a unit sphere, like our meshes
+    glm::vec3 position(uniform(random) * 2.0f - 1.0f,
+                       uniform(random) * 2.0f - 1.0f,
+                       uniform(random) * 2.0f - 1.0f);
+    glm::vec2 texCoords(uniform(random), uniform(random));
+
+    CompactVertex vertex =
+        VertexPacking::Pack(position, normal, texCoords, tangent, bitangent);
+    glm::vec3 n, t, b;
+    VertexPacking::UnpackTangentFrame(vertex.tangentFrame, n, t, b);
+    // Angles in degrees
+    float nAngle = glm::degrees(
+        std::acos(glm::clamp(glm::dot(n, normal), -1.0f, 1.0f)));
+    float tAngle = glm::degrees(
+        std::acos(glm::clamp(glm::dot(t, tangent), -1.0f, 1.0f)));
+    float bAngle = glm::degrees(std::acos(
+        glm::clamp(glm::dot(glm::normalize(b), bitangent), -1.0f, 1.0f)));
+    normalError = std::max(normalError, nAngle);
+    tangentError = std::max(tangentError, tAngle);
+    bitangentError = std::max(bitangentError, bAngle);
+    normalErrorSum += nAngle;
+    tangentErrorSum += tAngle;
+    signErrors += glm::dot(b, bitangent) < 0.0f;
+    positionError = std::max(
+        positionError,
+        glm::length(VertexPacking::UnpackPosition(vertex) - position));
+    glm::vec2 uvError =
+        glm::abs(VertexPacking::UnpackTexCoords(vertex) - texCoords);
+    texCoordError = std::max({texCoordError, uvError.x, uvError.y});
+  }
+  std::printf("Packing %d random vertices:\n", count);
+  std::printf("  normal error    max %6.3f, mean %6.3f degrees\n", normalError,
+              normalErrorSum / count);
+  std::printf("  tangent error   max %6.3f, mean %6.3f degrees\n",
+              tangentError, tangentErrorSum / count);
+  std::printf("  bitangent error max %6.3f degrees, %d flipped\n",
+              bitangentError, signErrors);
+  std::printf("  position error  max %.6f (positions from -1 to 1)\n",
+              positionError);
+  std::printf("  texcoord error  max %.7f (%.3f texels of a 4096 texture)\n",
+              texCoordError, texCoordError * 4096.0f);
+}
+
+// Checks the tangent frames Geometry computes for a 30 band sphere
+static void CheckTangentFrames() {
+  Geometry geometry;
+  Sphere::Build(geometry, 30, 30);
+  geometry.Gen(VertexFormat::Full);
+  // Position, normal, texture coordinates, tangent and bitangent
+  const float *data = geometry.GetBufferDataPtr();
+  unsigned int count = geometry.GetBufferDataSize() / 14;
+  float normalError = 0.0f, dotError = 0.0f, lengthError = 0.0f;
+  int leftHanded = 0;
+  for (unsigned int i = 0; i < count; ++i) {
+    const float *vertex = data + i * 14;
+    glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+    glm::vec3 n(vertex[3], vertex[4], vertex[5]);
+    glm::vec3 t(vertex[8], vertex[9], vertex[10]);
+    glm::vec3 b(vertex[11], vertex[12], vertex[13]);
+    normalError = std::max(
+        normalError, glm::degrees(std::acos(glm::clamp(
+                         glm::dot(n, glm::normalize(position)), -1.0f, 1.0f))));
+    dotError = std::max({dotError, std::abs(glm::dot(n, t)),
+                         std::abs(glm::dot(n, b)), std::abs(glm::dot(t, b))});
+    lengthError = std::max({lengthError, std::abs(glm::length(n) - 1.0f),
+                            std::abs(glm::length(t) - 1.0f),
+                            std::abs(glm::length(b) - 1.0f)});
+    leftHanded += glm::dot(glm::cross(n, t), b) < 0.0f;
+  }
+  std::printf("Tangent frames of a 30 band sphere (%u vertices):\n", count);
+  std::printf("  normal from radial max %6.3f degrees\n", normalError);
+  std::printf("  largest dot product %g, length error %g\n", dotError,
+              lengthError);
+  std::printf("  left-handed frames %d\n", leftHanded);
+}
+
+int main(int argc, char **argv) {
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+  SDL_Window *window = SDL_CreateWindow(
+      "vertexformatdiff", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+      WIDTH, HEIGHT, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context = SDL_GL_CreateContext(window);
+  if (window == nullptr || context == nullptr ||
+      !gladLoadGLLoader(SDL_GL_GetProcAddress)) {
+    std::printf("Unable to create an OpenGL context: %s\n", SDL_GetError());
+    return 1;
+  }
+
+  // Keep the per-node logging out of the results
+  std::streambuf *coutBuffer = std::cout.rdbuf();
+  std::ostringstream sink;
+  std::cout.rdbuf(sink.rdbuf());
+  unsigned int fullBytes = 0, compactBytes = 0;
+  std::vector<unsigned char> full = DrawScene(VertexFormat::Full, fullBytes);
+  std::vector<unsigned char> compact =
+      DrawScene(VertexFormat::Compact, compactBytes);
+  JobSystem::Instance().Shutdown();
+  std::cout.rdbuf(coutBuffer);
+
+  int maxDifference = 0, differentPixels = 0;
+  double sum = 0.0, squaredSum = 0.0;
+  std::vector<unsigned char> difference(full.size());
+  for (std::size_t i = 0; i < full.size(); i += 3) {
+    int pixelDifference = 0;
+    for (std::size_t c = i; c < i + 3; ++c) {
+      int d = std::abs((int)full[c] - (int)compact[c]);
+      pixelDifference = std::max(pixelDifference, d);
+      sum += d;
+      squaredSum += (double)d * d;
+      difference[c] = (unsigned char)std::min(d * 16, 255);
+    }
+    maxDifference = std::max(maxDifference, pixelDifference);
+    differentPixels += pixelDifference > 0;
+  }
+  double mse = squaredSum / full.size();
+
+  std::printf("Renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+  std::printf("Bytes per vertex: full %zu, compact %zu\n",
+              14 * sizeof(float), sizeof(CompactVertex));
+  std::printf("Mesh bytes on the GPU (with indices): full %u, compact %u\n",
+              fullBytes, compactBytes);
+  std::printf("Image difference (%dx%d):\n", WIDTH, HEIGHT);
+  std::printf("  max channel difference %d, mean %.4f\n", maxDifference,
+              sum / full.size());
+  std::printf("  pixels that differ %d (%.3f%%)\n", differentPixels,
+              100.0 * differentPixels / (WIDTH * HEIGHT));
+  if (mse > 0.0) {
+    std::printf("  PSNR %.2f dB\n", 10.0 * std::log10(255.0 * 255.0 / mse));
+  } else {
+    std::printf("  PSNR infinite (the images are the same)\n");
+  }
+  CheckTangentFrames();
+  CheckPacking();
+
+  if (argc > 1) {
+    // OpenGL's rows start at the bottom, .ppm's at the top
+    std::ofstream file(argv[1], std::ios::binary);
+    file << "P6\n" << WIDTH << " " << HEIGHT << "\n255\n";
+    for (int y = HEIGHT - 1; y >= 0; --y) {
+      file.write((const char *)&difference[y * WIDTH * 3], WIDTH * 3);
+    }
+    std::printf("Wrote the difference (x16) to %s\n", argv[1]);
+  }
+
+  SDL_GL_DeleteContext(context);
+  SDL_DestroyWindow(window);
+  SDL_Quit();
+  return 0;
+}
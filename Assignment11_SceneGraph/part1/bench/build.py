@@ -0,0 +1,52 @@
+# Builds one of the benchmarks in this directory.
+# Run from the part1 directory with: python3 bench/build.py <name>
+#   for example: python3 bench/build.py InstancingBenchmark && ./InstancingBenchmark
+import glob
+import os
+import platform
+import sys
+
+# (1)==================== COMMON CONFIGURATION OPTIONS ======================= #
+COMPILER="g++ -std=c++17 -O2"   # The compiler we want to use
+# Every source file except the ones that make up the program itself,
+# since each benchmark has its own main
+EXCLUDED=["main.cpp","SDLGraphicsProgram.cpp"]
+# ======================= COMMON CONFIGURATION OPTIONS ======================= #
+
+if len(sys.argv)!=2:
+    print("Usage: python3 bench/build.py <benchmark name>")
+    exit(1)
+BENCHMARK=sys.argv[1]
+SOURCE="./bench/"+BENCHMARK+".cpp"
+for source in sorted(glob.glob(os.path.join("src","*.cpp"))):
+    if os.path.basename(source) not in EXCLUDED:
+        SOURCE+=" ./"+source.replace(os.sep,"/")
+EXECUTABLE=BENCHMARK    # Name of the final executable
+
+# (2)=================== Platform specific configuration ===================== #
+# The same as build.py
+ARGUMENTS=""
+INCLUDE_DIR=""
+LIBRARIES=""
+
+if platform.system()=="Linux":
+    ARGUMENTS="-D LINUX"
+    INCLUDE_DIR="-I ./include/ -I ./../../common/thirdparty/glm/"
+    LIBRARIES="-lSDL2 -ldl -pthread"
+elif platform.system()=="Darwin":
+    ARGUMENTS="-D MAC"
+    INCLUDE_DIR="-I ./include/ -I/Library/Frameworks/SDL2.framework/Headers -I./../../common/thirdparty/old/glm"
+    LIBRARIES="-F/Library/Frameworks -framework SDL2"
+elif platform.system()=="Windows":
+    ARGUMENTS="-D MINGW -static-libgcc -static-libstdc++"
+    INCLUDE_DIR="-I./include/ -I./../../common/thirdparty/old/glm/"
+    EXECUTABLE=BENCHMARK+".exe"
+    LIBRARIES="-lmingw32 -lSDL2main -lSDL2"
+# (2)=================== Platform specific configuration ===================== #
+
+# (3)====================== Building the Executable ========================== #
+compileString=COMPILER+" "+ARGUMENTS+" "+SOURCE+" -o "+EXECUTABLE+" "+INCLUDE_DIR+" "+LIBRARIES
+print(compileString)
+exit_code = os.system(compileString)
+exit(0 if exit_code==0 else 1)
+# ========================= Building the Executable ========================== #
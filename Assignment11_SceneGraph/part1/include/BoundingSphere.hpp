@@ -0,0 +1,72 @@
+/** @file BoundingSphere.hpp
+ *  @brief A sphere that encloses some geometry.
+ *
+ *  Bounding spheres are a cheap way to test whether an object could
+ *  be visible. They are easy to move into world space (only the center
+ *  moves, and the radius grows with the largest scale), and two of
+ *  them can be merged to enclose a group of objects.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef BOUNDINGSPHERE_HPP
+#define BOUNDINGSPHERE_HPP
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/geometric.hpp"
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+
+struct BoundingSphere {
+  glm::vec3 center{0.0f, 0.0f, 0.0f};
+  // A negative radius means the sphere is empty (encloses nothing)
+  float radius{-1.0f};
+
+  // Returns true if the sphere encloses nothing
+  inline bool IsEmpty() const { return radius < 0.0f; }
+
+  // Returns this sphere moved by a transformation matrix
+  inline BoundingSphere Transformed(const glm::mat4 &matrix) const {
+    if (IsEmpty()) {
+      return *this;
+    }
+    BoundingSphere result;
+    result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    // The radius grows by the largest scale along any axis
+    float scale = std::max(glm::dot(matrix[0], matrix[0]),
+                           std::max(glm::dot(matrix[1], matrix[1]),
+                                    glm::dot(matrix[2], matrix[2])));
+    result.radius = radius * std::sqrt(scale);
+    return result;
+  }
+
+  // Grows this sphere so that it also encloses 'other'
+  inline void Merge(const BoundingSphere &other) {
+    if (other.IsEmpty()) {
+      return;
+    }
+    if (IsEmpty()) {
+      *this = other;
+      return;
+    }
+    glm::vec3 offset = other.center - center;
+    float distance = glm::length(offset);
+    // One sphere already encloses the other
+    if (distance + other.radius <= radius) {
+      return;
+    }
+    if (distance + radius <= other.radius) {
+      *this = other;
+      return;
+    }
+    // Otherwise the new sphere spans from the far side of one
+    // sphere to the far side of the other.
+    float newRadius = (distance + radius + other.radius) * 0.5f;
+    center += offset * ((newRadius - radius) / distance);
+    radius = newRadius;
+  }
+};
+
+#endif
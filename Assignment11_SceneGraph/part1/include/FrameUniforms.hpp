@@ -0,0 +1,44 @@
+/** @file FrameUniforms.hpp
+ *  @brief Data that is shared by every object drawn in a frame.
+ *
+ *  The camera and light only change once per frame, so rather than
+ *  setting them as uniforms on every object, they are written once
+ *  into a uniform buffer object that every shader reads from.
+ *  The layout of FrameUniforms must exactly match the 'FrameData'
+ *  block declared in ./shaders/vert.glsl and ./shaders/frag.glsl.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef FRAMEUNIFORMS_HPP
+#define FRAMEUNIFORMS_HPP
+
+#include <glad/glad.h>
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+
+// Uniform buffer binding point of the 'FrameData' block
+const GLuint FRAME_DATA_BINDING = 0;
+// Texture slot holding every object's model matrix
+// (slot 0 is used for each object's diffuse map)
+const unsigned int MODEL_MATRIX_TEXTURE_SLOT = 1;
+// Texture slot holding the object index of every instance drawn
+const unsigned int INSTANCE_INDEX_TEXTURE_SLOT = 2;
+
+// The 'FrameData' block uses the std140 layout rules.
+// A vec3 takes up 16 bytes, but a float may be packed
+// into the last 4 bytes of the vec3 before it.
+struct FrameUniforms {
+  glm::mat4 view;
+  glm::mat4 projection;
+  glm::vec3 lightColor;
+  float ambientIntensity;
+  glm::vec3 lightPos;
+  float padding;
+};
+
+static_assert(sizeof(FrameUniforms) == 160,
+              "FrameUniforms does not match the std140 'FrameData' block");
+
+#endif
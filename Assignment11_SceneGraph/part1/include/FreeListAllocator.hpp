@@ -0,0 +1,62 @@
+/** @file FreeListAllocator.hpp
+ *  @brief Hands out ranges of a larger buffer, and takes them back.
+ *
+ *  The allocator never touches memory, it only keeps track of which
+ *  ranges of [0, capacity) are free. Units are up to the caller, i.e.
+ *  vertices or indices of a GeometryArena buffer.
+ *
+ *  Free ranges are kept twice: by offset, so that a freed range can be
+ *  merged with its neighbours, and by size, so that Allocate can pick
+ *  the smallest range that fits (best fit). Both take O(log n) in the
+ *  number of free ranges.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef FREELISTALLOCATOR_HPP
+#define FREELISTALLOCATOR_HPP
+
+#include <map>
+
+class FreeListAllocator {
+public:
+  // Returned by Allocate when no free range is big enough
+  static const unsigned int INVALID_OFFSET = 0xFFFFFFFF;
+
+  // Starts with all of [0, capacity) free
+  explicit FreeListAllocator(unsigned int capacity = 0);
+  // Destructor
+  ~FreeListAllocator();
+  // Returns the offset of 'size' free units, or INVALID_OFFSET.
+  // Allocating 0 units always succeeds and returns 0.
+  unsigned int Allocate(unsigned int size);
+  // Frees a range returned by Allocate
+  void Free(unsigned int offset, unsigned int size);
+  // Makes [capacity, newCapacity) free as well
+  void Grow(unsigned int newCapacity);
+  // Frees everything
+  void Reset(unsigned int capacity);
+  // Units that can be handed out in total
+  inline unsigned int GetCapacity() const { return m_capacity; }
+  // Units currently handed out
+  inline unsigned int GetUsed() const { return m_used; }
+  // Number of separate free ranges (1 means no fragmentation)
+  inline unsigned int GetFreeRangeCount() const { return m_byOffset.size(); }
+  // Size of the biggest range Allocate could return right now
+  unsigned int GetLargestFreeRange() const;
+
+private:
+  // Adds a free range, merging it with the ranges either side of it
+  void Insert(unsigned int offset, unsigned int size);
+  // Removes the free range starting at 'it' from both maps
+  void Erase(std::map<unsigned int, unsigned int>::iterator it);
+
+  // Free ranges, offset -> size
+  std::map<unsigned int, unsigned int> m_byOffset;
+  // The same ranges, size -> offset
+  std::multimap<unsigned int, unsigned int> m_bySize;
+  unsigned int m_capacity{0};
+  unsigned int m_used{0};
+};
+
+#endif
@@ -0,0 +1,35 @@
+/** @file Frustum.hpp
+ *  @brief The volume of space a camera can see.
+ *
+ *  The frustum is made of six planes (left, right, bottom, top,
+ *  near and far), which are pulled straight out of the combined
+ *  projection * view matrix. Anything entirely behind one of the
+ *  planes is off-screen and does not need to be drawn.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include "BoundingSphere.hpp"
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec4.hpp"
+
+class Frustum {
+public:
+  // Constructor
+  Frustum();
+  // Finds the planes of the frustum from a projection * view matrix
+  void ExtractPlanes(const glm::mat4 &viewProjection);
+  // Returns true if any part of the sphere could be visible
+  bool IsVisible(const BoundingSphere &sphere) const;
+
+private:
+  // Each plane is stored as (normal, distance), with the normal
+  // pointing into the frustum and normalized to unit length.
+  glm::vec4 m_planes[6];
+};
+
+#endif
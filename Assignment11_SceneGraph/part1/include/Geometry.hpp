@@ -10,11 +10,31 @@
 #ifndef GEOMETRY_HPP
 #define GEOMETRY_HPP
 
+#include <cstddef>
 #include <vector>
 
+#include "glm/vec3.hpp"
+
+#include "BoundingSphere.hpp"
+#include "VertexFormat.hpp"
+
 // Purpose of this class is to store vertice and triangle information
+//
+// Vertices are stored interleaved, the way they are sent to the vertex
+// buffer object, as they are added. Call Reserve first if you know how
+// many vertices and indices there will be, then nothing is copied as
+// the geometry grows. Once the data is on the GPU, Release frees it.
 class Geometry{
 public:
+	// Number of floats in one vertex of the full format, and where
+	// each attribute starts (see FullVertex)
+	static constexpr unsigned int FLOATS_PER_VERTEX = sizeof(FullVertex)/sizeof(float);
+	static constexpr unsigned int POSITION_OFFSET = offsetof(FullVertex,position)/sizeof(float);
+	static constexpr unsigned int NORMAL_OFFSET = offsetof(FullVertex,normal)/sizeof(float);
+	static constexpr unsigned int TEXCOORD_OFFSET = offsetof(FullVertex,texCoords)/sizeof(float);
+	static constexpr unsigned int TANGENT_OFFSET = offsetof(FullVertex,tangent)/sizeof(float);
+	static constexpr unsigned int BITANGENT_OFFSET = offsetof(FullVertex,bitangent)/sizeof(float);
+
 	// Constructor
 	Geometry();
 	// Destructor
@@ -26,37 +46,54 @@ public:
 	unsigned int GetBufferDataSize();
 	// Retrieve the Buffer Data Pointer
 	float* GetBufferDataPtr();
+	// Makes room for this many vertices and indices up front
+	void Reserve(unsigned int vertexCount, unsigned int indexCount);
 	// Add a new vertex 
 	void AddVertex(float x, float y, float z, float s, float t);
+	// Retrieve how many vertices there are
+	unsigned int GetVertexCount() const;
 	// Allows for adding one index at a time manually if 
 	// you know which vertices are needed to make a triangle.
 	void AddIndex(unsigned int i);
-    // Gen pushes all attributes into a single vector
-	void Gen();
+    // Gen finishes our vertex data for the GPU, either leaving it as
+    // floats or packing it into CompactVertex's (see VertexFormat.hpp).
+    // Call it once, after every vertex and triangle has been added.
+	void Gen(VertexFormat format = VertexFormat::Full);
+	// Frees our vertices and indices once they are on the GPU
+	void Release();
+	// Retrieve the format the last Gen used
+	VertexFormat GetVertexFormat() const;
 	// Functions for working with Indices
 	// Creates a triangle from 3 indices
-	// When a triangle is made, the tangents and bi-tangents are also
-	// computed
 	void MakeTriangle(unsigned int vert0, unsigned int vert1, unsigned int vert2);  
+	// Computes the normal, tangent and bi-tangent of every vertex from
+	// the triangles around it. Call this once, after every triangle
+	// has been added and before Gen. Vertices no triangle uses keep
+	// their placeholders.
+	void ComputeTangentFrames();
     // Retrieve how many indices there are
 	unsigned int GetIndicesSize();
     // Retrieve the pointer to the indices
 	unsigned int* GetIndicesDataPtr();
+	// Retrieve a sphere enclosing every vertex (computed by Gen)
+	const BoundingSphere& GetBoundingSphere() const;
 
 private:
+	// Retrieve the position of vertex 'i' (in the full format)
+	glm::vec3 GetPosition(unsigned int i) const;
+
 	// m_bufferData stores all of the vertexPositons, coordinates, normals, etc.
 	// This is all of the information that should be sent to the vertex Buffer Object
 	std::vector<float> m_bufferData;
 
-    // Individual components of 
-	std::vector<float> m_vertexPositions;
-	std::vector<float> m_textureCoords;
-	std::vector<float> m_normals;
-	std::vector<float> m_tangents;
-	std::vector<float> m_biTangents;
-
 	// The indices for a indexed-triangle mesh
 	std::vector<unsigned int> m_indices;
+
+	// How m_bufferData is laid out
+	VertexFormat m_format{VertexFormat::Full};
+
+	// Encloses all of our vertices
+	BoundingSphere m_boundingSphere;
 };
 
 
@@ -0,0 +1,117 @@
+/** @file GeometryArena.hpp
+ *  @brief Singleton that stores every static mesh in a few big buffers.
+ *
+ *  Giving each mesh its own vertex and index buffer means a scene with
+ *  hundreds of meshes has hundreds of buffers, and a vertex array
+ *  switch between every two draws. The arena instead keeps one vertex
+ *  buffer and one index buffer per VertexLayout, and hands each mesh a
+ *  range of both (see FreeListAllocator). A mesh is then drawn with
+ *  glDrawElements*BaseVertex: its indices start at 'firstIndex' in
+ *  the index buffer, and 0 refers to vertex 'baseVertex' of the vertex
+ *  buffer, so the indices themselves do not change. Every mesh in one
+ *  layout is drawn through the same vertex array, which also makes it
+ *  possible to draw many meshes with one multi-draw call.
+ *
+ *  When a buffer is full it is replaced by one twice as big (or big
+ *  enough for the new mesh), and the old contents are copied across on
+ *  the GPU. Offsets stay the same, but the vertex array changes, so
+ *  always ask the arena for it rather than keeping it.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef GEOMETRYARENA_HPP
+#define GEOMETRYARENA_HPP
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <vector>
+
+#include "FreeListAllocator.hpp"
+#include "VertexLayout.hpp"
+
+class GeometryArena {
+public:
+  // Never the index of a pool
+  static const unsigned int INVALID_POOL = 0xFFFFFFFF;
+  // Where a mesh lives in the arena
+  struct Allocation {
+    // Which of the arena's buffers (one per layout) holds the mesh
+    unsigned int pool{INVALID_POOL};
+    // Added to every index, so index 0 is this vertex
+    unsigned int baseVertex{0};
+    unsigned int vertexCount{0};
+    // Where the mesh's indices start in the index buffer
+    unsigned int firstIndex{0};
+    unsigned int indexCount{0};
+    // The arena's generation when the mesh was added. RemoveAll starts
+    // a new one, and pool indices are reused after it.
+    unsigned int generation{0};
+    inline bool IsValid() const { return pool != INVALID_POOL; }
+  };
+
+  // Singleton pattern for having one single GeometryArena
+  // class at any given time.
+  static GeometryArena &Instance();
+  // Copies 'vertexCount' vertices laid out as 'layout', and
+  // 'indexCount' indices into the arena.
+  Allocation Allocate(const VertexLayout &layout, unsigned int vertexCount,
+                      unsigned int indexCount, const void *vertices,
+                      const unsigned int *indices);
+  // Gives a mesh's ranges back, so other meshes can use them
+  void Free(const Allocation &allocation);
+  // The vertex array every mesh in the allocation's pool is drawn with
+  GLuint GetVertexArray(const Allocation &allocation) const;
+  // The vertex array that reads the same buffers as 'vertexArray'
+  // (one GetVertexArray returned), and per-instance attributes from
+  // 'instanceBuffer'. Returns 0 if 'vertexArray' is not one of ours.
+  GLuint GetInstancedVertexArray(GLuint vertexArray,
+                                 const VertexLayout &instanceLayout,
+                                 GLuint instanceBuffer) const;
+  // Number of vertex and index buffers (two per layout in use)
+  unsigned int GetBufferCount() const;
+  // Bytes of vertices and indices in use, and allocated on the GPU
+  unsigned long GetUsedBytes() const;
+  unsigned long GetCapacityBytes() const;
+  // Sets how many vertices and indices each new pool starts with
+  void SetInitialCapacity(unsigned int vertices, unsigned int indices);
+  // Deletes every buffer. Call this before the OpenGL context is
+  // destroyed. Allocations made before are no longer valid.
+  void RemoveAll();
+
+private:
+  // Constructor is private because we should
+  // not be able to construct any other arenas,
+  // this how we ensure only one is ever created
+  GeometryArena();
+  // Destructor
+  ~GeometryArena();
+  // The buffers of one layout
+  struct Pool {
+    VertexLayout layout;
+    GLuint vertexBuffer{0};
+    GLuint indexBuffer{0};
+    GLuint vertexArray{0};
+    FreeListAllocator vertices;
+    FreeListAllocator indices;
+  };
+  // Returns the index of the pool for 'layout', creating it if needed
+  unsigned int FindPool(const VertexLayout &layout);
+  // Makes sure 'pool' has a free range of at least this many vertices
+  // and indices, growing its buffers if not
+  void Reserve(Pool &pool, unsigned int vertexCount, unsigned int indexCount);
+  // True if 'allocation' was made since the last RemoveAll
+  bool IsCurrent(const Allocation &allocation) const;
+  // Replaces 'buffer' by one of 'newSize' bytes, keeping the first
+  // 'oldSize' bytes
+  static void GrowBuffer(GLuint &buffer, GLsizeiptr oldSize,
+                         GLsizeiptr newSize);
+  std::vector<std::unique_ptr<Pool>> m_pools;
+  unsigned int m_initialVertexCapacity;
+  unsigned int m_initialIndexCapacity;
+  // Counts calls to RemoveAll
+  unsigned int m_generation{0};
+};
+
+#endif
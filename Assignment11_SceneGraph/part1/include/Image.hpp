@@ -12,13 +12,20 @@
 #include <cstdint>
 #include <string>
 
+#include "MappedFile.hpp"
+
 class Image {
 public:
   // Constructor for creating an image
   Image(std::string filepath);
   // Destructor
   ~Image();
+  // Pixel data may live inside of a file mapping, so an
+  // image cannot be copied.
+  Image(const Image &) = delete;
+  Image &operator=(const Image &) = delete;
   // Loads a PPM from memory.
+  // Both binary (P6) and ASCII (P3) files are supported.
   void LoadPPM(bool flip);
   // Return the width
   inline int GetWidth() { return m_width; }
@@ -46,14 +53,30 @@ public:
   }
 
 private:
+  // Reads the magic number, dimensions, and max color value.
+  // Returns false if the header is malformed; otherwise writes the
+  // offset of the first byte after the header to 'offset'.
+  bool ParsePPMHeader(const char *data, std::size_t size, std::size_t &offset);
+  // Loads the pixel data of an ASCII (P3) file
+  bool LoadP3(const char *data, std::size_t size, std::size_t offset,
+              bool flip);
+  // Loads the pixel data of a binary (P6) file
+  bool LoadP6(uint8_t *data, std::size_t size, std::size_t offset, bool flip);
   // Filepath to the image loaded
   std::string m_filepath;
+  // The file we loaded our image from. For binary files
+  // that are not flipped, m_pixelData points directly into
+  // this mapping and no copy of the pixels is made.
+  MappedFile m_file;
   // Raw pixel data
-  uint8_t *m_pixelData;
+  uint8_t *m_pixelData{nullptr};
+  // True if m_pixelData was allocated with new[]
+  bool m_ownsPixelData{false};
   // Size and format of image
   int m_width{0};          // Width of the image
   int m_height{0};         // Height of the image
   int m_BPP{0};            // Bits per pixel (i.e. how colorful are our pixels)
+  int m_maxValue{255};     // Largest value a color component may have
   std::string magicNumber; // magicNumber if any for image format
 };
 
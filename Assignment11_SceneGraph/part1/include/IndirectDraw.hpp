@@ -0,0 +1,83 @@
+/** @file IndirectDraw.hpp
+ *  @brief Draws many meshes with one call, from commands in a buffer.
+ *
+ *  glMultiDrawElementsIndirect reads an array of
+ *  DrawElementsIndirectCommand's from the buffer bound to
+ *  GL_DRAW_INDIRECT_BUFFER and makes every draw in it, as if each had
+ *  been a separate glDrawElementsInstancedBaseVertexBaseInstance.
+ *  Meshes in the GeometryArena share their buffers and vertex array,
+ *  so everything with the same shader and texture can be drawn this
+ *  way with one call.
+ *
+ *  It needs OpenGL 4.3 (or GL_ARB_multi_draw_indirect, together with
+ *  GL_ARB_base_instance before 4.2), while our glad only loads OpenGL
+ *  3.3, so the function is loaded here instead. Check IsSupported
+ *  before drawing; the Renderer draws batch by batch when it is false.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef INDIRECTDRAW_HPP
+#define INDIRECTDRAW_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// One draw, laid out exactly as OpenGL reads it from the buffer
+struct DrawElementsIndirectCommand {
+  // Number of indices
+  GLuint count;
+  GLuint instanceCount;
+  // Where the indices start in the index buffer (in indices, not bytes)
+  GLuint firstIndex;
+  // Added to every index
+  GLint baseVertex;
+  // Added to the instance number when reading attributes
+  // with a divisor (but not to gl_InstanceID)
+  GLuint baseInstance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 5 * sizeof(GLuint),
+              "DrawElementsIndirectCommand should have no padding");
+
+class IndirectDraw {
+public:
+  // True if the current context can draw indirectly. The first call
+  // loads the function, so an OpenGL context must exist.
+  static bool IsSupported();
+  // Makes 'drawCount' draws, reading the commands from the buffer
+  // bound to GL_DRAW_INDIRECT_BUFFER starting at command 'first'
+  static void MultiDrawElements(GLenum mode, unsigned int first,
+                                unsigned int drawCount);
+};
+
+// The buffer indirect draws read their commands from
+class IndirectCommandBuffer {
+public:
+  // Constructor (the buffer is created by the first Upload)
+  IndirectCommandBuffer();
+  // Destructor deletes our buffer
+  ~IndirectCommandBuffer();
+  // A buffer owns a GPU resource, so it cannot be copied.
+  IndirectCommandBuffer(const IndirectCommandBuffer &) = delete;
+  IndirectCommandBuffer &operator=(const IndirectCommandBuffer &) = delete;
+  // Replaces the contents of the buffer with 'commands'
+  void Upload(const std::vector<DrawElementsIndirectCommand> &commands);
+  // Binds the buffer to GL_DRAW_INDIRECT_BUFFER, for the draws that
+  // follow. Upload leaves nothing bound.
+  void Bind() const;
+  // Unbinds GL_DRAW_INDIRECT_BUFFER
+  void Unbind() const;
+
+private:
+  GLuint m_bufferID{0};
+  // Number of bytes our GPU buffer can hold
+  GLsizeiptr m_capacity{0};
+};
+
+#endif
@@ -0,0 +1,90 @@
+/** @file JobSystem.hpp
+ *  @brief Runs small pieces of work (jobs) across every core.
+ *
+ *  The JobSystem starts one worker thread per extra core. Every thread
+ *  (including the main thread) has its own deque of jobs. A thread
+ *  pushes and pops jobs at the back of its own deque, and when it runs
+ *  out of work it steals from the front of another thread's deque.
+ *  Working from opposite ends keeps threads out of each other's way,
+ *  and stealing spreads the work out when some jobs are larger than
+ *  others.
+ *
+ *  Jobs must not make OpenGL calls, since the OpenGL context only
+ *  belongs to the main thread.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the unfinished jobs in a group, so they can be waited on
+typedef std::atomic<unsigned int> JobCounter;
+
+class JobSystem {
+public:
+  // Returns the one instance of our job system
+  static JobSystem &Instance() {
+    static JobSystem *instance = new JobSystem();
+    return *instance;
+  }
+  // Starts 'workerCount' worker threads. By default one is started
+  // for every core other than the one the main thread runs on.
+  void Initialize(unsigned int workerCount = 0);
+  // Stops and joins every worker thread
+  void Shutdown();
+  // Adds a job. 'counter' is incremented now, and decremented once
+  // the job has finished.
+  void Submit(std::function<void()> job, JobCounter &counter);
+  // Runs other jobs until every job counted by 'counter' has finished
+  void Wait(JobCounter &counter);
+  // Runs 'job(i)' for every i from 0 to count-1, and returns once
+  // all of them have finished
+  void ParallelFor(unsigned int count,
+                   const std::function<void(unsigned int)> &job);
+  // Number of threads that run jobs (the workers plus the main thread)
+  inline unsigned int GetThreadCount() const { return m_queues.size(); }
+
+private:
+  JobSystem();
+  ~JobSystem();
+  // A job and the counter to decrement once it is done
+  struct Job {
+    std::function<void()> function;
+    JobCounter *counter;
+  };
+  // Each thread's jobs. The owner works from the back,
+  // and other threads steal from the front.
+  struct JobQueue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+  // The loop each worker thread runs
+  void WorkerLoop(unsigned int queueIndex);
+  // Runs one job from our own queue, or one stolen from another
+  // thread. Returns false if there was no work anywhere.
+  bool RunOneJob(unsigned int queueIndex);
+  // Returns the queue of the thread calling this function
+  unsigned int GetQueueIndex() const;
+
+  // One queue per thread. Queue 0 belongs to the main thread.
+  std::vector<std::unique_ptr<JobQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+  // Number of jobs waiting in any queue
+  std::atomic<unsigned int> m_queuedJobs{0};
+  // Idle workers sleep until a job is submitted
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wakeCondition;
+  bool m_running{false};
+};
+
+#endif
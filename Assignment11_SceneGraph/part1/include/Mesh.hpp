@@ -0,0 +1,71 @@
+/** @file Mesh.hpp
+ *  @brief Geometry together with the GPU buffers it was uploaded to.
+ *
+ *  A mesh is the part of an Object that does not change from one
+ *  object to the next: its vertices, indices and vertex array. The
+ *  vertices and indices are uploaded into the GeometryArena, which
+ *  keeps every mesh of the same vertex layout in one pair of buffers,
+ *  so a mesh is drawn from 'GetFirstIndex' with 'GetBaseVertex'. Objects
+ *  hold their mesh through a shared pointer, so many objects (i.e.
+ *  every Sphere) can draw from the same buffers. Use the MeshRegistry
+ *  to share a mesh between objects.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include "BoundingSphere.hpp"
+#include "Geometry.hpp"
+#include "GeometryArena.hpp"
+
+class Mesh {
+public:
+  // Constructor (the mesh is empty until Upload is called)
+  Mesh();
+  // Destructor, gives our ranges of the arena back
+  ~Mesh();
+  // A mesh owns GPU resources, so it cannot be copied.
+  Mesh(const Mesh &) = delete;
+  Mesh &operator=(const Mesh &) = delete;
+  // The geometry to fill in before calling Upload
+  inline Geometry &GetGeometry() { return m_geometry; }
+  // Generates the vertex data from our geometry in the given
+  // format and copies it into the GeometryArena on the GPU.
+  // The geometry's vertices and indices are freed afterwards.
+  void Upload(VertexFormat format = VertexFormat::Full);
+  // Binds our vertex array (and thus our buffers)
+  void Bind();
+  // Returns the id of our vertex array object, which every mesh in
+  // the same vertex format shares
+  inline GLuint GetVAOID() const {
+    return GeometryArena::Instance().GetVertexArray(m_allocation);
+  }
+  // Number of indices to draw
+  inline unsigned int GetIndexCount() const { return m_allocation.indexCount; }
+  // Where our indices start in the arena's index buffer
+  inline unsigned int GetFirstIndex() const { return m_allocation.firstIndex; }
+  // Added to each of our indices to find the vertex in the arena
+  inline unsigned int GetBaseVertex() const { return m_allocation.baseVertex; }
+  // Returns a sphere enclosing the mesh (in object space)
+  inline const BoundingSphere &GetBoundingSphere() const {
+    return m_geometry.GetBoundingSphere();
+  }
+  // How the vertices are laid out on the GPU
+  inline VertexFormat GetVertexFormat() const {
+    return m_geometry.GetVertexFormat();
+  }
+  // Number of bytes the mesh uses on the GPU
+  inline unsigned int GetSizeInBytes() const { return m_sizeInBytes; }
+
+private:
+  // The vertices and triangles of our mesh
+  Geometry m_geometry;
+  // Where our vertices and indices are in the GeometryArena
+  GeometryArena::Allocation m_allocation;
+  // Stored when we upload, so drawing does not need the geometry
+  unsigned int m_sizeInBytes{0};
+};
+
+#endif
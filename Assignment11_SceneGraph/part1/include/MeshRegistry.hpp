@@ -0,0 +1,87 @@
+/** @file MeshRegistry.hpp
+ *  @brief Singleton that shares procedurally generated meshes.
+ *
+ *  Primitives such as spheres are generated from a handful of
+ *  parameters. The registry keys each mesh by its primitive type and
+ *  those parameters, so the vertices are only generated and uploaded
+ *  the first time they are requested. Every later request returns the
+ *  same Mesh (and thus the same GPU buffers). Like the TextureCache,
+ *  the registry only holds weak references, so a mesh is deleted from
+ *  the GPU as soon as the last object using it is destroyed.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef MESHREGISTRY_HPP
+#define MESHREGISTRY_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include "Mesh.hpp"
+
+// The kinds of primitives we know how to generate
+enum class PrimitiveType : unsigned int { Quad, Sphere };
+
+// Identifies one generated mesh. Primitives that need fewer
+// parameters leave the rest as 0.
+struct MeshKey {
+  PrimitiveType type;
+  // Tessellation parameters, i.e. latitude and longitude bands
+  unsigned int parameters[2];
+  // The same primitive in two vertex formats is two meshes
+  VertexFormat format{VertexFormat::Full};
+
+  bool operator==(const MeshKey &other) const {
+    return type == other.type && parameters[0] == other.parameters[0] &&
+           parameters[1] == other.parameters[1] && format == other.format;
+  }
+};
+
+struct MeshKeyHash {
+  std::size_t operator()(const MeshKey &key) const {
+    std::size_t hash = std::hash<unsigned int>()((unsigned int)key.type);
+    for (unsigned int parameter : key.parameters) {
+      hash = hash * 31 + std::hash<unsigned int>()(parameter);
+    }
+    hash = hash * 31 + std::hash<unsigned int>()((unsigned int)key.format);
+    return hash;
+  }
+};
+
+class MeshRegistry {
+public:
+  // Fills in the geometry of a mesh that is not loaded yet
+  typedef std::function<void(Geometry &)> BuildFunction;
+
+  // Singleton pattern for having one single MeshRegistry
+  // class at any given time.
+  static MeshRegistry &Instance();
+  // Returns the mesh for 'key'. If no one is currently using it,
+  // 'build' is called to fill in its geometry and it is uploaded
+  // in key.format.
+  std::shared_ptr<Mesh> Get(const MeshKey &key, const BuildFunction &build);
+  // Returns how many objects currently share the mesh for 'key'
+  // (0 if it is not loaded).
+  long GetReferenceCount(const MeshKey &key) const;
+  // Returns how many unique meshes are currently loaded
+  unsigned int GetMeshCount() const;
+  // Returns how many bytes the loaded meshes use on the GPU
+  unsigned int GetSizeInBytes() const;
+
+private:
+  // Constructor is private because we should
+  // not be able to construct any other registries,
+  // this how we ensure only one is ever created
+  MeshRegistry();
+  // Destructor
+  ~MeshRegistry();
+  // Removes entries whose mesh has already been deleted
+  void RemoveExpired();
+  // Loaded meshes keyed by their type and parameters
+  std::unordered_map<MeshKey, std::weak_ptr<Mesh>, MeshKeyHash> m_meshes;
+};
+
+#endif
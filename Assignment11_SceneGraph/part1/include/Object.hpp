@@ -13,12 +13,12 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #include "Shader.hpp"
-#include "VertexBufferLayout.hpp"
+#include "Mesh.hpp"
 #include "Texture.hpp"
 #include "Transform.hpp"
-#include "Geometry.hpp"
 
 #include "glm/vec3.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -35,20 +35,49 @@ public:
     ~Object();
     // Load a texture
     void LoadTexture(std::string fileName);
-    // Create a textured quad
-    void MakeTexturedQuad(std::string fileName);
+    // Create a textured quad, with its vertices in 'format'
+    void MakeTexturedQuad(std::string fileName,
+                          VertexFormat format = VertexFormat::Full);
     // How to draw the object
     virtual void Render();
+    // Objects with the same mesh and diffuse texture can be
+    // drawn together with one instanced draw call.
+    inline GLuint GetVertexArrayID() const {
+        return m_mesh != nullptr ? m_mesh->GetVAOID() : 0;
+    }
+    inline GLuint GetDiffuseTextureID() const {
+        return m_textureDiffuse != nullptr ? m_textureDiffuse->GetID() : 0;
+    }
+    // Number of indices to draw
+    inline unsigned int GetIndexCount() const {
+        return m_mesh != nullptr ? m_mesh->GetIndexCount() : 0;
+    }
+    // Where our mesh is in the GeometryArena's buffers. Every mesh
+    // in one vertex format shares a vertex array, so these tell
+    // objects with the same vertex array apart.
+    inline unsigned int GetFirstIndex() const {
+        return m_mesh != nullptr ? m_mesh->GetFirstIndex() : 0;
+    }
+    inline unsigned int GetBaseVertex() const {
+        return m_mesh != nullptr ? m_mesh->GetBaseVertex() : 0;
+    }
+    // How the vertices of our mesh are stored, which
+    // decides the vertex shader that can draw them
+    inline VertexFormat GetVertexFormat() const {
+        return m_mesh != nullptr ? m_mesh->GetVertexFormat() : VertexFormat::Full;
+    }
+    // Returns a sphere enclosing the object (in object space)
+    const BoundingSphere& GetBoundingSphere() const;
 protected: // Classes that inherit from Object are intended to be overridden.
 
 	// Helper method for when we are ready to draw or update our object
 	void Bind();
-    // For now we have one buffer per object.
-    VertexBufferLayout m_vertexBufferLayout;
-    // For now we have one diffuse map and one normal map per object
-    Texture m_textureDiffuse;
-    // Store the objects Geometry
-	Geometry m_geometry;
+    // The geometry and GPU buffers we draw. Primitives get theirs
+    // from the MeshRegistry, so identical objects share one mesh.
+    std::shared_ptr<Mesh> m_mesh;
+    // For now we have one diffuse map per object.
+    // Textures are shared between objects through the TextureCache.
+    std::shared_ptr<Texture> m_textureDiffuse;
 };
 
 
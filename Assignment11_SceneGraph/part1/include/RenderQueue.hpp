@@ -0,0 +1,73 @@
+/** @file RenderQueue.hpp
+ *  @brief Orders draws so that as little state as possible changes.
+ *
+ *  Every draw is given a 64 bit sort key built from the state it needs
+ *  bound, most expensive to change first:
+ *
+ *    bits 60-63  pass      (i.e. opaque objects before anything else)
+ *    bits 48-59  shader
+ *    bits 32-47  texture
+ *    bits 16-31  vertex array
+ *    bits  0-15  depth     (front to back, so hidden pixels are skipped)
+ *
+ *  Sorting the keys puts draws that share a shader next to each other,
+ *  then draws that share a texture, and so on. The keys are sorted with
+ *  a radix sort, which takes linear time and skips any byte that is the
+ *  same in every key (which, with only a few shaders, is most of them).
+ *
+ *  The queue only orders draws, it makes no OpenGL calls. The
+ *  Renderer walks the sorted queue and skips binding anything that is
+ *  already bound.
+ *
+ *  @author Mike
+ *  @bug Ids wider than their field are truncated, so two different
+ *       shaders (or textures, or vertex arrays) may share a key. The
+ *       draws are then not perfectly grouped, but still correct.
+ */
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+// Passes are drawn in this order
+enum class RenderPass : unsigned int { Opaque = 0 };
+
+class RenderQueue {
+public:
+  // One draw in the queue
+  struct Item {
+    uint64_t key;
+    // Whatever the caller needs to make the draw, i.e. a batch index
+    unsigned int value;
+  };
+
+  // Builds a sort key. 'depth' is the distance to the camera
+  // divided by the far plane, so 0 is closest and 1 is furthest.
+  static uint64_t MakeKey(RenderPass pass, unsigned int shader,
+                          unsigned int texture, unsigned int vertexArray,
+                          float depth);
+
+  // Constructor
+  RenderQueue();
+  // Destructor
+  ~RenderQueue();
+  // Removes every item, keeping the memory for the next frame
+  void Clear();
+  // Adds a draw to the queue
+  inline void Push(uint64_t key, unsigned int value) {
+    m_items.push_back(Item{key, value});
+  }
+  // Sorts the items by key. Items with equal keys keep
+  // the order they were pushed in.
+  void Sort();
+  // The items, sorted if Sort was called
+  inline const std::vector<Item> &GetItems() const { return m_items; }
+
+private:
+  std::vector<Item> m_items;
+  // Where items are moved to during each pass of the sort
+  std::vector<Item> m_scratch;
+};
+
+#endif
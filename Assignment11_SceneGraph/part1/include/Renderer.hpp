@@ -18,10 +18,78 @@
 // This renderer is designed specifically for OpenGL.
 #include <glad/glad.h>
 
+#include <unordered_map>
 #include <vector>
 
 #include "SceneNode.hpp"
 #include "Camera.hpp"
+#include "FrameUniforms.hpp"
+#include "Frustum.hpp"
+#include "IndirectDraw.hpp"
+#include "JobSystem.hpp"
+#include "RenderQueue.hpp"
+#include "TextureBuffer.hpp"
+#include "UniformBuffer.hpp"
+
+// One object to draw this frame
+struct DrawCommand{
+    // The node whose object is drawn
+    SceneNode* node;
+    // Index of the node's model matrix
+    unsigned int objectIndex;
+};
+
+// Objects drawn together with one instanced draw call
+struct DrawBatch{
+    // Any one of the nodes in the batch (they all share
+    // the same shader, mesh and texture)
+    SceneNode* node;
+    // Where the batch's object indices start in the instance buffer
+    unsigned int firstInstance;
+    // Number of objects in the batch
+    unsigned int instanceCount;
+    // Distance from the camera to the closest object in the
+    // batch, divided by the far plane
+    float depth;
+};
+
+// Batches drawn together with one indirect multi-draw call
+struct DrawBucket{
+    // Any one of the nodes in the bucket (they all share the same
+    // shader, vertex array and texture, but not always the same mesh)
+    SceneNode* node;
+    // The vertex array that also reads the instance buffer
+    GLuint vertexArray;
+    // The bucket's commands in the indirect buffer
+    unsigned int firstCommand;
+    unsigned int commandCount;
+};
+
+// What a node needs bound to be drawn, and which of the meshes
+// sharing the vertex array it draws. Nodes with equal keys can be
+// drawn in the same batch.
+struct DrawBatchKey{
+    GLuint shader;
+    GLuint vertexArray;
+    GLuint texture;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    bool operator==(const DrawBatchKey& other) const{
+        return shader == other.shader && vertexArray == other.vertexArray &&
+               texture == other.texture && firstIndex == other.firstIndex &&
+               indexCount == other.indexCount;
+    }
+};
+
+struct DrawBatchKeyHash{
+    size_t operator()(const DrawBatchKey& key) const{
+        return (size_t)key.shader * 73856093u ^
+               (size_t)key.vertexArray * 19349663u ^
+               (size_t)key.texture * 83492791u ^
+               (size_t)key.firstIndex * 2654435761u ^
+               (size_t)key.indexCount;
+    }
+};
 
 class Renderer{
 public:
@@ -37,6 +105,36 @@ public:
     // Sets the root of our renderer to some node to
     // draw an entire scene graph
     void setRoot(SceneNode* startingNode);
+    // Number of objects drawn in the last frame
+    unsigned int GetDrawnCount() const { return m_drawCommands.size(); }
+    // Number of objects skipped in the last frame for being off-screen
+    unsigned int GetCulledCount() const { return m_culledCount; }
+    // Number of draw calls made in the last frame
+    unsigned int GetDrawCallCount() const {
+        return m_usingIndirect ? m_buckets.size() : m_batches.size();
+    }
+    // Number of draws the indirect draw calls made in the last frame
+    // (0 when drawing directly)
+    unsigned int GetIndirectCommandCount() const {
+        return m_usingIndirect ? m_indirectCommands.size() : 0;
+    }
+    // Number of shader, vertex array and texture binds made in the
+    // last frame, and how many were skipped because the draw before
+    // had already bound the same thing.
+    unsigned int GetStateChangeCount() const { return m_stateChanges; }
+    unsigned int GetSkippedStateChangeCount() const { return m_skippedStateChanges; }
+    // Turns on (or off) drawing objects that share a mesh, texture
+    // and shader with one instanced draw call.
+    void SetInstancing(bool enabled){ m_instancing = enabled; }
+    // Turns on (or off) drawing every batch that shares a shader,
+    // vertex array and texture with one glMultiDrawElementsIndirect,
+    // rather than one draw call per batch. Only takes effect if the
+    // driver supports it (OpenGL 4.3), see IsIndirectDrawing.
+    void SetIndirectDrawing(bool enabled){ m_indirect = enabled; }
+    // True if the next frame will be drawn indirectly
+    bool IsIndirectDrawing() const{
+        return m_indirect && IndirectDraw::IsSupported();
+    }
     // Returns the camera at an index
     Camera*& GetCamera(unsigned int index){
         if(index > m_cameras.size()-1){
@@ -53,8 +151,69 @@ protected:
     SceneNode* m_root;
     // Store the projection matrix for our camera.
     glm::mat4 m_projectionMatrix;
+    // Camera and light data shared by every object this frame
+    FrameUniforms m_frameUniforms;
+    // Uniform buffer the frame uniforms are uploaded to
+    UniformBuffer m_frameUniformBuffer;
+    // The model matrix of every node drawn this frame
+    TextureBuffer m_modelMatrices{GL_RGBA32F};
+    // The object index of every instance drawn this frame,
+    // grouped by batch
+    TextureBuffer m_instanceBuffer{GL_R32UI};
+    std::vector<unsigned int> m_instanceIndices;
+    // The draw calls to make this frame
+    std::vector<DrawBatch> m_batches;
+    // Finds the batch for each key while batching
+    std::unordered_map<DrawBatchKey, unsigned int, DrawBatchKeyHash> m_batchLookup;
+    // Whether objects are batched together
+    bool m_instancing{true};
+    // The batches, sorted so that draws sharing state are together
+    RenderQueue m_renderQueue;
+    // Whether indirect drawing was asked for, and used this frame
+    bool m_indirect{false};
+    bool m_usingIndirect{false};
+    // One command per batch, in the order of the render queue
+    std::vector<DrawElementsIndirectCommand> m_indirectCommands;
+    IndirectCommandBuffer m_indirectBuffer;
+    // Runs of commands that share a shader, vertex array and texture
+    std::vector<DrawBucket> m_buckets;
+    // What is currently bound, so Render only binds what changed
+    GLuint m_boundProgram{0};
+    GLuint m_boundVertexArray{0};
+    GLuint m_boundTexture{0};
+    unsigned int m_stateChanges{0};
+    unsigned int m_skippedStateChanges{0};
+    // Everything to draw this frame, in order
+    std::vector<DrawCommand> m_drawCommands;
+    // Draw commands gathered by each chunk of the scene tree
+    std::vector<std::vector<DrawCommand>> m_chunkCommands;
+    // Chunks of the scene tree that are updated by the job system
+    std::vector<unsigned int> m_parallelChunks;
+    // What the camera can see this frame
+    Frustum m_frustum;
+    // Set for serial chunks whose whole subtree is off-screen
+    std::vector<unsigned char> m_hiddenSubtrees;
+    // Objects culled in each chunk, and in total
+    std::vector<unsigned int> m_chunkCulledCounts;
+    unsigned int m_culledCount{0};
 
 private:
+    // Groups this frame's draw commands into batches
+    void BuildBatches();
+    // Adds every batch to the render queue and sorts it
+    void SortBatches();
+    // Turns the sorted batches into indirect commands and buckets
+    void BuildIndirectCommands();
+    // How far the node at 'index' is from the camera (see DrawBatch)
+    float GetDepth(unsigned int index) const;
+    // Each of these binds 'id', unless it is already bound
+    void BindProgram(Shader& shader);
+    void BindVertexArray(GLuint id);
+    void BindTexture(GLuint id);
+    // Gathers the draw commands of the visible objects in one chunk
+    // of the scene tree. Runs on the job system's threads, so no
+    // OpenGL calls are allowed!
+    void CullChunk(unsigned int chunk);
     // Screen dimension constants
     int m_screenHeight;
     int m_screenWidth;
@@ -7,14 +7,18 @@
  *  The traversal of the tree takes place starting from
  *  a single SceneNode (typically called root).
  *
+ *  The transforms and hierarchy of every node are stored in
+ *  the SceneTree, and a SceneNode is a handle to its entry.
+ *
  *  @author Mike
  *  @bug No known bugs.
  */
 
+#include <memory>
 #include <vector>
 
-#include "Camera.hpp"
 #include "Object.hpp"
+#include "SceneTree.hpp"
 #include "Shader.hpp"
 #include "Transform.hpp"
 
@@ -33,35 +37,43 @@ public:
   ~SceneNode();
   // Adds a child node to our current node.
   void AddChild(SceneNode *n);
-  // Draws the current SceneNode
-  void Draw();
-  // Updates the current SceneNode
-  void Update(glm::mat4 projectionMatrix, Camera *camera);
+  // Updates the world transform of the current SceneNode
+  // and all of its children
+  void Update();
   // Returns the local transformation transform
   // Remember that local is local to an object, where it's center is the origin.
   Transform &GetLocalTransform();
-  // Returns a SceneNode's world transform
-  Transform &GetWorldTransform();
-  // For now we have one shader per Node.
-  Shader m_shader;
-
-  // NOTE: Protected members are accessible by anything
-  // that we inherit from, as well as ?
-protected:
-  // Parent
-  SceneNode *m_parent;
+  // Returns a SceneNode's world transform matrix
+  const glm::mat4 &GetWorldMatrix();
+  // Returns this node's id in the SceneTree
+  inline unsigned int GetID() const { return m_id; }
+  // Returns true if this node has an object to draw
+  inline bool HasObject() const { return m_object != nullptr; }
+  // Returns the object stored in this node
+  inline Object *GetObject() const { return m_object; }
+  // Draws 'instanceCount' copies of this node's object. The object
+  // index of each copy is read from the instance buffer, starting at
+  // 'firstInstance' (see Renderer::Render). The renderer binds the
+  // shader, vertex array and texture beforehand, skipping whatever
+  // the previous draw already bound.
+  void DrawInstances(unsigned int firstInstance, unsigned int instanceCount);
+  // Makes 'drawCount' draws from the commands in the bound indirect
+  // buffer, starting at command 'first' (see Renderer::Render). The
+  // commands may draw any object that shares this node's shader,
+  // vertex array and texture.
+  void DrawIndirect(unsigned int first, unsigned int drawCount);
+  // Shader used by this node (shared with every other
+  // node through the ShaderManager).
+  std::shared_ptr<Shader> m_shader;
 
 private:
-  // Children holds all a pointer to all of the descendents
-  // of a particular SceneNode. A pointer is used because
-  // we do not want to hold or make actual copies.
-  std::vector<SceneNode *> m_children;
+  // Our entry in the SceneTree
+  unsigned int m_id;
   // The object stored in the scene graph
   Object *m_object;
-  // Each SceneNode nodes locals transform.
-  Transform m_localTransform;
-  // We additionally can store the world transform
-  Transform m_worldTransform;
+  // Location of the only uniform we set per node, looked up
+  // once when the node is created.
+  UniformHandle<int> m_instanceBaseUniform;
 };
 
 #endif
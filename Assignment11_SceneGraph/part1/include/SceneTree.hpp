@@ -0,0 +1,182 @@
+/** @file SceneTree.hpp
+ *  @brief Stores the transforms of every SceneNode in flat arrays.
+ *
+ *  Rather than each SceneNode holding its own transforms and a list
+ *  of pointers to its children, the SceneTree keeps the local and
+ *  world transform of every node in contiguous arrays. The arrays are
+ *  sorted depth first, so a parent always comes before its children,
+ *  and each node's descendents directly follow it. World transforms
+ *  can then be computed in a single pass from front to back.
+ *  Only nodes whose local transform (or an ancestor's) has changed
+ *  since the last update are recomputed.
+ *
+ *  Alongside the world transforms, the tree keeps a world space
+ *  bounding sphere for each node, and one that encloses the node's
+ *  whole subtree, so hidden parts of the scene can be skipped at once.
+ *
+ *  Separate subtrees do not depend on each other, so a large tree can
+ *  also be split into chunks that are updated on different threads
+ *  (see SplitIntoChunks and Renderer::Update).
+ *
+ *  A SceneNode is a handle to one entry in the tree. Each node is
+ *  given an 'id' when it is created, which never changes. Its 'index'
+ *  (where it is stored in the arrays) changes whenever the hierarchy
+ *  does, so references returned by the tree should not be kept.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef SCENETREE_HPP
+#define SCENETREE_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "BoundingSphere.hpp"
+#include "Transform.hpp"
+
+#include "glm/mat4x4.hpp"
+
+class SceneNode;
+
+class SceneTree {
+public:
+  // Returns the one instance of our scene tree
+  static SceneTree &Instance() {
+    static SceneTree *instance = new SceneTree();
+    return *instance;
+  }
+  // Adds a node (with no parent) to the tree and returns its id
+  unsigned int CreateNode(SceneNode *node);
+  // Removes a node from the tree. Its children become root nodes.
+  void DestroyNode(unsigned int id);
+  // Makes 'parent' the parent of 'child'
+  void SetParent(unsigned int child, unsigned int parent);
+  // Computes the world transform of a node and all of its descendents.
+  // Nodes are only recomputed if their local transform or the world
+  // transform of their parent changed, so parents must be up to date.
+  void Update(unsigned int id);
+  // Part of the tree that can be updated on its own
+  struct Chunk {
+    // Range of indices in the chunk
+    unsigned int begin;
+    unsigned int end;
+    // A 'serial' chunk is a single node that had too many descendents
+    // to be one chunk. Serial chunks must be updated in order before
+    // any other chunk. All other chunks can be updated at the same time.
+    bool serial;
+  };
+  // Splits the subtree of a node into chunks of at most 'chunkSize'
+  // nodes, stored in depth first order, and returns how many there are.
+  // This replaces Update(id) with a call to UpdateChunk for each chunk.
+  unsigned int SplitIntoChunks(unsigned int id, unsigned int chunkSize);
+  // Returns a chunk from the last SplitIntoChunks
+  inline const Chunk &GetChunk(unsigned int chunk) const {
+    return m_chunks[chunk];
+  }
+  // Computes the world transforms of every node in a chunk.
+  // Safe to call from any thread, on different chunks at once.
+  void UpdateChunk(unsigned int chunk);
+  // Finishes the subtree bounds of the serial chunks, which enclose
+  // other chunks. Call once every chunk has been updated.
+  void MergeChunkBounds();
+  // Number of world transforms computed by the last update
+  inline unsigned int GetRecomputedCount() const {
+    return m_recomputedCount.load();
+  }
+  // Number of nodes visited by the last Update
+  inline unsigned int GetVisitedCount() const { return m_visitedCount; }
+  // Returns the local transform of a node, which can then be modified
+  Transform &GetLocalTransform(unsigned int id);
+  // Returns the world transform computed by the last Update
+  const glm::mat4 &GetWorldMatrix(unsigned int id);
+  // Sets the object space bounding sphere of a node
+  void SetLocalBounds(unsigned int id, const BoundingSphere &bounds);
+  // Returns the world space bounding sphere of the node at 'index'
+  inline const BoundingSphere &GetWorldBounds(unsigned int index) const {
+    return m_worldBounds[index];
+  }
+  // Returns a sphere enclosing the node at 'index' and all of its
+  // descendents
+  inline const BoundingSphere &GetSubtreeBounds(unsigned int index) const {
+    return m_subtreeBounds[index];
+  }
+  // Returns the ids of the children of a node
+  const std::vector<unsigned int> &GetChildren(unsigned int id) const;
+  // Returns where a node is stored in the arrays.
+  // This is also the index of its world matrix in GetWorldMatrices.
+  unsigned int GetIndex(unsigned int id);
+  // Returns the index one past the last descendent of the node at 'index'
+  inline unsigned int GetSubtreeEnd(unsigned int index) const {
+    return m_subtreeEnds[index];
+  }
+  // Returns the index of the parent of the node at 'index',
+  // or -1 for a root node
+  inline int GetParent(unsigned int index) const { return m_parents[index]; }
+  // Returns the node stored at 'index'
+  inline SceneNode *GetNode(unsigned int index) const {
+    return m_nodes[index];
+  }
+  // Returns the node with the given id
+  inline SceneNode *GetNodeFromID(unsigned int id) const {
+    return m_nodes[m_indices[id]];
+  }
+  // World matrix of every node in the tree, in index order
+  inline const glm::mat4 *GetWorldMatrices() const {
+    return m_worldMatrices.data();
+  }
+  // Number of nodes stored in the arrays
+  inline unsigned int GetNodeCount() const { return m_nodes.size(); }
+
+private:
+  SceneTree();
+  ~SceneTree();
+  // Re-sorts the arrays if the hierarchy has changed
+  void Sort();
+  // Updates the world transforms from index 'begin' to 'end', and returns
+  // how many were recomputed. 'parentUpdated' says whether the parent of
+  // 'begin' was part of the same update.
+  unsigned int UpdateRange(unsigned int begin, unsigned int end,
+                           bool parentUpdated);
+
+  // ---- Stored by index (sorted, parents before children) ----
+  // Local transform of each node
+  std::vector<Transform> m_localTransforms;
+  // World matrix of each node
+  std::vector<glm::mat4> m_worldMatrices;
+  // Index of each node's parent, or -1 for a root node
+  std::vector<int> m_parents;
+  // Index one past each node's last descendent
+  std::vector<unsigned int> m_subtreeEnds;
+  // Object space bounding sphere of each node
+  std::vector<BoundingSphere> m_localBounds;
+  // World space bounding sphere of each node
+  std::vector<BoundingSphere> m_worldBounds;
+  // World space sphere around each node and its descendents
+  std::vector<BoundingSphere> m_subtreeBounds;
+  // Whether each node's world matrix changed in the last Update
+  std::vector<unsigned char> m_worldChanged;
+  // The SceneNode that owns each entry
+  std::vector<SceneNode *> m_nodes;
+
+  // ---- Stored by id (never moves) ----
+  // Where each node is currently stored
+  std::vector<unsigned int> m_indices;
+  // Parent id of each node, or -1 for a root node
+  std::vector<int> m_parentIds;
+  // Children ids of each node, in the order they were added
+  std::vector<std::vector<unsigned int>> m_childIds;
+
+  // True when the hierarchy has changed since the last Sort
+  bool m_needsSort{false};
+  // Chunks from the last SplitIntoChunks
+  std::vector<Chunk> m_chunks;
+  // Index of the node the chunks were split from
+  unsigned int m_chunksFirst{0};
+
+  // Counters from the last update
+  std::atomic<unsigned int> m_recomputedCount{0};
+  unsigned int m_visitedCount{0};
+};
+
+#endif
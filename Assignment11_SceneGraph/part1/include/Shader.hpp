@@ -11,46 +11,88 @@
 #define SHADER_HPP
 
 #include <string>
+#include <unordered_map>
 
 #include <SDL2/SDL.h>
 
 #include <glad/glad.h>
 
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+
+// A handle to the location of a uniform in a shader.
+// Handles are looked up once (i.e. when an object is created), and
+// then used to set the uniform without any string work. The type
+// parameter makes sure a handle is only set with a matching value.
+template <typename T> struct UniformHandle {
+  GLint location{-1};
+};
+
 class Shader {
 public:
   // Shader constructor
   Shader();
   // Shader Destructor
   ~Shader();
+  // A shader owns an OpenGL program, so it cannot be copied.
+  // Use the ShaderManager to share a program between objects.
+  Shader(const Shader &) = delete;
+  Shader &operator=(const Shader &) = delete;
   // Use this shader in our pipeline.
+  // Does nothing if this shader is already in use.
   void Bind() const;
   // Remove shader from our pipeline
   void Unbind() const;
   // Load a shader
-  std::string LoadShader(const std::string &fname);
+  static std::string LoadShader(const std::string &fname);
   // Create a Shader from a loaded vertex and fragment shader
   void CreateShader(const std::string &vertexShaderSource,
                     const std::string &fragmentShaderSource);
   // return the shader id
   GLuint GetID() const;
+  // Returns the location of a uniform, or -1 if the shader has no
+  // active uniform with that name. Locations are looked up in a table
+  // built when the shader was linked, rather than asking OpenGL.
+  GLint GetUniformLocation(const GLchar *name) const;
+  // Returns a typed handle that can be used with SetUniform
+  template <typename T>
+  UniformHandle<T> GetUniformHandle(const GLchar *name) const {
+    UniformHandle<T> handle;
+    handle.location = GetUniformLocation(name);
+    return handle;
+  }
   // Set our uniforms for our shader.
   void SetUniformMatrix4fv(const GLchar *name, const GLfloat *value);
   void SetUniform3f(const GLchar *name, float v0, float v1, float v2);
   void SetUniform1i(const GLchar *name, int value);
   void SetUniform1f(const GLchar *name, float value);
+  // Set our uniforms through a handle (no string lookup at all).
+  void SetUniform(UniformHandle<glm::mat4> handle, const glm::mat4 &value);
+  void SetUniform(UniformHandle<glm::vec3> handle, const glm::vec3 &value);
+  void SetUniform(UniformHandle<int> handle, int value);
+  void SetUniform(UniformHandle<float> handle, float value);
+  // Reads the uniform block 'blockName' from the uniform buffer
+  // attached to 'bindingPoint' (see UniformBuffer).
+  void BindUniformBlock(const GLchar *blockName, GLuint bindingPoint);
 
 private:
   // Compiles loaded shaders
   unsigned int CompileShader(unsigned int type, const std::string &source);
   // Makes sure shaders 'linked' successfully
   bool CheckLinkStatus(GLuint programID);
+  // Stores the location of every active uniform in m_uniformLocations
+  void ReflectUniforms();
   // Shader loading utility programs
   void PrintProgramLog(GLuint program);
   void PrintShaderLog(GLuint shader);
   // Logs an error message
-  void Log(const char *system, const char *message);
+  static void Log(const char *system, const char *message);
   // The unique shaderID
-  GLuint m_shaderID;
+  GLuint m_shaderID{0};
+  // Location of every active uniform, keyed by name
+  std::unordered_map<std::string, GLint> m_uniformLocations;
+  // The program most recently passed to glUseProgram
+  static GLuint s_boundShaderID;
 };
 
 #endif
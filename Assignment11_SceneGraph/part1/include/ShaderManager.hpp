@@ -0,0 +1,61 @@
+/** @file ShaderManager.hpp
+ *  @brief This Singleton class manages all of the shaders that have been created
+ *
+ *  The shader manager handles all of the shaders that have been loaded.
+ *  Shader programs are identified by a hash of their vertex and fragment
+ *  source, so asking for the same program twice (e.g. once per SceneNode)
+ *  compiles and links it only once, and every caller shares the same
+ *  program handle.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef SHADERMANAGER_HPP
+#define SHADERMANAGER_HPP
+
+#include <unordered_map>
+#include <memory>
+#include <string>
+
+#include "Shader.hpp"
+
+class ShaderManager{
+public:
+    // Singleton pattern for having one single ShaderManager
+    // class at any given time.
+    static ShaderManager& Instance();
+    // Returns a shader created from a vertex and fragment shader file.
+    // Files that were already loaded are not read from disk again.
+    std::shared_ptr<Shader> LoadShader(const std::string& vertexShaderPath,
+                                       const std::string& fragmentShaderPath);
+    // Returns a shader created from vertex and fragment shader source.
+    // If a program with the same source exists, it is shared instead of
+    // compiling a new one.
+    std::shared_ptr<Shader> CreateShader(const std::string& vertexShaderSource,
+                                         const std::string& fragmentShaderSource);
+    // Returns how many unique shader programs have been linked
+    unsigned int GetProgramCount() const;
+    // Releases all of the shaders held by the manager.
+    // Call this before the OpenGL context is destroyed.
+    void RemoveAll();
+
+private:
+    // ShaderManager Constructor
+    ShaderManager() {}
+    // ShaderManager Destructor
+    ~ShaderManager() {}
+    // A linked program, along with the source used to build it.
+    // The source is kept so that two different programs that happen
+    // to have the same hash are never mixed up.
+    struct ShaderEntry{
+        std::string vertexShaderSource;
+        std::string fragmentShaderSource;
+        std::shared_ptr<Shader> shader;
+    };
+    // Shader programs keyed by the hash of their source
+    std::unordered_multimap<std::size_t, ShaderEntry> m_shaders;
+    // Shader programs keyed by the files they were loaded from
+    std::unordered_map<std::string, std::shared_ptr<Shader>> m_shadersByPath;
+};
+
+#endif
@@ -2,12 +2,14 @@
  *  @brief Draw a simple sphere primitive.
  *
  *  Draws a simple sphere primitive, that is derived
- *  from the Object class.
+ *  from the Object class. Spheres with the same number of
+ *  bands share one mesh through the MeshRegistry, so creating
+ *  many spheres only generates and uploads the vertices once.
  *
  *  @author Mike
  *  @bug No known bugs.
  */
-#include "VertexBufferLayout.hpp"
+#include "MeshRegistry.hpp"
 #include "Geometry.hpp"
 #include <cmath>
 
@@ -15,28 +17,56 @@ class Sphere : public Object{
 public:
 
     // Constructor for the Sphere
-    Sphere();
+    // The bands set how finely the sphere is tessellated, and the
+    // format how its vertices are stored (see VertexFormat.hpp).
+    Sphere(unsigned int latitudeBands = 30, unsigned int longitudeBands = 30,
+           VertexFormat format = VertexFormat::Full);
     // The initialization routine for this object.
     void Init();
+    // Fills in 'geometry' with a sphere of the given bands
+    static void Build(Geometry& geometry, unsigned int latitudeBands,
+                      unsigned int longitudeBands);
+private:
+    unsigned int m_latitudeBands;
+    unsigned int m_longitudeBands;
+    VertexFormat m_format;
 };
 
 // Calls the initialization routine
-Sphere::Sphere(){
+Sphere::Sphere(unsigned int latitudeBands, unsigned int longitudeBands,
+               VertexFormat format) :
+    m_latitudeBands(latitudeBands), m_longitudeBands(longitudeBands),
+    m_format(format){
     Init();
 }
 
+// Looks up our mesh, only building it if no other
+// sphere with the same bands and format is using it.
+void Sphere::Init(){
+    unsigned int latitudeBands = m_latitudeBands;
+    unsigned int longitudeBands = m_longitudeBands;
+    m_mesh = MeshRegistry::Instance().Get(
+        {PrimitiveType::Sphere,{latitudeBands,longitudeBands},m_format},
+        [latitudeBands,longitudeBands](Geometry& geometry){
+            Build(geometry,latitudeBands,longitudeBands);
+        });
+}
+
 
 // Algorithm for rendering a sphere
 // The algorithm was obtained here: http://learningwebgl.com/blog/?p=1253
 // Please review the page so you can understand the algorithm. You may think
 // back to your algebra days and equation of a circle! (And some trig with
 // how sin and cos work
-void Sphere::Init(){
-    unsigned int latitudeBands = 30;
-    unsigned int longitudeBands = 30;
+void Sphere::Build(Geometry& geometry, unsigned int latitudeBands,
+                   unsigned int longitudeBands){
     float radius = 1.0f;
     double PI = 3.14159265359;
 
+        // We know exactly how much we will add
+        geometry.Reserve((latitudeBands+1)*(longitudeBands+1),
+                         latitudeBands*longitudeBands*6);
+
         for(unsigned int latNumber = 0; latNumber <= latitudeBands; latNumber++){
             float theta = latNumber * PI / latitudeBands;
             float sinTheta = sin(theta);
@@ -55,7 +85,7 @@ void Sphere::Init(){
                 float v = 1 - ((float)latNumber / (float)latitudeBands);
 
                 // Setup geometry
-                m_geometry.AddVertex(radius*x,radius*y,radius*z,u,v);   // Position
+                geometry.AddVertex(radius*x,radius*y,radius*z,u,v);   // Position
             }
         }
 
@@ -64,30 +94,20 @@ void Sphere::Init(){
         // index element buffer.
         // This diagram shows it nicely visually
         // http://learningwebgl.com/lessons/lesson11/sphere-triangles.png
+        // The triangles are counter-clockwise seen from outside, so
+        // their normals point out of the sphere.
         for (unsigned int latNumber1 = 0; latNumber1 < latitudeBands; latNumber1++){
             for (unsigned int longNumber1 = 0; longNumber1 < longitudeBands; longNumber1++){
                 unsigned int first = (latNumber1 * (longitudeBands + 1)) + longNumber1;
                 unsigned int second = first + longitudeBands + 1;
-                m_geometry.AddIndex(first);
-                m_geometry.AddIndex(second);
-                m_geometry.AddIndex(first+1);
-
-                m_geometry.AddIndex(second);
-                m_geometry.AddIndex(second+1);
-                m_geometry.AddIndex(first+1);
+                geometry.MakeTriangle(first,first+1,second);
+                geometry.MakeTriangle(second,first+1,second+1);
             }
         }
+        // Now every triangle is known, compute the normals
+        // and tangents that each vertex shares with its neighbours.
+        geometry.ComputeTangentFrames();
 
-        // Finally generate a simple 'array of bytes' that contains
-        // everything for our buffer to work with.
-        m_geometry.Gen();
-
-        // std::cout << "#vertices:" << geometry.getSize() << "\n";
-        // std::cout << "#indices:" << geometry.getIndicesSize() << "\n";
-
-        // Create a buffer and set the stride of information
-        m_vertexBufferLayout.CreateNormalBufferLayout(m_geometry.GetBufferDataSize(),
-                                        m_geometry.GetIndicesSize(),
-                                        m_geometry.GetBufferDataPtr(),
-                                        m_geometry.GetIndicesDataPtr());
+        // The registry generates the 'array of bytes' and
+        // uploads it once we return.
 }
@@ -9,7 +9,6 @@
 #ifndef TERRAIN_HPP
 #define TERRAIN_HPP
 
-#include "VertexBufferLayout.hpp"
 #include "Texture.hpp"
 #include "Shader.hpp"
 #include "Image.hpp"
@@ -28,7 +27,7 @@ public:
     void Init();
     // Loads a heightmap based on a PPM image
     // This then sets the heights of the terrain.
-    void LoadHeightMap(Image image);
+    void LoadHeightMap(Image &image);
 
 private:
     // data
@@ -9,8 +9,6 @@
 #ifndef TEXTURE_HPP
 #define TEXTURE_HPP
 
-#include "Image.hpp"
-
 #include <glad/glad.h>
 #include <string>
 
@@ -20,7 +18,12 @@ public:
     Texture();
     // Destructor
     ~Texture();
+    // A texture owns a GPU resource, so it cannot be copied.
+    // Use the TextureCache to share a texture between objects.
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
 	// Loads and sets up an actual texture
+    // The image data is released once it is on the GPU.
     void LoadTexture(const std::string filepath);
 	// slot tells us which slot we want to bind to.
     // We can have multiple slots. By default, we
@@ -28,13 +31,13 @@ public:
     void Bind(unsigned int slot=0) const;
     // Be done with our texture
     void Unbind();
+    // Returns the OpenGL id of our texture
+    inline GLuint GetID() const { return m_textureID; }
 private:
     // Store a unique ID for the texture
-    GLuint m_textureID;
+    GLuint m_textureID{0};
 	// Filepath to the image loaded
     std::string m_filepath;
-    // Store whatever image data inside of our texture class.
-    Image* m_image;
 };
 
 
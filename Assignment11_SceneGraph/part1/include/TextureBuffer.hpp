@@ -0,0 +1,46 @@
+/** @file TextureBuffer.hpp
+ *  @brief A large array of data that shaders can read from.
+ *
+ *  A texture buffer is a buffer object that a shader reads like a
+ *  one dimensional texture (with texelFetch). Unlike a uniform buffer
+ *  it has no practical size limit, which makes it a good fit for data
+ *  with one entry per object, such as every object's model matrix.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef TEXTUREBUFFER_HPP
+#define TEXTUREBUFFER_HPP
+
+#include <glad/glad.h>
+
+class TextureBuffer {
+public:
+  // 'format' is the format of one texel, i.e. GL_RGBA32F
+  // for one column of a matrix, or GL_R32UI for an index.
+  TextureBuffer(GLenum format);
+  // Destructor deletes our buffer and texture
+  ~TextureBuffer();
+  // A buffer owns a GPU resource, so it cannot be copied.
+  TextureBuffer(const TextureBuffer &) = delete;
+  TextureBuffer &operator=(const TextureBuffer &) = delete;
+  // Replaces the contents of the buffer with 'size' bytes of 'data'
+  void Upload(const void *data, GLsizeiptr size);
+  // Binds the buffer's texture to a texture slot
+  void Bind(unsigned int slot) const;
+  // The buffer itself, so it can also be read as a vertex attribute
+  // (0 until the first Upload). Growing keeps the same buffer.
+  inline GLuint GetBufferID() const { return m_bufferID; }
+
+private:
+  // Format of each texel
+  GLenum m_format;
+  // The buffer holding our data on the GPU
+  GLuint m_bufferID{0};
+  // The texture used to read from our buffer in a shader
+  GLuint m_textureID{0};
+  // Number of bytes our GPU buffer can hold
+  GLsizeiptr m_capacity{0};
+};
+
+#endif
@@ -0,0 +1,49 @@
+/** @file TextureCache.hpp
+ *  @brief Singleton that shares textures between objects.
+ *
+ *  Textures are keyed by their file path. Requesting the same path
+ *  twice returns the same Texture (and thus the same OpenGL handle),
+ *  so each image is only read from disk and uploaded to the GPU once.
+ *  The cache only holds weak references, so a texture is deleted
+ *  from the GPU as soon as the last object using it is destroyed.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef TEXTURECACHE_HPP
+#define TEXTURECACHE_HPP
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Texture.hpp"
+
+class TextureCache {
+public:
+  // Singleton pattern for having one single TextureCache
+  // class at any given time.
+  static TextureCache &Instance();
+  // Returns the texture for 'filepath', loading it
+  // only if no one else is currently using it.
+  std::shared_ptr<Texture> Get(const std::string &filepath);
+  // Returns how many objects currently share the texture
+  // loaded from 'filepath' (0 if it is not loaded).
+  long GetReferenceCount(const std::string &filepath) const;
+  // Returns how many unique textures are currently loaded
+  unsigned int GetTextureCount() const;
+
+private:
+  // Constructor is private because we should
+  // not be able to construct any other caches,
+  // this how we ensure only one is ever created
+  TextureCache();
+  // Destructor
+  ~TextureCache();
+  // Removes entries whose texture has already been deleted
+  void RemoveExpired();
+  // Loaded textures keyed by their filepath
+  std::unordered_map<std::string, std::weak_ptr<Texture>> m_textures;
+};
+
+#endif
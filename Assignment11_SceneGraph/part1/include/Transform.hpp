@@ -36,8 +36,15 @@ public:
     // Takes in a transform and sets internal
     // matrix.
     void ApplyTransform(Transform t);
-    // Returns the transformation matrix
-    glm::mat4 GetInternalMatrix() const;
+    // Returns the transformation matrix (by reference, to avoid a copy)
+    const glm::mat4& GetInternalMatrix() const;
+    // Returns true if the matrix has changed since ClearDirty was called.
+    // Every function that modifies the matrix marks it dirty.
+    inline bool IsDirty() const { return m_dirty; }
+    // Marks the matrix as changed
+    inline void MarkDirty() { m_dirty = true; }
+    // Marks the matrix as unchanged (i.e. once it has been used)
+    inline void ClearDirty() { m_dirty = false; }
 
     // Transform multiplication t1 *= t2 (t1 is multiplied and a new result stored)
 	Transform& operator*=(const Transform& t);
@@ -57,6 +64,8 @@ public:
 private:
     // Stores the actual transformation matrix
     glm::mat4 m_modelTransformMatrix;
+    // True when the matrix has been modified
+    bool m_dirty{true};
 };
 
 
@@ -0,0 +1,38 @@
+/** @file UniformBuffer.hpp
+ *  @brief Wraps an OpenGL uniform buffer object (UBO).
+ *
+ *  A uniform buffer holds a block of uniforms that can be shared by
+ *  many shader programs. The buffer is attached to a binding point,
+ *  and each shader connects its uniform block to the same point
+ *  (see Shader::BindUniformBlock).
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef UNIFORMBUFFER_HPP
+#define UNIFORMBUFFER_HPP
+
+#include <glad/glad.h>
+
+class UniformBuffer {
+public:
+  // Constructor
+  UniformBuffer();
+  // Destructor deletes our buffer
+  ~UniformBuffer();
+  // A buffer owns a GPU resource, so it cannot be copied.
+  UniformBuffer(const UniformBuffer &) = delete;
+  UniformBuffer &operator=(const UniformBuffer &) = delete;
+  // Allocates 'size' bytes and attaches the buffer to 'bindingPoint'
+  void Create(GLsizeiptr size, GLuint bindingPoint);
+  // Replaces the contents of the buffer
+  void Update(const void *data, GLsizeiptr size);
+
+private:
+  // The buffer object
+  GLuint m_bufferID{0};
+  // Size of our buffer in bytes
+  GLsizeiptr m_size{0};
+};
+
+#endif
@@ -0,0 +1,89 @@
+/** @file VertexArrayCache.hpp
+ *  @brief Singleton that shares vertex array objects between meshes.
+ *
+ *  A vertex array object (VAO) remembers which buffers a draw reads
+ *  and how its attributes sit in them. Two meshes that read the same
+ *  buffers with the same VertexLayout need the same VAO, so the cache
+ *  keys VAOs by (layout, vertex buffer, index buffer) and only creates
+ *  one the first time a pair is asked for. Meshes that share a buffer
+ *  then share a VAO, and the renderer does not have to switch between
+ *  them.
+ *
+ *  A vertex array may also read a second buffer of per-instance data
+ *  (attributes with a divisor), i.e. which object each instance is.
+ *
+ *  The cache does not own the buffers. Whoever deletes a buffer should
+ *  call Remove, which deletes every VAO that read from it.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef VERTEXARRAYCACHE_HPP
+#define VERTEXARRAYCACHE_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "VertexLayout.hpp"
+
+class VertexArrayCache {
+public:
+  // Singleton pattern for having one single VertexArrayCache
+  // class at any given time.
+  static VertexArrayCache &Instance();
+  // Returns a vertex array reading 'vertexBuffer' with 'layout', and
+  // 'indexBuffer' for its indices, creating it if there is none yet.
+  GLuint Get(const VertexLayout &layout, GLuint vertexBuffer,
+             GLuint indexBuffer);
+  // The same, also reading 'instanceBuffer' with 'instanceLayout'
+  GLuint Get(const VertexLayout &layout, GLuint vertexBuffer,
+             GLuint indexBuffer, const VertexLayout &instanceLayout,
+             GLuint instanceBuffer);
+  // Deletes every vertex array that reads from 'buffer' (as its
+  // vertex, index or instance buffer). Call it before deleting a buffer.
+  void Remove(GLuint buffer);
+  // Returns how many vertex arrays currently exist
+  unsigned int GetVertexArrayCount() const;
+  // Deletes all of the vertex arrays.
+  // Call this before the OpenGL context is destroyed.
+  void RemoveAll();
+
+private:
+  // Constructor is private because we should
+  // not be able to construct any other caches,
+  // this how we ensure only one is ever created
+  VertexArrayCache();
+  // Destructor
+  ~VertexArrayCache();
+  // What a vertex array is made of
+  struct Key {
+    VertexLayout layout;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    // No attributes and buffer 0 if there is no instance data
+    VertexLayout instanceLayout;
+    GLuint instanceBuffer;
+    bool operator==(const Key &other) const {
+      return vertexBuffer == other.vertexBuffer &&
+             indexBuffer == other.indexBuffer &&
+             instanceBuffer == other.instanceBuffer &&
+             layout == other.layout && instanceLayout == other.instanceLayout;
+    }
+  };
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const;
+  };
+  // Returns the vertex array for 'key', creating it if needed
+  GLuint Get(const Key &key);
+  // Creates a vertex array for 'key'
+  static GLuint Create(const Key &key);
+  // Points each attribute of 'layout' at the buffer bound
+  // to GL_ARRAY_BUFFER
+  static void SetAttributes(const VertexLayout &layout);
+  // Vertex arrays keyed by what they are made of
+  std::unordered_map<Key, GLuint, KeyHash> m_vertexArrays;
+};
+
+#endif
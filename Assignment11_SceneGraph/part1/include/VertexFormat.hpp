@@ -0,0 +1,86 @@
+/** @file VertexFormat.hpp
+ *  @brief The ways Geometry can lay out its vertices for the GPU.
+ *
+ *  VertexFormat::Full is 14 floats (56 bytes) per vertex: position,
+ *  normal, texture coordinates, tangent and bitangent at full
+ *  precision. VertexFormat::Compact packs the same vertex into 16 bytes
+ *  (a CompactVertex):
+ *    - the position as three half floats, which the GPU turns back
+ *      into floats as it reads them,
+ *    - the normal and tangent octahedral encoded (see "A Survey of
+ *      Efficient Representations for Independent Unit Vectors",
+ *      Cigolle et al. 2014) into 16 bits each, with the bitangent
+ *      stored as one sign bit, since it is always +/- cross(normal,
+ *      tangent),
+ *    - the texture coordinates as 16 bit normalized integers.
+ *  Half floats hold about 3 decimal digits, which is plenty for meshes
+ *  around the size of our unit spheres, but not for a mesh hundreds of
+ *  units across. Texture coordinates must be between 0 and 1.
+ *
+ *  The compact format needs "./shaders/vert_compact.glsl", which
+ *  unpacks the normal and tangent. SceneNode picks it automatically.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef VERTEXFORMAT_HPP
+#define VERTEXFORMAT_HPP
+
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+enum class VertexFormat : unsigned int { Full, Compact };
+
+// One vertex of VertexFormat::Full, as it is stored on the GPU
+struct FullVertex {
+  glm::vec3 position;
+  glm::vec3 normal;
+  glm::vec2 texCoords;
+  glm::vec3 tangent;
+  glm::vec3 bitangent;
+};
+
+static_assert(sizeof(FullVertex) == 14 * sizeof(float),
+              "FullVertex should have no padding");
+
+// One vertex of VertexFormat::Compact, as it is stored on the GPU
+struct CompactVertex {
+  // x, y, z as half floats (the last one is padding)
+  uint16_t position[4];
+  // Bits 0-15: normal, 8 bits per octahedral coordinate
+  // Bits 16-30: tangent, 8 bits for x and 7 bits for y
+  // Bit 31: set if the bitangent is -cross(normal, tangent)
+  uint32_t tangentFrame;
+  // s, t as 16 bit normalized integers
+  uint16_t texCoords[2];
+};
+
+static_assert(sizeof(CompactVertex) == 16,
+              "CompactVertex should have no padding");
+
+// Packs and unpacks the parts of a CompactVertex. The Unpack functions
+// do on the CPU what the vertex shader does, so the error of the
+// compact format can be measured.
+class VertexPacking {
+public:
+  // Maps a unit vector onto the [-1, 1] square, and back
+  static glm::vec2 OctahedralEncode(const glm::vec3 &v);
+  static glm::vec3 OctahedralDecode(const glm::vec2 &e);
+  // Packs a normal, tangent and bitangent into CompactVertex's
+  // tangentFrame. The vectors do not need to be normalized.
+  static uint32_t PackTangentFrame(const glm::vec3 &normal,
+                                   const glm::vec3 &tangent,
+                                   const glm::vec3 &bitangent);
+  static void UnpackTangentFrame(uint32_t frame, glm::vec3 &normal,
+                                 glm::vec3 &tangent, glm::vec3 &bitangent);
+  // Builds a whole vertex (the texture coordinates are clamped to 0..1)
+  static CompactVertex Pack(const glm::vec3 &position, const glm::vec3 &normal,
+                            const glm::vec2 &texCoords,
+                            const glm::vec3 &tangent,
+                            const glm::vec3 &bitangent);
+  static glm::vec3 UnpackPosition(const CompactVertex &vertex);
+  static glm::vec2 UnpackTexCoords(const CompactVertex &vertex);
+};
+
+#endif
@@ -0,0 +1,237 @@
+/** @file VertexLayout.hpp
+ *  @brief Describes how the attributes of a vertex sit in a buffer.
+ *
+ *  A VertexLayout lists every attribute a vertex shader reads from one
+ *  buffer: its location, type, number of components, whether integers
+ *  are normalized, and how often it advances (every vertex, or every
+ *  n instances). Layouts are built at compile time from a vertex
+ *  struct, so the stride and offsets always match the struct:
+ *
+ *    constexpr VertexLayout layout = MakeVertexLayout<MyVertex>(
+ *        Attribute<glm::vec3>(0, offsetof(MyVertex, position)),
+ *        Attribute<glm::vec2>(2, offsetof(MyVertex, texCoords)));
+ *
+ *  The component count and type come from the member's C++ type (see
+ *  AttributeType). Members that are stored as one type but read as
+ *  another, like half floats kept in uint16_t's, give both explicitly.
+ *  The VertexArrayCache turns layouts into vertex array objects.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef VERTEXLAYOUT_HPP
+#define VERTEXLAYOUT_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "VertexFormat.hpp"
+#include "glm/glm.hpp"
+
+// One attribute a vertex shader reads
+struct VertexAttribute {
+  // layout(location=...) in the shader
+  GLuint location;
+  // 1 to 4
+  GLint components;
+  // i.e. GL_FLOAT, GL_HALF_FLOAT or GL_UNSIGNED_SHORT
+  GLenum type;
+  // Maps unsigned integers to 0..1 and signed ones to -1..1
+  GLboolean normalized;
+  // Passes integers to the shader as integers (ivec/uvec inputs)
+  // rather than converting them to floats
+  bool integer;
+  // Bytes from the start of the vertex
+  unsigned int offset;
+  // 0 to advance every vertex, n to advance every n instances
+  GLuint divisor;
+};
+
+// The component count and OpenGL type of the C++ types we store
+// attributes as
+template <typename T> struct AttributeType;
+template <> struct AttributeType<float> {
+  static constexpr GLint components = 1;
+  static constexpr GLenum type = GL_FLOAT;
+};
+template <> struct AttributeType<uint16_t> {
+  static constexpr GLint components = 1;
+  static constexpr GLenum type = GL_UNSIGNED_SHORT;
+};
+template <> struct AttributeType<uint32_t> {
+  static constexpr GLint components = 1;
+  static constexpr GLenum type = GL_UNSIGNED_INT;
+};
+template <glm::length_t L> struct AttributeType<glm::vec<L, float>> {
+  static constexpr GLint components = L;
+  static constexpr GLenum type = GL_FLOAT;
+};
+template <typename T, std::size_t N> struct AttributeType<T[N]> {
+  static constexpr GLint components = N;
+  static constexpr GLenum type = AttributeType<T>::type;
+};
+
+// An attribute read as floats, of a member whose type is T
+template <typename T>
+constexpr VertexAttribute Attribute(GLuint location, std::size_t offset,
+                                    bool normalized = false,
+                                    GLuint divisor = 0) {
+  return VertexAttribute{location,
+                         AttributeType<T>::components,
+                         AttributeType<T>::type,
+                         normalized ? GLboolean(GL_TRUE) : GLboolean(GL_FALSE),
+                         false,
+                         (unsigned int)offset,
+                         divisor};
+}
+
+// An attribute read as floats, whose components and type are given
+constexpr VertexAttribute Attribute(GLuint location, GLint components,
+                                    GLenum type, std::size_t offset,
+                                    bool normalized = false,
+                                    GLuint divisor = 0) {
+  return VertexAttribute{location,
+                         components,
+                         type,
+                         normalized ? GLboolean(GL_TRUE) : GLboolean(GL_FALSE),
+                         false,
+                         (unsigned int)offset,
+                         divisor};
+}
+
+// An attribute read as integers, of a member whose type is T
+template <typename T>
+constexpr VertexAttribute IntegerAttribute(GLuint location,
+                                           std::size_t offset,
+                                           GLuint divisor = 0) {
+  return VertexAttribute{location,
+                         AttributeType<T>::components,
+                         AttributeType<T>::type,
+                         GL_FALSE,
+                         true,
+                         (unsigned int)offset,
+                         divisor};
+}
+
+// Every attribute read from one buffer
+struct VertexLayout {
+  static constexpr unsigned int MAX_ATTRIBUTES = 8;
+  // Bytes from one vertex to the next
+  unsigned int stride;
+  unsigned int attributeCount;
+  VertexAttribute attributes[MAX_ATTRIBUTES];
+};
+
+// Builds the layout of a buffer of 'Vertex' structs
+template <typename Vertex, typename... Attributes>
+constexpr VertexLayout MakeVertexLayout(Attributes... attributes) {
+  static_assert(sizeof...(Attributes) <= VertexLayout::MAX_ATTRIBUTES,
+                "Too many attributes for a VertexLayout");
+  return VertexLayout{sizeof(Vertex), sizeof...(Attributes), {attributes...}};
+}
+
+constexpr bool operator==(const VertexAttribute &a, const VertexAttribute &b) {
+  return a.location == b.location && a.components == b.components &&
+         a.type == b.type && a.normalized == b.normalized &&
+         a.integer == b.integer && a.offset == b.offset &&
+         a.divisor == b.divisor;
+}
+
+constexpr bool operator==(const VertexLayout &a, const VertexLayout &b) {
+  if (a.stride != b.stride || a.attributeCount != b.attributeCount) {
+    return false;
+  }
+  for (unsigned int i = 0; i < a.attributeCount; ++i) {
+    if (!(a.attributes[i] == b.attributes[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Bytes in one component of 'type'
+constexpr unsigned int ComponentSize(GLenum type) {
+  return type == GL_BYTE || type == GL_UNSIGNED_BYTE    ? 1
+         : type == GL_SHORT || type == GL_UNSIGNED_SHORT ||
+                 type == GL_HALF_FLOAT
+             ? 2
+             : 4;
+}
+
+// True if every attribute lies within the stride. Use it in a
+// static_assert next to each layout.
+constexpr bool FitsInStride(const VertexLayout &layout) {
+  for (unsigned int i = 0; i < layout.attributeCount; ++i) {
+    const VertexAttribute &attribute = layout.attributes[i];
+    if (attribute.offset + attribute.components * ComponentSize(attribute.type) >
+        layout.stride) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// x,y,z
+struct PositionVertex {
+  glm::vec3 position;
+};
+
+// x,y,z, s,t
+struct TextureVertex {
+  glm::vec3 position;
+  glm::vec2 texCoords;
+};
+
+inline constexpr VertexLayout POSITION_VERTEX_LAYOUT =
+    MakeVertexLayout<PositionVertex>(
+        Attribute<glm::vec3>(0, offsetof(PositionVertex, position)));
+
+inline constexpr VertexLayout TEXTURE_VERTEX_LAYOUT =
+    MakeVertexLayout<TextureVertex>(
+        Attribute<glm::vec3>(0, offsetof(TextureVertex, position)),
+        Attribute<glm::vec2>(1, offsetof(TextureVertex, texCoords)));
+
+// The attributes of vert.glsl
+inline constexpr VertexLayout FULL_VERTEX_LAYOUT = MakeVertexLayout<FullVertex>(
+    Attribute<glm::vec3>(0, offsetof(FullVertex, position)),
+    Attribute<glm::vec3>(1, offsetof(FullVertex, normal)),
+    Attribute<glm::vec2>(2, offsetof(FullVertex, texCoords)),
+    Attribute<glm::vec3>(3, offsetof(FullVertex, tangent)),
+    Attribute<glm::vec3>(4, offsetof(FullVertex, bitangent)));
+
+// The attributes of vert_compact.glsl. The position is stored in
+// uint16_t's but read as half floats, and the texture coordinates are
+// normalized so 0..65535 is read as 0..1.
+inline constexpr VertexLayout COMPACT_VERTEX_LAYOUT =
+    MakeVertexLayout<CompactVertex>(
+        Attribute(0, 3, GL_HALF_FLOAT, offsetof(CompactVertex, position)),
+        Attribute<uint16_t[2]>(2, offsetof(CompactVertex, texCoords), true),
+        IntegerAttribute<uint32_t>(5, offsetof(CompactVertex, tangentFrame)));
+
+// One instance of an indirect draw: which object it is, and thus
+// which model matrix the vertex shader reads
+struct InstanceData {
+  uint32_t objectIndex;
+};
+
+// Read once per instance (divisor 1). Attributes with a divisor are
+// offset by each draw's base instance, which gl_InstanceID is not.
+inline constexpr VertexLayout INSTANCE_LAYOUT = MakeVertexLayout<InstanceData>(
+    IntegerAttribute<uint32_t>(6, offsetof(InstanceData, objectIndex), 1));
+
+static_assert(FitsInStride(POSITION_VERTEX_LAYOUT) &&
+                  FitsInStride(TEXTURE_VERTEX_LAYOUT) &&
+                  FitsInStride(FULL_VERTEX_LAYOUT) &&
+                  FitsInStride(COMPACT_VERTEX_LAYOUT) &&
+                  FitsInStride(INSTANCE_LAYOUT),
+              "An attribute lies outside its vertex");
+
+// The layout Geometry::Gen produces for 'format'
+constexpr const VertexLayout &GetVertexLayout(VertexFormat format) {
+  return format == VertexFormat::Compact ? COMPACT_VERTEX_LAYOUT
+                                         : FULL_VERTEX_LAYOUT;
+}
+
+#endif
@@ -2,12 +2,15 @@
 #version 330 core
 
 // ======================= uniform ====================
-// Our light sources
-uniform vec3 lightColor;
-uniform vec3 lightPos;
-uniform float ambientIntensity;
-// Used for our specular highlights
-uniform mat4 view;
+// Our light sources (and the view matrix used for our
+// specular highlights) are shared by every object in a frame.
+layout(std140) uniform FrameData{
+    mat4 view;
+    mat4 projection;
+    vec3 lightColor;
+    float ambientIntensity;
+    vec3 lightPos;
+};
 // If we have texture coordinates, they are stored in this sampler.
 uniform sampler2D u_DiffuseMap; 
 
@@ -9,11 +9,27 @@ layout(location=2)in vec2 texCoord; // Our third attribute - texture coordinates
 layout(location=3)in vec3 tangents; // Our third attribute - texture coordinates.
 layout(location=4)in vec3 bitangents; // Our third attribute - texture coordinates.
 
-// If we are applying our camera, then we need to add some uniforms.
+// Data shared by every object in a frame, filled once per frame
+// from a uniform buffer (see FrameUniforms.hpp).
 // Note that the syntax nicely matches glm's mat4!
-uniform mat4 model; // Object space
-uniform mat4 view; // Object space
-uniform mat4 projection; // Object space
+layout(std140) uniform FrameData{
+    mat4 view;
+    mat4 projection;
+    vec3 lightColor;
+    float ambientIntensity;
+    vec3 lightPos;
+};
+
+// The model matrix of every object, stored one column per texel.
+uniform samplerBuffer u_ModelMatrices;
+// Which model matrix in u_ModelMatrices belongs to each instance.
+// A draw call's instances are stored together, starting at u_InstanceBase.
+uniform usamplerBuffer u_InstanceIndices;
+uniform int u_InstanceBase;
+// Indirect draws make many draws at once, each with its own first
+// instance, so they set u_InstanceBase to -1 and read the same index
+// from the instance buffer as a per-instance attribute instead.
+layout(location=6)in uint instanceObjectIndex;
 
 // Export our normal data, and read it into our frag shader
 out vec3 myNormal;
@@ -25,11 +41,20 @@ out vec2 v_texCoord;
 
 void main()
 {
+    // Fetch our model matrix (Object space)
+    int objectIndex = u_InstanceBase < 0 ? int(instanceObjectIndex) :
+        int(texelFetch(u_InstanceIndices, u_InstanceBase + gl_InstanceID).r);
+    int base = objectIndex * 4;
+    mat4 model = mat4(texelFetch(u_ModelMatrices, base),
+                      texelFetch(u_ModelMatrices, base + 1),
+                      texelFetch(u_ModelMatrices, base + 2),
+                      texelFetch(u_ModelMatrices, base + 3));
 
     gl_Position = projection * view * model * vec4(position, 1.0f);
 
-    myNormal = normals;
-    // Transform normal into world space
+    // Transform normal into world space (our objects are only
+    // scaled evenly, so the model matrix keeps it perpendicular)
+    myNormal = mat3(model) * normals;
     FragPos = vec3(model* vec4(position,1.0f));
 
     // Store the texture coordinaets which we will output to
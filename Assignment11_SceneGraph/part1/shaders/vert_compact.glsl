@@ -0,0 +1,97 @@
+// ==================================================================
+#version 330 core
+// The same as vert.glsl, for meshes in the compact vertex format
+// (see VertexFormat.hpp). The position and texture coordinates are
+// turned back into floats by the GPU as they are read, but the
+// normal and tangent are packed into one integer we unpack here.
+layout(location=0)in vec3 position; // Read from half floats
+layout(location=2)in vec2 texCoord; // Read from 16 bit normalized integers
+layout(location=5)in uint tangentFrame; // Normal, tangent and bitangent sign
+
+// Data shared by every object in a frame, filled once per frame
+// from a uniform buffer (see FrameUniforms.hpp).
+layout(std140) uniform FrameData{
+    mat4 view;
+    mat4 projection;
+    vec3 lightColor;
+    float ambientIntensity;
+    vec3 lightPos;
+};
+
+// The model matrix of every object, stored one column per texel.
+uniform samplerBuffer u_ModelMatrices;
+// Which model matrix in u_ModelMatrices belongs to each instance.
+// A draw call's instances are stored together, starting at u_InstanceBase.
+uniform usamplerBuffer u_InstanceIndices;
+uniform int u_InstanceBase;
+// Indirect draws make many draws at once, each with its own first
+// instance, so they set u_InstanceBase to -1 and read the same index
+// from the instance buffer as a per-instance attribute instead.
+layout(location=6)in uint instanceObjectIndex;
+
+// Export our normal data, and read it into our frag shader
+out vec3 myNormal;
+// Export our Fragment Position computed in world space
+out vec3 FragPos;
+// If we have texture coordinates we can now use this as well
+out vec2 v_texCoord;
+
+// Reads the signed 'bits' wide field starting at bit 'shift'
+// of 'bitfield', mapped to -1..1
+float UnpackSnorm(uint bitfield, uint shift, uint bits){
+    // Move the field to the top, then shift it back down keeping the sign
+    int quantized = int(bitfield << (32u - shift - bits)) >> (32u - bits);
+    float scale = float((1 << (bits - 1u)) - 1);
+    return max(float(quantized) / scale, -1.0);
+}
+
+// Turns a point on the [-1,1] square back into a unit vector
+vec3 OctahedralDecode(vec2 e){
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    // Fold the corners back under the octahedron
+    float t = max(-v.z, 0.0);
+    v.x += v.x >= 0.0 ? -t : t;
+    v.y += v.y >= 0.0 ? -t : t;
+    return normalize(v);
+}
+
+// Unpacks the whole tangent frame. The tangent and bitangent are not
+// used for lighting yet, so main only decodes the normal; normal
+// mapping will need this instead.
+void DecodeTangentFrame(uint frame, out vec3 normal, out vec3 tangent,
+                        out vec3 bitangent){
+    normal = OctahedralDecode(vec2(UnpackSnorm(frame, 0u, 8u),
+                                   UnpackSnorm(frame, 8u, 8u)));
+    tangent = OctahedralDecode(vec2(UnpackSnorm(frame, 16u, 8u),
+                                    UnpackSnorm(frame, 24u, 7u)));
+    // The top bit is the sign of the bitangent
+    bitangent = ((frame & 0x80000000u) != 0u ? -1.0 : 1.0) *
+                cross(normal, tangent);
+}
+
+void main()
+{
+    // Fetch our model matrix (Object space)
+    int objectIndex = u_InstanceBase < 0 ? int(instanceObjectIndex) :
+        int(texelFetch(u_InstanceIndices, u_InstanceBase + gl_InstanceID).r);
+    int base = objectIndex * 4;
+    mat4 model = mat4(texelFetch(u_ModelMatrices, base),
+                      texelFetch(u_ModelMatrices, base + 1),
+                      texelFetch(u_ModelMatrices, base + 2),
+                      texelFetch(u_ModelMatrices, base + 3));
+
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+
+    // Unpack our normal
+    vec3 normals = OctahedralDecode(vec2(UnpackSnorm(tangentFrame, 0u, 8u),
+                                         UnpackSnorm(tangentFrame, 8u, 8u)));
+    // Transform normal into world space (our objects are only
+    // scaled evenly, so the model matrix keeps it perpendicular)
+    myNormal = mat3(model) * normals;
+    FragPos = vec3(model* vec4(position,1.0f));
+
+    // Store the texture coordinaets which we will output to
+    // the next stage in the graphics pipeline.
+    v_texCoord = texCoord;
+}
+// ==================================================================
@@ -0,0 +1,101 @@
+#include "FreeListAllocator.hpp"
+
+#include <cassert>
+#include <iterator>
+
+FreeListAllocator::FreeListAllocator(unsigned int capacity) {
+  Reset(capacity);
+}
+
+// Destructor is empty
+FreeListAllocator::~FreeListAllocator() {}
+
+unsigned int FreeListAllocator::Allocate(unsigned int size) {
+  if (size == 0) {
+    return 0;
+  }
+  // The smallest free range that is big enough
+  auto fit = m_bySize.lower_bound(size);
+  if (fit == m_bySize.end()) {
+    return INVALID_OFFSET;
+  }
+  unsigned int offset = fit->second;
+  unsigned int rangeSize = fit->first;
+  Erase(m_byOffset.find(offset));
+  // Whatever is left over stays free
+  if (rangeSize > size) {
+    m_byOffset.emplace(offset + size, rangeSize - size);
+    m_bySize.emplace(rangeSize - size, offset + size);
+  }
+  m_used += size;
+  return offset;
+}
+
+void FreeListAllocator::Free(unsigned int offset, unsigned int size) {
+  if (size == 0) {
+    return;
+  }
+  assert(offset + size <= m_capacity && size <= m_used);
+  m_used -= size;
+  Insert(offset, size);
+}
+
+void FreeListAllocator::Grow(unsigned int newCapacity) {
+  if (newCapacity <= m_capacity) {
+    return;
+  }
+  unsigned int oldCapacity = m_capacity;
+  m_capacity = newCapacity;
+  Insert(oldCapacity, newCapacity - oldCapacity);
+}
+
+void FreeListAllocator::Reset(unsigned int capacity) {
+  m_byOffset.clear();
+  m_bySize.clear();
+  m_capacity = capacity;
+  m_used = 0;
+  if (capacity > 0) {
+    m_byOffset.emplace(0, capacity);
+    m_bySize.emplace(capacity, 0);
+  }
+}
+
+unsigned int FreeListAllocator::GetLargestFreeRange() const {
+  return m_bySize.empty() ? 0 : m_bySize.rbegin()->first;
+}
+
+void FreeListAllocator::Insert(unsigned int offset, unsigned int size) {
+  // Merge with the range that ends where we start
+  auto next = m_byOffset.lower_bound(offset);
+  if (next != m_byOffset.begin()) {
+    auto previous = std::prev(next);
+    assert(previous->first + previous->second <= offset);
+    if (previous->first + previous->second == offset) {
+      offset = previous->first;
+      size += previous->second;
+      Erase(previous);
+    }
+  }
+  // And with the range that starts where we end
+  if (next != m_byOffset.end()) {
+    assert(offset + size <= next->first);
+    if (offset + size == next->first) {
+      size += next->second;
+      Erase(next);
+    }
+  }
+  m_byOffset.emplace(offset, size);
+  m_bySize.emplace(size, offset);
+}
+
+void FreeListAllocator::Erase(std::map<unsigned int, unsigned int>::iterator it) {
+  // Several ranges may have the same size, find ours
+  auto range = m_bySize.equal_range(it->second);
+  for (auto s = range.first; s != range.second; ++s) {
+    if (s->second == it->first) {
+      m_bySize.erase(s);
+      break;
+    }
+  }
+  m_byOffset.erase(it);
+}
@@ -0,0 +1,45 @@
+#include "Frustum.hpp"
+
+#include "glm/geometric.hpp"
+
+// Constructor
+Frustum::Frustum() {}
+
+// Extracts the planes using the method from Gribb and Hartmann,
+// "Fast Extraction of Viewing Frustum Planes from the World-View-
+// Projection Matrix". A point is inside the frustum when its clip
+// space position satisfies -w <= x,y,z <= w, and each of those six
+// comparisons is a plane made from the rows of the matrix.
+void Frustum::ExtractPlanes(const glm::mat4 &viewProjection) {
+  // glm matrices are stored by column, so gather the rows first
+  glm::vec4 rows[4];
+  for (int i = 0; i < 4; ++i) {
+    rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i],
+                        viewProjection[2][i], viewProjection[3][i]);
+  }
+  m_planes[0] = rows[3] + rows[0]; // Left
+  m_planes[1] = rows[3] - rows[0]; // Right
+  m_planes[2] = rows[3] + rows[1]; // Bottom
+  m_planes[3] = rows[3] - rows[1]; // Top
+  m_planes[4] = rows[3] + rows[2]; // Near
+  m_planes[5] = rows[3] - rows[2]; // Far
+  // Normalize, so that distances to the planes are in world units
+  for (int i = 0; i < 6; ++i) {
+    m_planes[i] /= glm::length(glm::vec3(m_planes[i]));
+  }
+}
+
+bool Frustum::IsVisible(const BoundingSphere &sphere) const {
+  if (sphere.IsEmpty()) {
+    return false;
+  }
+  for (int i = 0; i < 6; ++i) {
+    float distance =
+        glm::dot(glm::vec3(m_planes[i]), sphere.center) + m_planes[i].w;
+    // Entirely behind this plane
+    if (distance < -sphere.radius) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -1,10 +1,21 @@
 #include "Geometry.hpp"
 #include <assert.h>
 #include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <tuple>
 #include "glm/vec3.hpp"
 #include "glm/vec2.hpp"
 #include "glm/glm.hpp"
 
+// Vertices at the same position only share their normals if the
+// normals are less than 60 degrees apart
+static const float CREASE_COSINE = 0.5f;
+// A triangle whose area is at most this times its longest edge squared
+// adds nothing to its corners
+static const float DEGENERATE_AREA = 1e-6f;
+
 // Constructor
 Geometry::Geometry(){
 
@@ -16,34 +27,34 @@ Geometry::~Geometry(){
 }
 
 
+// Reserves room for 'vertexCount' vertices and 'indexCount' indices,
+// so adding them does not need to move our data as it grows.
+void Geometry::Reserve(unsigned int vertexCount, unsigned int indexCount){
+	m_bufferData.reserve((std::size_t)vertexCount*FLOATS_PER_VERTEX);
+	m_indices.reserve(indexCount);
+}
+
 // Adds a vertex and associated texture coordinate.
-// Will also add a and a normal
+// The normal, tangent and bi-tangent are placeholders until
+// ComputeTangentFrames is called.
 void Geometry::AddVertex(float x, float y, float z, float s, float t){
-	m_vertexPositions.push_back(x);
-	m_vertexPositions.push_back(y);
-	m_vertexPositions.push_back(z);
-    // Add texture coordinates
-	m_textureCoords.push_back(s);
-	m_textureCoords.push_back(t);
-	// Push back placeholders for m_normals
-	m_normals.push_back(0.0f);
-	m_normals.push_back(0.0f);
-	m_normals.push_back(1.0f);
-	// Push back placeholders for tangents
-	m_tangents.push_back(0.0f);
-	m_tangents.push_back(0.0f);
-	m_tangents.push_back(1.0f);
-	// push back placeholders for bi-tangents
-	m_biTangents.push_back(0.0f);
-	m_biTangents.push_back(0.0f);
-	m_biTangents.push_back(1.0f);
+	// Written straight into its place in our interleaved data,
+	// in the order the attributes are in the vertex buffer.
+	const float vertex[FLOATS_PER_VERTEX] = {
+		x, y, z,		// position
+		0.0f, 0.0f, 1.0f,	// normal
+		s, t,			// texture coordinates
+		0.0f, 0.0f, 1.0f,	// tangent
+		0.0f, 0.0f, 1.0f	// bi-tangent
+	};
+	m_bufferData.insert(m_bufferData.end(), vertex, vertex + FLOATS_PER_VERTEX);
 }
 
 // Allows for adding one index at a time manually if 
 // you know which vertices are needed to make a triangle.
 void Geometry::AddIndex(unsigned int i){
     // Simple bounds check to make sure a valid index is added.
-    if(i >= 0 && i <= m_vertexPositions.size()/3){
+    if(i < GetVertexCount()){
         m_indices.push_back(i);
     }else{
         std::cout << "(Geometry.cpp) ERROR, invalid index\n";
@@ -65,105 +76,279 @@ unsigned int Geometry::GetBufferSizeInBytes(){
 	return m_bufferData.size()*sizeof(float);
 }
 
+// Retrieves how many vertices we have
+unsigned int Geometry::GetVertexCount() const{
+	if(m_format == VertexFormat::Compact){
+		return m_bufferData.size()/(sizeof(CompactVertex)/sizeof(float));
+	}
+	return m_bufferData.size()/FLOATS_PER_VERTEX;
+}
+
+// Frees our vertices and indices. The bounding sphere and format are kept.
+void Geometry::Release(){
+	// swap, unlike clear, gives the memory back
+	std::vector<float>().swap(m_bufferData);
+	std::vector<unsigned int>().swap(m_indices);
+}
+
 // Create all data
-// The idea here is that we are pshing all of our data from
-// each individual vertex into a single vector.
-// This makes it relatively easy to then fill in a buffer
-// with the corresponding vertices
-void Geometry::Gen(){
-	assert((m_vertexPositions.size()/3) == (m_textureCoords.size()/2));
-
-	int coordsPos =0;
-	for(int i =0; i < m_vertexPositions.size()/3; ++i){
-	// First vertex
-		// vertices
-		m_bufferData.push_back(m_vertexPositions[i*3+ 0]);
-		m_bufferData.push_back(m_vertexPositions[i*3+ 1]);
-		m_bufferData.push_back(m_vertexPositions[i*3+ 2]);
-		// m_normals
-		m_bufferData.push_back(m_normals[i*3+0]);
-		m_bufferData.push_back(m_normals[i*3+1]);
-		m_bufferData.push_back(m_normals[i*3+2]);
-    	// texture information
-		m_bufferData.push_back(m_textureCoords[coordsPos*2+0]); 
-		m_bufferData.push_back(m_textureCoords[coordsPos*2+1]); 
-		++coordsPos; // Note separate counter for coords Pos.
-					 // Because we only have two dimensions and want
-					 // to make sure the corresponde to proper three
-					 // dimensional vertex attributes.
-		// tangents
-		m_bufferData.push_back(m_tangents[i*3+0]);
-		m_bufferData.push_back(m_tangents[i*3+1]);
-		m_bufferData.push_back(m_tangents[i*3+2]);
-		// bi-tangents
-		m_bufferData.push_back(m_biTangents[i*3+0]);
-		m_bufferData.push_back(m_biTangents[i*3+1]);
-		m_bufferData.push_back(m_biTangents[i*3+2]);
+// Our vertices are already interleaved in m_bufferData, the way the
+// full format needs them. For the compact format every vertex is
+// packed in place, from the front, since a packed vertex is smaller
+// and so never overwrites a vertex that is still to be read.
+void Geometry::Gen(VertexFormat format){
+	assert(m_format == VertexFormat::Full && "Gen cannot unpack a compact mesh again");
+	const unsigned int vertexCount = GetVertexCount();
+
+	// Find a sphere around our vertices, centered on the
+	// middle of the box that encloses them.
+	if(vertexCount > 0){
+		glm::vec3 minimum = GetPosition(0);
+		glm::vec3 maximum = minimum;
+		for(unsigned int i =0; i < vertexCount; ++i){
+			glm::vec3 p = GetPosition(i);
+			minimum = glm::min(minimum,p);
+			maximum = glm::max(maximum,p);
+		}
+		m_boundingSphere.center = (minimum + maximum) * 0.5f;
+		float radiusSquared = 0.0f;
+		for(unsigned int i =0; i < vertexCount; ++i){
+			glm::vec3 offset = GetPosition(i) - m_boundingSphere.center;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset,offset));
+		}
+		m_boundingSphere.radius = std::sqrt(radiusSquared);
 	}
+
+	if(format == VertexFormat::Compact){
+		// Each vertex is packed into 16 bytes, which we store in
+		// m_bufferData as the bytes of 4 floats.
+		static_assert(sizeof(CompactVertex)%sizeof(float)==0,
+			"CompactVertex must fill a whole number of floats");
+		static_assert(sizeof(CompactVertex) <= FLOATS_PER_VERTEX*sizeof(float),
+			"Packing in place needs CompactVertex to be smaller");
+		bool clamped = false;
+		for(unsigned int i =0; i < vertexCount; ++i){
+			const float* v = &m_bufferData[(std::size_t)i*FLOATS_PER_VERTEX];
+			glm::vec2 texCoords(v[TEXCOORD_OFFSET+0],v[TEXCOORD_OFFSET+1]);
+			if(glm::any(glm::lessThan(texCoords,glm::vec2(0.0f))) ||
+			   glm::any(glm::greaterThan(texCoords,glm::vec2(1.0f)))){
+				clamped = true;
+			}
+			CompactVertex vertex = VertexPacking::Pack(
+				glm::vec3(v[POSITION_OFFSET+0],v[POSITION_OFFSET+1],v[POSITION_OFFSET+2]),
+				glm::vec3(v[NORMAL_OFFSET+0],v[NORMAL_OFFSET+1],v[NORMAL_OFFSET+2]),
+				texCoords,
+				glm::vec3(v[TANGENT_OFFSET+0],v[TANGENT_OFFSET+1],v[TANGENT_OFFSET+2]),
+				glm::vec3(v[BITANGENT_OFFSET+0],v[BITANGENT_OFFSET+1],v[BITANGENT_OFFSET+2]));
+			std::memcpy(&m_bufferData[(std::size_t)i*sizeof(CompactVertex)/sizeof(float)],&vertex,sizeof(CompactVertex));
+		}
+		m_bufferData.resize((std::size_t)vertexCount*sizeof(CompactVertex)/sizeof(float));
+		if(clamped){
+			std::cout << "(Geometry.cpp) WARNING, texture coordinates outside 0..1 "
+			             "were clamped for the compact vertex format\n";
+		}
+	}
+	m_format = format;
 }
 
-// The big trick here, is that when we make a triangle
-// We also need to update our m_normals, tangents, and bi-tangents.
+// Adds the three indices of a triangle. The normals, tangents and
+// bi-tangents are computed for all triangles at once afterwards
+// (see ComputeTangentFrames), since a vertex shared by several
+// triangles needs all of them.
 void Geometry::MakeTriangle(unsigned int vert0, unsigned int vert1, unsigned int vert2){
 	m_indices.push_back(vert0);	
 	m_indices.push_back(vert1);	
 	m_indices.push_back(vert2);	
+}
+
+// Each triangle adds its normal, tangent and bi-tangent to its three
+// vertices, weighted by the triangle's area and by the angle of the
+// triangle at that vertex. Weighting by area makes big triangles count
+// more than slivers, and weighting by angle means that splitting a
+// triangle in two does not change the result.
+// The sums are stored one array per component, so the second pass,
+// which normalizes every vertex, runs over contiguous floats.
+void Geometry::ComputeTangentFrames(){
+	assert(m_format == VertexFormat::Full && "Call ComputeTangentFrames before Gen");
+	const std::size_t vertexCount = GetVertexCount();
+	std::vector<float> nx(vertexCount,0.0f), ny(vertexCount,0.0f), nz(vertexCount,0.0f);
+	std::vector<float> tx(vertexCount,0.0f), ty(vertexCount,0.0f), tz(vertexCount,0.0f);
+	std::vector<float> bx(vertexCount,0.0f), by(vertexCount,0.0f), bz(vertexCount,0.0f);
+	std::vector<unsigned char> used(vertexCount,0);
+
+	// (1) Add every triangle to its corners
+	for(std::size_t i =0; i+2 < m_indices.size(); i+=3){
+		unsigned int corners[3] = {m_indices[i], m_indices[i+1], m_indices[i+2]};
+		glm::vec3 pos[3];
+		glm::vec2 tex[3];
+		for(int k=0; k < 3; ++k){
+			const float* v = &m_bufferData[(std::size_t)corners[k]*FLOATS_PER_VERTEX];
+			pos[k] = glm::vec3(v[POSITION_OFFSET+0], v[POSITION_OFFSET+1], v[POSITION_OFFSET+2]);
+			tex[k] = glm::vec2(v[TEXCOORD_OFFSET+0], v[TEXCOORD_OFFSET+1]);
+			// Even the corners of a degenerate triangle are shared with
+			// the vertices at the same position in (2)
+			used[corners[k]] = 1;
+		}
+		glm::vec3 edge0 = pos[1] - pos[0];
+		glm::vec3 edge1 = pos[2] - pos[0];
+		// The length of the cross product is twice the area of the
+		// triangle, so leaving it unnormalized weights by area.
+		glm::vec3 normal = glm::cross(edge0,edge1);
+		float area = glm::length(normal);
+		float longestEdge = std::max({glm::dot(edge0,edge0), glm::dot(edge1,edge1),
+		                              glm::dot(pos[2]-pos[1],pos[2]-pos[1])});
+		if(area <= DEGENERATE_AREA * longestEdge){
+			// Degenerate, i.e. at the pole of a sphere, where rounding
+			// leaves the corners a hair apart and the normal is noise
+			continue;
+		}
+
+		// The directions in which the texture coordinates s and t grow
+		// This section is inspired by: https://learnopengl.com/Advanced-Lighting/Normal-Mapping
+		glm::vec2 deltaUV0 = tex[1]-tex[0];
+		glm::vec2 deltaUV1 = tex[2]-tex[0];
+		float determinant = deltaUV0.x * deltaUV1.y - deltaUV1.x * deltaUV0.y;
+		glm::vec3 tangent(0.0f);
+		glm::vec3 bitangent(0.0f);
+		if(determinant != 0.0f){
+			float f = 1.0f / determinant;
+			tangent = f * (deltaUV1.y * edge0 - deltaUV0.y * edge1);
+			bitangent = f * (-deltaUV1.x * edge0 + deltaUV0.x * edge1);
+			// Same weight as the normal
+			tangent = glm::normalize(tangent) * area;
+			bitangent = glm::normalize(bitangent) * area;
+		}
+
+		for(int k=0; k < 3; ++k){
+			glm::vec3 a = pos[(k+1)%3] - pos[k];
+			glm::vec3 b = pos[(k+2)%3] - pos[k];
+			float lengths = glm::length(a) * glm::length(b);
+			if(lengths == 0.0f){
+				continue;
+			}
+			float angle = std::acos(glm::clamp(glm::dot(a,b) / lengths, -1.0f, 1.0f));
+			unsigned int v = corners[k];
+			nx[v] += normal.x * angle;    ny[v] += normal.y * angle;    nz[v] += normal.z * angle;
+			tx[v] += tangent.x * angle;   ty[v] += tangent.y * angle;   tz[v] += tangent.z * angle;
+			bx[v] += bitangent.x * angle; by[v] += bitangent.y * angle; bz[v] += bitangent.z * angle;
+		}
+	}
 
-	// Look up the actual vertex positions
-	glm::vec3 pos0(m_vertexPositions[vert0*3 +0], m_vertexPositions[vert0*3 + 1], m_vertexPositions[vert0*3 + 2]); 
-	glm::vec3 pos1(m_vertexPositions[vert1*3 +0], m_vertexPositions[vert1*3 + 1], m_vertexPositions[vert1*3 + 2]); 
-	glm::vec3 pos2(m_vertexPositions[vert2*3 +0], m_vertexPositions[vert2*3 + 1], m_vertexPositions[vert2*3 + 2]); 
-
-	// Look up the texture coordinates
-	glm::vec2 tex0(m_textureCoords[vert0*2 +0], m_textureCoords[vert0*2 + 1]); 
-	glm::vec2 tex1(m_textureCoords[vert1*2 +0], m_textureCoords[vert1*2 + 1]); 
-	glm::vec2 tex2(m_textureCoords[vert2*2 +0], m_textureCoords[vert2*2 + 1]); 
-
-	// Now create an edge
-	// With two edges
-	// This section is inspired by: https://learnopengl.com/Advanced-Lighting/Normal-Mapping
-	glm::vec3 edge0 = pos1 - pos0;
-	glm::vec3 edge1 = pos2 - pos0;
-	// Question to ask yourself is what is going on here?
-    // The difference of y's and x's? Hmm.
-	glm::vec2 deltaUV0 = tex1-tex0;
-	glm::vec2 deltaUV1 = tex2-tex0;
-
-	float f = 1.0f / (deltaUV0.x * deltaUV1.y - deltaUV1.x * deltaUV0.y);
-
-	glm::vec3 tangent;
-	glm::vec3 bitangent;
-
-	tangent.x = f * (deltaUV1.y * edge0.x - deltaUV0.y* edge1.x);
-	tangent.y = f * (deltaUV1.y * edge0.y - deltaUV0.y* edge1.y);
-	tangent.z = f * (deltaUV1.y * edge0.z - deltaUV0.y* edge1.z);
-	tangent = glm::normalize(tangent);
-
-	bitangent.x = f * (-deltaUV1.x * edge0.x + deltaUV0.x* edge1.x);
-	bitangent.y = f * (-deltaUV1.x * edge0.y + deltaUV0.x* edge1.y);
-	bitangent.z = f * (-deltaUV1.x * edge0.z + deltaUV0.x* edge1.z);
-	bitangent = glm::normalize(bitangent);
-	
-	// Compute a normal
-	// For now we sort of 'cheat' since this is a quad the 'z' axis points straight out
-    glm::vec3 normal1{m_normals[vert0*3+0] ,m_normals[vert0*3+1], m_normals[vert0*3+2]};
-    glm::vec3 normal2{m_normals[vert1*3+0] ,m_normals[vert1*3+1], m_normals[vert1*3+2]};
-    glm::vec3 normal3{m_normals[vert2*3+0] ,m_normals[vert2*3+1], m_normals[vert2*3+2]};
-
-
-	m_normals[vert0*3+0] = 0.0f;	m_normals[vert0*3+1] = 0.0f;	m_normals[vert0*3+2] = 1.0f;	
-	m_normals[vert1*3+0] = 0.0f;	m_normals[vert1*3+1] = 0.0f;	m_normals[vert1*3+2] = 1.0f;	
-	m_normals[vert2*3+0] = 0.0f;	m_normals[vert2*3+1] = 0.0f;	m_normals[vert2*3+2] = 1.0f;	
-		
-	// Compute a tangent
-	m_tangents[vert0*3+0] = tangent.x; m_tangents[vert0*3+1] = tangent.y; m_tangents[vert0*3+2] = tangent.z;	
-	m_tangents[vert1*3+0] = tangent.x; m_tangents[vert1*3+1] = tangent.y; m_tangents[vert1*3+2] = tangent.z;	
-	m_tangents[vert2*3+0] = tangent.x; m_tangents[vert2*3+1] = tangent.y; m_tangents[vert2*3+2] = tangent.z;	
-
-	// Compute a bi-tangent
-	m_biTangents[vert0*3+0] = bitangent.x; m_biTangents[vert0*3+1] = bitangent.y; m_biTangents[vert0*3+2] = bitangent.z;	
-	m_biTangents[vert1*3+0] = bitangent.x; m_biTangents[vert1*3+1] = bitangent.y; m_biTangents[vert1*3+2] = bitangent.z;	
-	m_biTangents[vert2*3+0] = bitangent.x; m_biTangents[vert2*3+1] = bitangent.y; m_biTangents[vert2*3+2] = bitangent.z;	
+	// (2) Vertices at the same position, such as along the seam of a
+	// sphere where the texture coordinates wrap around, are separate
+	// vertices that each only see the triangles on their side. They
+	// share their sums, unless there is a crease between them (i.e.
+	// the corners of a box), so that the seam does not show.
+	// Positions are compared on a fine grid, since i.e. sin(2*PI) is
+	// not quite 0 in floats.
+	float extent = 0.0f;
+	for(std::size_t v =0; v < vertexCount; ++v){
+		glm::vec3 p = glm::abs(GetPosition(v));
+		extent = std::max({extent, p.x, p.y, p.z});
+	}
+	const float cellSize = std::max(extent * 1e-5f, 1e-30f);
+	// Every used vertex with its grid cell, sorted so vertices in the
+	// same cell are next to each other
+	std::vector<std::pair<std::tuple<long long,long long,long long>,unsigned int>> cells;
+	cells.reserve(vertexCount);
+	for(unsigned int v =0; v < vertexCount; ++v){
+		if(used[v]){
+			glm::vec3 p = GetPosition(v) / cellSize;
+			cells.push_back({std::make_tuple(std::llround(p.x), std::llround(p.y), std::llround(p.z)), v});
+		}
+	}
+	std::sort(cells.begin(), cells.end());
+	for(std::size_t first =0; first < cells.size();){
+		std::size_t last = first+1;
+		while(last < cells.size() && cells[last].first == cells[first].first){
+			++last;
+		}
+		if(last - first > 1){
+			// Work from copies, so the order we add in does not matter
+			std::vector<glm::vec3> normals, tangents, bitangents;
+			for(std::size_t i = first; i < last; ++i){
+				unsigned int v = cells[i].second;
+				normals.push_back(glm::vec3(nx[v],ny[v],nz[v]));
+				tangents.push_back(glm::vec3(tx[v],ty[v],tz[v]));
+				bitangents.push_back(glm::vec3(bx[v],by[v],bz[v]));
+			}
+			for(std::size_t i =0; i < normals.size(); ++i){
+				glm::vec3 normal = normals[i], tangent = tangents[i], bitangent = bitangents[i];
+				// A vertex only in degenerate triangles (the pole of a
+				// sphere) takes the others' normal. Their tangents point
+				// every way around the pole, so it gets its own in (3).
+				bool ownTriangles = glm::dot(normals[i],normals[i]) > 0.0f;
+				for(std::size_t j =0; j < normals.size(); ++j){
+					if(j == i || glm::dot(normals[i],normals[j]) < CREASE_COSINE * glm::length(normals[i]) * glm::length(normals[j])){
+						continue;
+					}
+					normal += normals[j];
+					// The texture may be mirrored or rotated on the other side
+					if(ownTriangles &&
+					   glm::dot(tangents[i],tangents[j]) >= CREASE_COSINE * glm::length(tangents[i]) * glm::length(tangents[j]) &&
+					   glm::dot(bitangents[i],bitangents[j]) >= CREASE_COSINE * glm::length(bitangents[i]) * glm::length(bitangents[j])){
+						tangent += tangents[j];
+						bitangent += bitangents[j];
+					}
+				}
+				unsigned int v = cells[first+i].second;
+				nx[v] = normal.x;    ny[v] = normal.y;    nz[v] = normal.z;
+				tx[v] = tangent.x;   ty[v] = tangent.y;   tz[v] = tangent.z;
+				bx[v] = bitangent.x; by[v] = bitangent.y; bz[v] = bitangent.z;
+			}
+		}
+		first = last;
+	}
+
+	// (3) Normalize the normals, then make the tangents perpendicular
+	// to them (Gram-Schmidt). The bi-tangent is rebuilt from the two,
+	// keeping the side the texture's t grows towards. Written without
+	// branches so the compiler can vectorize it.
+	for(std::size_t v =0; v < vertexCount; ++v){
+		float length = std::sqrt(nx[v]*nx[v] + ny[v]*ny[v] + nz[v]*nz[v]);
+		float inverse = length > 0.0f ? 1.0f / length : 0.0f;
+		// Vertices with no normal point out of the screen, as before
+		float n0 = nx[v] * inverse;
+		float n1 = ny[v] * inverse;
+		float n2 = length > 0.0f ? nz[v] * inverse : 1.0f;
+
+		float d = n0*tx[v] + n1*ty[v] + n2*tz[v];
+		float t0 = tx[v] - n0*d;
+		float t1 = ty[v] - n1*d;
+		float t2 = tz[v] - n2*d;
+		float tLength = std::sqrt(t0*t0 + t1*t1 + t2*t2);
+		// No texture direction (or it was parallel to the normal), use
+		// any direction perpendicular to the normal: cross(n, x) unless
+		// n is close to x, otherwise cross(n, y)
+		float useX = std::abs(n0) < 0.9f ? 1.0f : 0.0f;
+		float useY = 1.0f - useX;
+		bool fallback = tLength <= 1e-6f * length;
+		t0 = fallback ? -n2*useY : t0;
+		t1 = fallback ? n2*useX : t1;
+		t2 = fallback ? n0*useY - n1*useX : t2;
+		tLength = std::sqrt(t0*t0 + t1*t1 + t2*t2);
+		t0 /= tLength; t1 /= tLength; t2 /= tLength;
+
+		float c0 = n1*t2 - n2*t1;
+		float c1 = n2*t0 - n0*t2;
+		float c2 = n0*t1 - n1*t0;
+		float sign = c0*bx[v] + c1*by[v] + c2*bz[v] < 0.0f ? -1.0f : 1.0f;
+
+		nx[v] = n0; ny[v] = n1; nz[v] = n2;
+		tx[v] = t0; ty[v] = t1; tz[v] = t2;
+		bx[v] = c0*sign; by[v] = c1*sign; bz[v] = c2*sign;
+	}
+
+	// (4) Copy the results of vertices used by a triangle back
+	for(std::size_t v =0; v < vertexCount; ++v){
+		if(!used[v]){
+			continue;
+		}
+		float* vertex = &m_bufferData[v*FLOATS_PER_VERTEX];
+		vertex[NORMAL_OFFSET+0] = nx[v];    vertex[NORMAL_OFFSET+1] = ny[v];    vertex[NORMAL_OFFSET+2] = nz[v];
+		vertex[TANGENT_OFFSET+0] = tx[v];   vertex[TANGENT_OFFSET+1] = ty[v];   vertex[TANGENT_OFFSET+2] = tz[v];
+		vertex[BITANGENT_OFFSET+0] = bx[v]; vertex[BITANGENT_OFFSET+1] = by[v]; vertex[BITANGENT_OFFSET+2] = bz[v];
+	}
 }
 
 // Retrieves the number of indices that we have.
@@ -175,3 +360,19 @@ unsigned int Geometry::GetIndicesSize(){
 unsigned int* Geometry::GetIndicesDataPtr(){
 	return m_indices.data();
 }
+
+// Retrieve the format of our buffer data
+VertexFormat Geometry::GetVertexFormat() const{
+	return m_format;
+}
+
+// Retrieve the position of vertex 'i' (in the full format)
+glm::vec3 Geometry::GetPosition(unsigned int i) const{
+	const float* v = &m_bufferData[(std::size_t)i*FLOATS_PER_VERTEX + POSITION_OFFSET];
+	return glm::vec3(v[0],v[1],v[2]);
+}
+
+// Retrieve a sphere enclosing every vertex
+const BoundingSphere& Geometry::GetBoundingSphere() const{
+	return m_boundingSphere;
+}
@@ -0,0 +1,199 @@
+#include "GeometryArena.hpp"
+#include "VertexArrayCache.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+// Vertices and indices a pool starts with. Pools grow as needed, this
+// just saves growing a few times while the first meshes are loaded.
+static const unsigned int DEFAULT_VERTEX_CAPACITY = 64 * 1024;
+static const unsigned int DEFAULT_INDEX_CAPACITY = 256 * 1024;
+
+GeometryArena::GeometryArena()
+    : m_initialVertexCapacity(DEFAULT_VERTEX_CAPACITY),
+      m_initialIndexCapacity(DEFAULT_INDEX_CAPACITY) {}
+
+// Destructor is empty, RemoveAll must be called while
+// there is still an OpenGL context to delete from.
+GeometryArena::~GeometryArena() {}
+
+GeometryArena &GeometryArena::Instance() {
+  static GeometryArena *instance = new GeometryArena();
+  return *instance;
+}
+
+GeometryArena::Allocation
+GeometryArena::Allocate(const VertexLayout &layout, unsigned int vertexCount,
+                        unsigned int indexCount, const void *vertices,
+                        const unsigned int *indices) {
+  Allocation allocation;
+  allocation.pool = FindPool(layout);
+  allocation.generation = m_generation;
+  Pool &pool = *m_pools[allocation.pool];
+  Reserve(pool, vertexCount, indexCount);
+  allocation.vertexCount = vertexCount;
+  allocation.indexCount = indexCount;
+  allocation.baseVertex = pool.vertices.Allocate(vertexCount);
+  allocation.firstIndex = pool.indices.Allocate(indexCount);
+
+  // The copy targets are not part of any vertex array's state, so
+  // nothing else that is bound is disturbed.
+  if (vertexCount > 0) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    (GLintptr)allocation.baseVertex * layout.stride,
+                    (GLsizeiptr)vertexCount * layout.stride, vertices);
+  }
+  if (indexCount > 0) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pool.indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    (GLintptr)allocation.firstIndex * sizeof(unsigned int),
+                    (GLsizeiptr)indexCount * sizeof(unsigned int), indices);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  return allocation;
+}
+
+void GeometryArena::Free(const Allocation &allocation) {
+  // Allocations made before RemoveAll have nothing left to free
+  if (!IsCurrent(allocation)) {
+    return;
+  }
+  Pool &pool = *m_pools[allocation.pool];
+  pool.vertices.Free(allocation.baseVertex, allocation.vertexCount);
+  pool.indices.Free(allocation.firstIndex, allocation.indexCount);
+}
+
+GLuint GeometryArena::GetVertexArray(const Allocation &allocation) const {
+  if (!IsCurrent(allocation)) {
+    return 0;
+  }
+  return m_pools[allocation.pool]->vertexArray;
+}
+
+GLuint GeometryArena::GetInstancedVertexArray(
+    GLuint vertexArray, const VertexLayout &instanceLayout,
+    GLuint instanceBuffer) const {
+  for (const auto &pool : m_pools) {
+    if (pool->vertexArray == vertexArray && vertexArray != 0) {
+      return VertexArrayCache::Instance().Get(pool->layout, pool->vertexBuffer,
+                                              pool->indexBuffer, instanceLayout,
+                                              instanceBuffer);
+    }
+  }
+  return 0;
+}
+
+unsigned int GeometryArena::GetBufferCount() const {
+  return m_pools.size() * 2;
+}
+
+unsigned long GeometryArena::GetUsedBytes() const {
+  unsigned long bytes = 0;
+  for (const auto &pool : m_pools) {
+    bytes += (unsigned long)pool->vertices.GetUsed() * pool->layout.stride +
+             (unsigned long)pool->indices.GetUsed() * sizeof(unsigned int);
+  }
+  return bytes;
+}
+
+unsigned long GeometryArena::GetCapacityBytes() const {
+  unsigned long bytes = 0;
+  for (const auto &pool : m_pools) {
+    bytes +=
+        (unsigned long)pool->vertices.GetCapacity() * pool->layout.stride +
+        (unsigned long)pool->indices.GetCapacity() * sizeof(unsigned int);
+  }
+  return bytes;
+}
+
+void GeometryArena::SetInitialCapacity(unsigned int vertices,
+                                       unsigned int indices) {
+  m_initialVertexCapacity = vertices;
+  m_initialIndexCapacity = indices;
+}
+
+void GeometryArena::RemoveAll() {
+  for (auto &pool : m_pools) {
+    VertexArrayCache::Instance().Remove(pool->vertexBuffer);
+    glDeleteBuffers(1, &pool->vertexBuffer);
+    glDeleteBuffers(1, &pool->indexBuffer);
+  }
+  m_pools.clear();
+  ++m_generation;
+}
+
+bool GeometryArena::IsCurrent(const Allocation &allocation) const {
+  // A new pool may have taken an old allocation's index since
+  return allocation.IsValid() && allocation.generation == m_generation &&
+         allocation.pool < m_pools.size();
+}
+
+unsigned int GeometryArena::FindPool(const VertexLayout &layout) {
+  // There are only ever a few layouts
+  for (unsigned int i = 0; i < m_pools.size(); ++i) {
+    if (m_pools[i]->layout == layout) {
+      return i;
+    }
+  }
+  std::unique_ptr<Pool> pool(new Pool());
+  pool->layout = layout;
+  m_pools.push_back(std::move(pool));
+  return m_pools.size() - 1;
+}
+
+void GeometryArena::Reserve(Pool &pool, unsigned int vertexCount,
+                            unsigned int indexCount) {
+  bool grown = false;
+  unsigned int oldCapacity = pool.vertices.GetCapacity();
+  if (pool.vertices.GetLargestFreeRange() < vertexCount) {
+    // Doubling keeps the number of copies low as meshes are added.
+    // The new space joins any free space at the end of the buffer.
+    unsigned int newCapacity = std::max({m_initialVertexCapacity,
+                                         oldCapacity * 2,
+                                         oldCapacity + vertexCount});
+    GrowBuffer(pool.vertexBuffer,
+               (GLsizeiptr)oldCapacity * pool.layout.stride,
+               (GLsizeiptr)newCapacity * pool.layout.stride);
+    pool.vertices.Grow(newCapacity);
+    grown = true;
+  }
+  oldCapacity = pool.indices.GetCapacity();
+  if (pool.indices.GetLargestFreeRange() < indexCount) {
+    unsigned int newCapacity = std::max(
+        {m_initialIndexCapacity, oldCapacity * 2, oldCapacity + indexCount});
+    GrowBuffer(pool.indexBuffer,
+               (GLsizeiptr)oldCapacity * sizeof(unsigned int),
+               (GLsizeiptr)newCapacity * sizeof(unsigned int));
+    pool.indices.Grow(newCapacity);
+    grown = true;
+  }
+  if (grown) {
+    // GrowBuffer dropped the vertex arrays of the old buffers
+    pool.vertexArray = VertexArrayCache::Instance().Get(
+        pool.layout, pool.vertexBuffer, pool.indexBuffer);
+    std::cout << "(GeometryArena.cpp) Pool of stride " << pool.layout.stride
+              << " now holds " << pool.vertices.GetCapacity()
+              << " vertices and " << pool.indices.GetCapacity()
+              << " indices\n";
+  }
+}
+
+void GeometryArena::GrowBuffer(GLuint &buffer, GLsizeiptr oldSize,
+                               GLsizeiptr newSize) {
+  GLuint newBuffer = 0;
+  glGenBuffers(1, &newBuffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+  if (buffer != 0) {
+    // Copy the meshes across without a round trip through the CPU
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                        oldSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    VertexArrayCache::Instance().Remove(buffer);
+    glDeleteBuffers(1, &buffer);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  buffer = newBuffer;
+}
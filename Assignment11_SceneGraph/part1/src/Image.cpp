@@ -1,4 +1,5 @@
 #include "Image.hpp"
+#include <charconv>
 #include <fstream>
 #include <iostream>
 #include <string.h>
@@ -15,86 +16,210 @@ Image::~Image (){
     // Delete our pixel data.	
     // Note: We could actually do this sooner
     // in our rendering process.
-    if(m_pixelData!=NULL){
+    // Data that lives in our file mapping is released
+    // along with the mapping.
+    if(m_ownsPixelData && m_pixelData!=NULL){
         delete[] m_pixelData;
     }
 }
 
+// Skips over whitespace and '#' comments in a PPM header or
+// ASCII pixel block. Returns the position of the next token.
+static std::size_t SkipWhitespaceAndComments(const char *data,
+                                             std::size_t size,
+                                             std::size_t pos) {
+  while (pos < size) {
+    char c = data[pos];
+    if (c == '#') {
+      // Comments run until the end of the line
+      while (pos < size && data[pos] != '\n') {
+        ++pos;
+      }
+    } else if (c == ' ' || c == '\n' || c == '\r' || c == '\t' ||
+               c == '\v' || c == '\f') {
+      ++pos;
+    } else {
+      break;
+    }
+  }
+  return pos;
+}
+
+// Reads one unsigned integer starting at 'pos' and advances 'pos'
+// past it. Returns false if there is no number at 'pos'.
+static bool ReadPPMInteger(const char *data, std::size_t size,
+                           std::size_t &pos, unsigned int &value) {
+  pos = SkipWhitespaceAndComments(data, size, pos);
+  std::from_chars_result result =
+      std::from_chars(data + pos, data + size, value);
+  if (result.ec != std::errc()) {
+    return false;
+  }
+  pos = result.ptr - data;
+  return true;
+}
+
 // Little function for loading the pixel data
 // from a PPM image.
-// TODO: Expects a very specific version of PPM!
+// Both the binary (P6) and ASCII (P3) formats are supported.
+// The file is memory mapped, and parsed in a single pass.
 //
 // flip - Will flip the pixels upside down in the data
 //        If you use this be consistent.
-void Image::LoadPPM(bool flip){
-
-  // Open an input file stream for reading a file
-  std::ifstream ppmFile(m_filepath.c_str());
-  // If our file successfully opens, begin to process it.
-  if (ppmFile.is_open()){
-      // line will store one line of input
-      std::string line;
-      // Our loop invariant is to continue reading input until
-      // we reach the end of the file and it reads in a NULL character
-      std::cout << "Reading in ppm file: " << m_filepath << std::endl;
-      unsigned int iteration = 0;
-      unsigned int pos = 0;
-      while ( getline (ppmFile,line) ){
-         // Ignore comments in the file
-         if (line[0]=='#'){
-            continue;
-         }
-         if(line[0]=='P'){
-            magicNumber = line;
-         }else if(iteration==1){
-            // Returns first token 
-            char *token = strtok((char*)line.c_str(), " "); 
-            m_width = atoi(token);
-            token = strtok(NULL, " ");
-            m_height = atoi(token);
-            std::cout << "PPM width,height=" << m_width << "," << m_height << "\n";	
-            if(m_width > 0 && m_height > 0){
-                m_pixelData = new uint8_t[m_width*m_height*3];
-                if(m_pixelData==NULL){
-                    std::cout << "Unable to allocate memory for ppm" << std::endl;
-                    exit(1);
-                 }
-             }else{
-                std::cout << "PPM not parsed correctly, width and/or height dimensions are 0" << std::endl;
-                exit(1);
-             }
-         }else if(iteration==2){
-            // max color range is stored here
-            // TODO: Can be stored optionally
-         }else{
-            m_pixelData[pos] = (uint8_t)atoi(line.c_str());
-            ++pos;
-         }
-          iteration++;
-    }             
-    ppmFile.close();
+void Image::LoadPPM(bool flip) {
+  std::cout << "Reading in ppm file: " << m_filepath << std::endl;
+  // Release any previously loaded image
+  if (m_ownsPixelData) {
+    delete[] m_pixelData;
   }
-  else{
-      std::cout << "Unable to open ppm file:" << m_filepath << std::endl;
-  } 
-
-    // Flip all of the pixels
-    if(flip){
-        // Copy all of the data to a temporary stack-allocated array
-        uint8_t* copyData = new uint8_t[m_width*m_height*3];
-        for(int i =0; i < m_width*m_height*3; ++i){
-            copyData[i]=m_pixelData[i];
-        }
-        //memcpy(copyData,m_pixelData,(m_width*m_height*3)*sizeof(uint8_t));
-        unsigned int pos = (m_width*m_height*3)-1;
-        for(int i =0; i < m_width*m_height*3; i+=3){
-            m_pixelData[pos]=copyData[i+2];
-            m_pixelData[pos-1]=copyData[i+1];
-            m_pixelData[pos-2]=copyData[i];
-            pos-=3;
-        }
-        delete[] copyData;
+  m_pixelData = nullptr;
+  m_ownsPixelData = false;
+
+  if (!m_file.Open(m_filepath)) {
+    std::cout << "Unable to open ppm file:" << m_filepath << std::endl;
+    return;
+  }
+
+  const char *data = reinterpret_cast<const char *>(m_file.GetData());
+  std::size_t size = m_file.GetSize();
+  std::size_t offset = 0;
+  if (!ParsePPMHeader(data, size, offset)) {
+    m_file.Close();
+    return;
+  }
+  std::cout << "PPM width,height=" << m_width << "," << m_height << "\n";
+
+  bool loaded = false;
+  if (magicNumber == "P6") {
+    loaded = LoadP6(m_file.GetData(), size, offset, flip);
+  } else {
+    loaded = LoadP3(data, size, offset, flip);
+  }
+
+  // Only binary images may still reference the mapping.
+  if (m_ownsPixelData) {
+    m_file.Close();
+  }
+  if (!loaded) {
+    std::cout << "PPM not parsed correctly, pixel data is incomplete: "
+              << m_filepath << std::endl;
+  }
+}
+
+// Reads the header of a PPM which looks like the following:
+//   P3 or P6
+//   # Any number of comments
+//   width height
+//   max color value
+bool Image::ParsePPMHeader(const char *data, std::size_t size,
+                           std::size_t &offset) {
+  offset = SkipWhitespaceAndComments(data, size, 0);
+  if (offset + 2 > size || data[offset] != 'P' ||
+      (data[offset + 1] != '3' && data[offset + 1] != '6')) {
+    std::cout << "PPM magic number must be P3 or P6: " << m_filepath
+              << std::endl;
+    return false;
+  }
+  magicNumber.assign(data + offset, 2);
+  offset += 2;
+
+  unsigned int width = 0;
+  unsigned int height = 0;
+  unsigned int maxValue = 0;
+  if (!ReadPPMInteger(data, size, offset, width) ||
+      !ReadPPMInteger(data, size, offset, height) ||
+      !ReadPPMInteger(data, size, offset, maxValue)) {
+    std::cout << "PPM header could not be parsed: " << m_filepath
+              << std::endl;
+    return false;
+  }
+  if (width == 0 || height == 0) {
+    std::cout << "PPM not parsed correctly, width and/or height dimensions "
+                 "are 0"
+              << std::endl;
+    return false;
+  }
+  if (maxValue == 0 || maxValue > 65535) {
+    std::cout << "PPM max color value is out of range: " << maxValue
+              << std::endl;
+    return false;
+  }
+  m_width = width;
+  m_height = height;
+  m_maxValue = maxValue;
+  return true;
+}
+
+// ASCII pixel data is a list of whitespace separated integers.
+// Each value is written straight to its final (possibly flipped)
+// location, so no temporary copy of the image is needed.
+bool Image::LoadP3(const char *data, std::size_t size, std::size_t offset,
+                   bool flip) {
+  const std::size_t pixelCount = (std::size_t)m_width * m_height;
+  m_pixelData = new uint8_t[pixelCount * 3];
+  m_ownsPixelData = true;
+
+  std::size_t pos = offset;
+  for (std::size_t pixel = 0; pixel < pixelCount; ++pixel) {
+    // Flipping reverses the order of the pixels, but keeps
+    // the order of the r,g,b components within a pixel.
+    uint8_t *out = m_pixelData + 3 * (flip ? pixelCount - 1 - pixel : pixel);
+    for (int component = 0; component < 3; ++component) {
+      unsigned int value;
+      if (!ReadPPMInteger(data, size, pos, value)) {
+        return false;
+      }
+      if (m_maxValue != 255) {
+        value = (value * 255 + m_maxValue / 2) / m_maxValue;
+      }
+      out[component] = (uint8_t)(value > 255 ? 255 : value);
     }
+  }
+  return true;
+}
+
+// Binary pixel data follows a single whitespace character after
+// the header. When the image is not flipped and uses one byte
+// per component, we hand out the bytes in the mapping directly.
+bool Image::LoadP6(uint8_t *data, std::size_t size, std::size_t offset,
+                   bool flip) {
+  // Skip the single whitespace character after the max value
+  ++offset;
+  const std::size_t pixelCount = (std::size_t)m_width * m_height;
+  const std::size_t bytesPerComponent = m_maxValue > 255 ? 2 : 1;
+  const std::size_t bytesNeeded = pixelCount * 3 * bytesPerComponent;
+  if (offset > size || size - offset < bytesNeeded) {
+    return false;
+  }
+  const uint8_t *pixels = data + offset;
+
+  // Fast path: no copy at all
+  if (!flip && bytesPerComponent == 1 && m_maxValue == 255) {
+    m_pixelData = data + offset;
+    m_ownsPixelData = false;
+    return true;
+  }
+
+  m_pixelData = new uint8_t[pixelCount * 3];
+  m_ownsPixelData = true;
+  for (std::size_t pixel = 0; pixel < pixelCount; ++pixel) {
+    uint8_t *out = m_pixelData + 3 * (flip ? pixelCount - 1 - pixel : pixel);
+    for (int component = 0; component < 3; ++component) {
+      std::size_t index = pixel * 3 + component;
+      unsigned int value;
+      if (bytesPerComponent == 2) {
+        // 16-bit values are stored most significant byte first
+        value = (pixels[index * 2] << 8) | pixels[index * 2 + 1];
+      } else {
+        value = pixels[index];
+      }
+      if (m_maxValue != 255) {
+        value = (value * 255 + m_maxValue / 2) / m_maxValue;
+      }
+      out[component] = (uint8_t)(value > 255 ? 255 : value);
+    }
+  }
+  return true;
 }
 
 /*  ===============================================
@@ -0,0 +1,93 @@
+#include "IndirectDraw.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <cstring>
+
+// glMultiDrawElementsIndirect, which glad does not load for us
+typedef void(APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode,
+                                                      GLenum type,
+                                                      const void *indirect,
+                                                      GLsizei drawcount,
+                                                      GLsizei stride);
+static MultiDrawElementsIndirectProc s_multiDrawElementsIndirect = nullptr;
+
+bool IndirectDraw::IsSupported() {
+  static bool loaded = false;
+  if (!loaded) {
+    loaded = true;
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    // Older versions may still have the extensions. We need both the
+    // multi-draw call and baseInstance (OpenGL 4.2), since baseInstance
+    // is how each command finds its per-instance attributes. Without
+    // it, baseInstance must be 0 and every draw reads instance 0.
+    bool multiDraw = major > 4 || (major == 4 && minor >= 3);
+    bool baseInstance = major > 4 || (major == 4 && minor >= 2);
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; ++i) {
+      const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
+      if (name == nullptr) {
+        continue;
+      }
+      multiDraw = multiDraw ||
+                  std::strcmp(name, "GL_ARB_multi_draw_indirect") == 0;
+      baseInstance =
+          baseInstance || std::strcmp(name, "GL_ARB_base_instance") == 0;
+    }
+    bool supported = multiDraw && baseInstance;
+    if (supported) {
+      s_multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)
+          SDL_GL_GetProcAddress("glMultiDrawElementsIndirect");
+    }
+  }
+  return s_multiDrawElementsIndirect != nullptr;
+}
+
+void IndirectDraw::MultiDrawElements(GLenum mode, unsigned int first,
+                                     unsigned int drawCount) {
+  s_multiDrawElementsIndirect(
+      mode, GL_UNSIGNED_INT,
+      // Offset into the bound buffer, in bytes
+      (char *)(sizeof(DrawElementsIndirectCommand) * first), drawCount,
+      // 0 means the commands are tightly packed
+      0);
+}
+
+// Constructor
+IndirectCommandBuffer::IndirectCommandBuffer() {}
+
+// Destructor
+IndirectCommandBuffer::~IndirectCommandBuffer() {
+  glDeleteBuffers(1, &m_bufferID);
+}
+
+// Upload all of our commands at once.
+void IndirectCommandBuffer::Upload(
+    const std::vector<DrawElementsIndirectCommand> &commands) {
+  if (m_bufferID == 0) {
+    glGenBuffers(1, &m_bufferID);
+  }
+  GLsizeiptr size = commands.size() * sizeof(DrawElementsIndirectCommand);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_bufferID);
+  if (size > m_capacity) {
+    // Grow the buffer (with some room to spare)
+    m_capacity = size + size / 2;
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, m_capacity, nullptr,
+                 GL_DYNAMIC_DRAW);
+  }
+  if (size > 0) {
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, commands.data());
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void IndirectCommandBuffer::Bind() const {
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_bufferID);
+}
+
+void IndirectCommandBuffer::Unbind() const {
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,138 @@
+#include "JobSystem.hpp"
+
+#include <iostream>
+
+// The queue used by the current thread. Threads that do not belong
+// to the job system (i.e. the main thread) use queue 0.
+static thread_local unsigned int s_queueIndex = 0;
+
+// Constructor
+JobSystem::JobSystem() {}
+
+// Destructor
+JobSystem::~JobSystem() { Shutdown(); }
+
+void JobSystem::Initialize(unsigned int workerCount) {
+  if (m_running) {
+    return;
+  }
+  if (workerCount == 0) {
+    unsigned int cores = std::thread::hardware_concurrency();
+    workerCount = cores > 1 ? cores - 1 : 1;
+  }
+  m_running = true;
+  // One queue for the main thread, and one for each worker
+  for (unsigned int i = 0; i <= workerCount; ++i) {
+    m_queues.push_back(std::unique_ptr<JobQueue>(new JobQueue()));
+  }
+  for (unsigned int i = 1; i <= workerCount; ++i) {
+    m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+  }
+  std::cout << "(JobSystem.cpp) Started " << workerCount
+            << " worker threads\n";
+}
+
+void JobSystem::Shutdown() {
+  if (!m_running) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_running = false;
+  }
+  m_wakeCondition.notify_all();
+  for (unsigned int i = 0; i < m_workers.size(); ++i) {
+    m_workers[i].join();
+  }
+  m_workers.clear();
+  m_queues.clear();
+}
+
+unsigned int JobSystem::GetQueueIndex() const { return s_queueIndex; }
+
+void JobSystem::Submit(std::function<void()> job, JobCounter &counter) {
+  counter.fetch_add(1);
+  // Without any workers, just run the job right away
+  if (m_queues.empty()) {
+    job();
+    counter.fetch_sub(1);
+    return;
+  }
+  JobQueue &queue = *m_queues[GetQueueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(Job{std::move(job), &counter});
+  }
+  m_queuedJobs.fetch_add(1);
+  // Taking the lock makes sure a worker that is about to sleep
+  // either sees the new job or receives the notification.
+  { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+  m_wakeCondition.notify_one();
+}
+
+bool JobSystem::RunOneJob(unsigned int queueIndex) {
+  Job job;
+  bool found = false;
+  // Newest job from our own queue first, since it is most
+  // likely to use data that is already in our cache.
+  {
+    JobQueue &own = *m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.jobs.empty()) {
+      job = std::move(own.jobs.back());
+      own.jobs.pop_back();
+      found = true;
+    }
+  }
+  // Otherwise steal the oldest job from somebody else
+  for (unsigned int i = 1; !found && i < m_queues.size(); ++i) {
+    JobQueue &victim = *m_queues[(queueIndex + i) % m_queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+  m_queuedJobs.fetch_sub(1);
+  job.function();
+  job.counter->fetch_sub(1);
+  return true;
+}
+
+void JobSystem::WorkerLoop(unsigned int queueIndex) {
+  s_queueIndex = queueIndex;
+  while (true) {
+    if (RunOneJob(queueIndex)) {
+      continue;
+    }
+    // Nothing to do, so sleep until more jobs are submitted
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wakeCondition.wait(
+        lock, [this]() { return !m_running || m_queuedJobs.load() > 0; });
+    if (!m_running) {
+      return;
+    }
+  }
+}
+
+void JobSystem::Wait(JobCounter &counter) {
+  // Rather than sitting idle, help with the remaining work
+  while (counter.load() > 0) {
+    if (m_queues.empty() || !RunOneJob(GetQueueIndex())) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::ParallelFor(unsigned int count,
+                            const std::function<void(unsigned int)> &job) {
+  JobCounter counter{0};
+  for (unsigned int i = 0; i < count; ++i) {
+    Submit([&job, i]() { job(i); }, counter);
+  }
+  Wait(counter);
+}
@@ -0,0 +1,85 @@
+#include "MappedFile.hpp"
+
+#include <fstream>
+#include <iostream>
+
+// mmap is only available on POSIX systems. The build script passes
+// in -D LINUX or -D MAC, otherwise we fall back to a regular read.
+#if defined(LINUX) || defined(MAC)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPEDFILE_USE_MMAP
+#endif
+
+// Constructor
+MappedFile::MappedFile() {}
+
+// Destructor
+MappedFile::~MappedFile() { Close(); }
+
+// Maps an entire file into our address space
+bool MappedFile::Open(const std::string &filepath) {
+  // Release anything we previously had open
+  Close();
+
+#ifdef MAPPEDFILE_USE_MMAP
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cout << "Unable to open file: " << filepath << std::endl;
+    return false;
+  }
+  struct stat fileInfo;
+  if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0) {
+    std::cout << "Unable to read size of file: " << filepath << std::endl;
+    close(fd);
+    return false;
+  }
+  m_size = static_cast<std::size_t>(fileInfo.st_size);
+  // MAP_PRIVATE gives us copy-on-write pages, so callers can write
+  // to the data (e.g. Image::SetPixel) without touching the file.
+  void *address =
+      mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (address == MAP_FAILED) {
+    std::cout << "Unable to map file: " << filepath << std::endl;
+    m_size = 0;
+    return false;
+  }
+  // We read files front to back, so let the OS read ahead.
+  madvise(address, m_size, MADV_SEQUENTIAL);
+  m_data = static_cast<uint8_t *>(address);
+#else
+  std::ifstream file(filepath.c_str(), std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    std::cout << "Unable to open file: " << filepath << std::endl;
+    return false;
+  }
+  std::streamoff length = file.tellg();
+  if (length <= 0) {
+    std::cout << "Unable to read size of file: " << filepath << std::endl;
+    return false;
+  }
+  m_size = static_cast<std::size_t>(length);
+  m_data = new uint8_t[m_size];
+  file.seekg(0, std::ios::beg);
+  file.read(reinterpret_cast<char *>(m_data), m_size);
+#endif
+  return true;
+}
+
+// Release the mapping
+void MappedFile::Close() {
+  if (m_data == nullptr) {
+    return;
+  }
+#ifdef MAPPEDFILE_USE_MMAP
+  munmap(m_data, m_size);
+#else
+  delete[] m_data;
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
@@ -0,0 +1,25 @@
+#include "Mesh.hpp"
+
+// Constructor
+Mesh::Mesh() {}
+
+// Destructor
+Mesh::~Mesh() { GeometryArena::Instance().Free(m_allocation); }
+
+// Put our geometry on the GPU
+void Mesh::Upload(VertexFormat format) {
+  // Generate a simple 'array of bytes' that contains
+  // everything for our buffer to work with.
+  m_geometry.Gen(format);
+  // Copy it into the arena, laid out the way Gen packed it
+  m_allocation = GeometryArena::Instance().Allocate(
+      GetVertexLayout(format), m_geometry.GetVertexCount(),
+      m_geometry.GetIndicesSize(), m_geometry.GetBufferDataPtr(),
+      m_geometry.GetIndicesDataPtr());
+  m_sizeInBytes = m_geometry.GetBufferSizeInBytes() +
+                  m_allocation.indexCount * sizeof(unsigned int);
+  // The GPU has its own copy now, so free ours
+  m_geometry.Release();
+}
+
+void Mesh::Bind() { glBindVertexArray(GetVAOID()); }
@@ -0,0 +1,75 @@
+#include "MeshRegistry.hpp"
+
+// Constructor is empty
+MeshRegistry::MeshRegistry() {}
+
+// Destructor is empty, the meshes are
+// owned by the objects that use them.
+MeshRegistry::~MeshRegistry() {}
+
+MeshRegistry &MeshRegistry::Instance() {
+  static MeshRegistry *instance = new MeshRegistry();
+  return *instance;
+}
+
+// Returns a shared mesh, only generating it
+// if it is not already on the GPU.
+std::shared_ptr<Mesh> MeshRegistry::Get(const MeshKey &key,
+                                        const BuildFunction &build) {
+  auto it = m_meshes.find(key);
+  if (it != m_meshes.end()) {
+    // lock() returns nullptr if the mesh was already deleted
+    std::shared_ptr<Mesh> mesh = it->second.lock();
+    if (mesh != nullptr) {
+      return mesh;
+    }
+  }
+
+  std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+  build(mesh->GetGeometry());
+  mesh->Upload(key.format);
+  m_meshes[key] = mesh;
+
+  // Good time to forget about meshes that are no longer used
+  RemoveExpired();
+  return mesh;
+}
+
+long MeshRegistry::GetReferenceCount(const MeshKey &key) const {
+  auto it = m_meshes.find(key);
+  if (it == m_meshes.end()) {
+    return 0;
+  }
+  return it->second.use_count();
+}
+
+unsigned int MeshRegistry::GetMeshCount() const {
+  unsigned int count = 0;
+  for (const auto &entry : m_meshes) {
+    if (!entry.second.expired()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+unsigned int MeshRegistry::GetSizeInBytes() const {
+  unsigned int size = 0;
+  for (const auto &entry : m_meshes) {
+    std::shared_ptr<Mesh> mesh = entry.second.lock();
+    if (mesh != nullptr) {
+      size += mesh->GetSizeInBytes();
+    }
+  }
+  return size;
+}
+
+void MeshRegistry::RemoveExpired() {
+  for (auto it = m_meshes.begin(); it != m_meshes.end();) {
+    if (it->second.expired()) {
+      it = m_meshes.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
@@ -1,6 +1,8 @@
 #include "Object.hpp"
 #include "Camera.hpp"
 #include "Error.hpp"
+#include "MeshRegistry.hpp"
+#include "TextureCache.hpp"
 
 
 Object::Object(){
@@ -15,7 +17,8 @@ Object::~Object(){
 // if the user forgets to do this action!
 void Object::LoadTexture(std::string fileName){
         // Load our actual textures
-        m_textureDiffuse.LoadTexture(fileName);
+        // If another object already loaded this file, we share it.
+        m_textureDiffuse = TextureCache::Instance().Get(fileName);
 }
 
 // Initialization of object as a 'quad'
@@ -23,36 +26,31 @@ void Object::LoadTexture(std::string fileName){
 // This could be called in the constructor or
 // otherwise 'explicitly' called this
 // so we create our objects at the correct time
-void Object::MakeTexturedQuad(std::string fileName){
+void Object::MakeTexturedQuad(std::string fileName, VertexFormat format){
 
-        // Setup geometry
-        // We are using a new abstraction which allows us
-        // to create triangles shapes on the fly
-        // Position and Texture coordinate 
-        m_geometry.AddVertex(-1.0f,-1.0f, 0.0f, 0.0f, 0.0f);
-        m_geometry.AddVertex( 1.0f,-1.0f, 0.0f, 1.0f, 0.0f);
-    	m_geometry.AddVertex( 1.0f, 1.0f, 0.0f, 1.0f, 1.0f);
-        m_geometry.AddVertex(-1.0f, 1.0f, 0.0f, 0.0f, 1.0f);
-            
-        // Make our triangles and populate our
-        // indices data structure	
-        m_geometry.MakeTriangle(0,1,2);
-        m_geometry.MakeTriangle(2,3,0);
-
-        // This is a helper function to generate all of the geometry
-        m_geometry.Gen();
-
-        // Create a buffer and set the stride of information
-        // NOTE: How we are leveraging our data structure in order to very cleanly
-        //       get information into and out of our data structure.
-        m_vertexBufferLayout.CreateNormalBufferLayout(m_geometry.GetBufferDataSize(),
-                                        m_geometry.GetIndicesSize(),
-                                        m_geometry.GetBufferDataPtr(),
-                                        m_geometry.GetIndicesDataPtr());
+        // Every quad is the same, so they all share one mesh
+        m_mesh = MeshRegistry::Instance().Get({PrimitiveType::Quad,{1,1},format},
+            [](Geometry& geometry){
+            // Setup geometry
+            // We are using a new abstraction which allows us
+            // to create triangles shapes on the fly
+            // Position and Texture coordinate 
+            geometry.Reserve(4,6);
+            geometry.AddVertex(-1.0f,-1.0f, 0.0f, 0.0f, 0.0f);
+            geometry.AddVertex( 1.0f,-1.0f, 0.0f, 1.0f, 0.0f);
+            geometry.AddVertex( 1.0f, 1.0f, 0.0f, 1.0f, 1.0f);
+            geometry.AddVertex(-1.0f, 1.0f, 0.0f, 0.0f, 1.0f);
+                
+            // Make our triangles and populate our
+            // indices data structure	
+            geometry.MakeTriangle(0,1,2);
+            geometry.MakeTriangle(2,3,0);
+            geometry.ComputeTangentFrames();
+        });
 
         // Load our actual texture
         // We are using the input parameter as our texture to load
-        m_textureDiffuse.LoadTexture(fileName.c_str());
+        m_textureDiffuse = TextureCache::Instance().Get(fileName);
 }
 
 // Bind everything we need in our object
@@ -60,9 +58,11 @@ void Object::MakeTexturedQuad(std::string fileName){
 // before we do any actual work with our object
 void Object::Bind(){
         // Make sure we are updating the correct 'buffers'
-        m_vertexBufferLayout.Bind();
+        m_mesh->Bind();
         // Diffuse map is 0 by default, but it is good to set it explicitly
-        m_textureDiffuse.Bind(0);
+        if(m_textureDiffuse != nullptr){
+            m_textureDiffuse->Bind(0);
+        }
 }
 
 // Render our geometry
@@ -70,10 +70,22 @@ void Object::Render(){
     // Call our helper function to just bind everything
     Bind();
 	//Render data
-    glDrawElements(GL_TRIANGLES,
-                   m_geometry.GetIndicesSize(), // The number of indices, not triangles.
+    glDrawElementsBaseVertex(GL_TRIANGLES,
+                   m_mesh->GetIndexCount(),     // The number of indices, not triangles.
                    GL_UNSIGNED_INT,             // Make sure the data type matches
-                        nullptr);               // Offset pointer to the data. 
-                                                // nullptr because we are currently bound
+                   (char*)(sizeof(unsigned int)*m_mesh->GetFirstIndex()),
+                                                // Offset to our first index, since
+                                                // other meshes share the index buffer
+                   m_mesh->GetBaseVertex());    // Added to every index, since other
+                                                // meshes share the vertex buffer too
 }
 
+// Returns a sphere enclosing our geometry
+const BoundingSphere& Object::GetBoundingSphere() const{
+    // An object without a mesh has nothing to enclose
+    static const BoundingSphere empty;
+    if(m_mesh == nullptr){
+        return empty;
+    }
+    return m_mesh->GetBoundingSphere();
+}
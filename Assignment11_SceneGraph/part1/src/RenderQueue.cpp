@@ -0,0 +1,81 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+
+// Width of each field in the key
+static const unsigned int PASS_BITS = 4;
+static const unsigned int SHADER_BITS = 12;
+static const unsigned int TEXTURE_BITS = 16;
+static const unsigned int VERTEX_ARRAY_BITS = 16;
+static const unsigned int DEPTH_BITS = 16;
+static_assert(PASS_BITS + SHADER_BITS + TEXTURE_BITS + VERTEX_ARRAY_BITS +
+                      DEPTH_BITS ==
+                  64,
+              "The sort key fields must fill 64 bits");
+
+// Keeps the lowest 'bits' bits of 'value'
+static uint64_t Field(uint64_t value, unsigned int bits) {
+  return value & ((uint64_t(1) << bits) - 1);
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, unsigned int shader,
+                              unsigned int texture, unsigned int vertexArray,
+                              float depth) {
+  float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+  uint64_t quantizedDepth =
+      (uint64_t)(clamped * (float)((1u << DEPTH_BITS) - 1));
+  uint64_t key = Field((unsigned int)pass, PASS_BITS);
+  key = (key << SHADER_BITS) | Field(shader, SHADER_BITS);
+  key = (key << TEXTURE_BITS) | Field(texture, TEXTURE_BITS);
+  key = (key << VERTEX_ARRAY_BITS) | Field(vertexArray, VERTEX_ARRAY_BITS);
+  key = (key << DEPTH_BITS) | quantizedDepth;
+  return key;
+}
+
+// Constructor
+RenderQueue::RenderQueue() {}
+
+// Destructor
+RenderQueue::~RenderQueue() {}
+
+void RenderQueue::Clear() { m_items.clear(); }
+
+// Least significant digit radix sort, one byte at a time.
+// Each pass is stable, so after the last pass the items are
+// sorted by the whole key.
+void RenderQueue::Sort() {
+  const unsigned int passes = sizeof(uint64_t);
+  std::size_t count = m_items.size();
+  if (count < 2) {
+    return;
+  }
+
+  // Count every byte of every key in one go
+  unsigned int histograms[passes][256] = {};
+  for (const Item &item : m_items) {
+    for (unsigned int pass = 0; pass < passes; ++pass) {
+      ++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+    }
+  }
+
+  m_scratch.resize(count);
+  for (unsigned int pass = 0; pass < passes; ++pass) {
+    unsigned int *histogram = histograms[pass];
+    // If every key has the same byte here, this pass would not move
+    // anything. The first key tells us which byte that would be.
+    if (histogram[(m_items[0].key >> (pass * 8)) & 0xFF] == count) {
+      continue;
+    }
+    // Turn the counts into where each byte's items start
+    unsigned int offset = 0;
+    for (unsigned int digit = 0; digit < 256; ++digit) {
+      unsigned int digitCount = histogram[digit];
+      histogram[digit] = offset;
+      offset += digitCount;
+    }
+    for (const Item &item : m_items) {
+      m_scratch[histogram[(item.key >> (pass * 8)) & 0xFF]++] = item;
+    }
+    m_items.swap(m_scratch);
+  }
+}
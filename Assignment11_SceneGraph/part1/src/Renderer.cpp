@@ -1,5 +1,17 @@
 #include "Renderer.hpp"
 
+#include "GeometryArena.hpp"
+#include "VertexArrayCache.hpp"
+
+#include <algorithm>
+
+// Smallest number of nodes worth giving to a thread
+static const unsigned int MIN_CHUNK_SIZE = 256;
+// Never the id of anything OpenGL creates
+static const GLuint UNKNOWN_ID = 0xFFFFFFFF;
+// Nothing is drawn beyond the far clipping plane
+static const float FAR_PLANE = 512.0f;
+
 
 // Sets the height and width of our renderer
 Renderer::Renderer(unsigned int w, unsigned int h){
@@ -14,6 +26,12 @@ Renderer::Renderer(unsigned int w, unsigned int h){
     m_cameras.push_back(defaultCamera);
 
     m_root = nullptr;
+
+    // Every shader reads the camera and light from this buffer
+    m_frameUniformBuffer.Create(sizeof(FrameUniforms), FRAME_DATA_BINDING);
+
+    // Start the threads our scene is updated with
+    JobSystem::Instance().Initialize();
 }
 
 // Sets the height and width of our renderer
@@ -22,6 +40,11 @@ Renderer::~Renderer(){
     for(int i=0; i < m_cameras.size(); i++){
         delete m_cameras[i];
     }
+    // The instance buffer is deleted with us, and so must be the
+    // vertex arrays that read it for indirect draws.
+    if(m_instanceBuffer.GetBufferID() != 0){
+        VertexArrayCache::Instance().Remove(m_instanceBuffer.GetBufferID());
+    }
 }
 
 void Renderer::Update(){
@@ -30,17 +53,236 @@ void Renderer::Update(){
     // Then perspective
     // Then the near and far clipping plane.
     // Note I cannot see anything closer than 0.1f units from the screen.
-    m_projectionMatrix = glm::perspective(glm::radians(45.0f),((float)m_screenWidth)/((float)m_screenHeight),0.1f,512.0f);
+    m_projectionMatrix = glm::perspective(glm::radians(45.0f),((float)m_screenWidth)/((float)m_screenHeight),0.1f,FAR_PLANE);
+
+    // TODO: By default, we will only have one camera
+    //       You may otherwise not want to hardcode
+    //       a value of '0' here.
+    Camera* camera = m_cameras[0];
 
-    // Perform the update
+    // Set the uniforms shared by every object once for the whole frame.
+    m_frameUniforms.view = camera->GetWorldToViewmatrix();
+    m_frameUniforms.projection = m_projectionMatrix;
+    // Create a 'light'
+    m_frameUniforms.lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    m_frameUniforms.ambientIntensity = 0.5f;
+    m_frameUniforms.lightPos =
+        glm::vec3(camera->GetEyeXPosition() + camera->GetViewXDirection(),
+                  camera->GetEyeYPosition() + camera->GetViewYDirection(),
+                  camera->GetEyeZPosition() + camera->GetViewZDirection());
+    m_frameUniformBuffer.Update(&m_frameUniforms, sizeof(FrameUniforms));
+
+    // Find what the camera can see this frame
+    m_frustum.ExtractPlanes(m_projectionMatrix * m_frameUniforms.view);
+
+    // Perform the update, which computes every node's world transform
+    // and gathers what to draw. Separate subtrees do not depend on
+    // each other, so the tree is split into chunks that are updated
+    // on every core.
+    SceneTree& tree = SceneTree::Instance();
+    JobSystem& jobs = JobSystem::Instance();
+    m_drawCommands.clear();
+    m_culledCount = 0;
     if(m_root!=nullptr){
-        // TODO: By default, we will only have one camera
-        //       You may otherwise not want to hardcode
-        //       a value of '0' here.
-        m_root->Update(m_projectionMatrix, m_cameras[0]);
+        // Aim for a few chunks per thread, so that threads which
+        // finish early can steal the rest of the work.
+        unsigned int chunkSize = std::max(MIN_CHUNK_SIZE,
+            tree.GetNodeCount() / (jobs.GetThreadCount() * 4 + 1));
+        unsigned int chunkCount = tree.SplitIntoChunks(m_root->GetID(), chunkSize);
+        m_chunkCommands.resize(chunkCount);
+        m_chunkCulledCounts.resize(chunkCount);
+        m_hiddenSubtrees.resize(tree.GetNodeCount());
+        // Serial chunks are the parents of all the other chunks,
+        // so they are done first, in order.
+        m_parallelChunks.clear();
+        for(unsigned int i=0; i < chunkCount; ++i){
+            if(tree.GetChunk(i).serial){
+                tree.UpdateChunk(i);
+            }else{
+                m_parallelChunks.push_back(i);
+            }
+        }
+        jobs.ParallelFor(m_parallelChunks.size(), [this](unsigned int i){
+            SceneTree::Instance().UpdateChunk(m_parallelChunks[i]);
+        });
+        // The bounds of a subtree are only known once all of its
+        // children are done, so culling needs a second pass.
+        tree.MergeChunkBounds();
+        for(unsigned int i=0; i < chunkCount; ++i){
+            if(tree.GetChunk(i).serial){
+                CullChunk(i);
+            }
+        }
+        jobs.ParallelFor(m_parallelChunks.size(), [this](unsigned int i){
+            CullChunk(m_parallelChunks[i]);
+        });
+        // Chunks are in depth first order, so joining them together
+        // draws the scene in the same order as walking the tree.
+        for(unsigned int i=0; i < chunkCount; ++i){
+            m_drawCommands.insert(m_drawCommands.end(),
+                m_chunkCommands[i].begin(), m_chunkCommands[i].end());
+            m_culledCount += m_chunkCulledCounts[i];
+        }
+    }
+    // Then send all of the model matrices at once
+    m_modelMatrices.Upload(tree.GetWorldMatrices(),
+                           tree.GetNodeCount() * sizeof(glm::mat4));
+
+    // Work out our draw calls, and which objects each one draws
+    BuildBatches();
+    m_instanceBuffer.Upload(m_instanceIndices.data(),
+                            m_instanceIndices.size() * sizeof(unsigned int));
+    // Then work out the order that changes the least state
+    SortBatches();
+    // and, if we draw indirectly, the commands to draw it with
+    m_usingIndirect = IsIndirectDrawing();
+    if(m_usingIndirect){
+        BuildIndirectCommands();
+        m_indirectBuffer.Upload(m_indirectCommands);
     }
 }
 
+void Renderer::BuildBatches(){
+    m_batches.clear();
+    m_instanceIndices.resize(m_drawCommands.size());
+    if(!m_instancing){
+        // One draw call per object
+        for(unsigned int i=0; i < m_drawCommands.size(); ++i){
+            m_batches.push_back(DrawBatch{m_drawCommands[i].node, i, 1,
+                                          GetDepth(m_drawCommands[i].objectIndex)});
+            m_instanceIndices[i] = m_drawCommands[i].objectIndex;
+        }
+        return;
+    }
+    // Count the objects in each batch. Batches are kept in the
+    // order their first object appears in the scene.
+    m_batchLookup.clear();
+    std::vector<unsigned int> batchOfCommand(m_drawCommands.size());
+    for(unsigned int i=0; i < m_drawCommands.size(); ++i){
+        SceneNode* node = m_drawCommands[i].node;
+        Object* object = node->GetObject();
+        DrawBatchKey key{node->m_shader->GetID(),
+                         object->GetVertexArrayID(),
+                         object->GetDiffuseTextureID(),
+                         object->GetFirstIndex(),
+                         object->GetIndexCount()};
+        auto inserted = m_batchLookup.insert(std::make_pair(key, (unsigned int)m_batches.size()));
+        float depth = GetDepth(m_drawCommands[i].objectIndex);
+        if(inserted.second){
+            m_batches.push_back(DrawBatch{node, 0, 0, depth});
+        }
+        batchOfCommand[i] = inserted.first->second;
+        DrawBatch& batch = m_batches[batchOfCommand[i]];
+        batch.instanceCount++;
+        batch.depth = std::min(batch.depth, depth);
+    }
+    // Each batch's instances start where the previous batch's end
+    unsigned int firstInstance = 0;
+    for(unsigned int b=0; b < m_batches.size(); ++b){
+        m_batches[b].firstInstance = firstInstance;
+        firstInstance += m_batches[b].instanceCount;
+        // Reused below to count how many instances have been placed
+        m_batches[b].instanceCount = 0;
+    }
+    for(unsigned int i=0; i < m_drawCommands.size(); ++i){
+        DrawBatch& batch = m_batches[batchOfCommand[i]];
+        m_instanceIndices[batch.firstInstance + batch.instanceCount] =
+            m_drawCommands[i].objectIndex;
+        batch.instanceCount++;
+    }
+}
+
+// Batches are drawn shader by shader, then texture by texture, then
+// mesh by mesh, and front to back among batches that share all three.
+void Renderer::SortBatches(){
+    m_renderQueue.Clear();
+    for(unsigned int b=0; b < m_batches.size(); ++b){
+        const DrawBatch& batch = m_batches[b];
+        Object* object = batch.node->GetObject();
+        m_renderQueue.Push(RenderQueue::MakeKey(RenderPass::Opaque,
+                                                batch.node->m_shader->GetID(),
+                                                object->GetDiffuseTextureID(),
+                                                object->GetVertexArrayID(),
+                                                batch.depth),
+                           b);
+    }
+    m_renderQueue.Sort();
+}
+
+// Each batch becomes one command. Batches are already sorted by
+// shader, texture and vertex array, so those that can be drawn with
+// one call are next to each other.
+void Renderer::BuildIndirectCommands(){
+    m_indirectCommands.clear();
+    m_buckets.clear();
+    GLuint instanceBuffer = m_instanceBuffer.GetBufferID();
+    GLuint shader = UNKNOWN_ID, vertexArray = UNKNOWN_ID, texture = UNKNOWN_ID;
+    const std::vector<RenderQueue::Item>& items = m_renderQueue.GetItems();
+    for(unsigned int i=0; i < items.size(); ++i){
+        const DrawBatch& batch = m_batches[items[i].value];
+        Object* object = batch.node->GetObject();
+        if(batch.node->m_shader->GetID() != shader ||
+           object->GetVertexArrayID() != vertexArray ||
+           object->GetDiffuseTextureID() != texture){
+            shader = batch.node->m_shader->GetID();
+            vertexArray = object->GetVertexArrayID();
+            texture = object->GetDiffuseTextureID();
+            GLuint instancedVertexArray =
+                GeometryArena::Instance().GetInstancedVertexArray(
+                    vertexArray, INSTANCE_LAYOUT, instanceBuffer);
+            m_buckets.push_back(DrawBucket{batch.node, instancedVertexArray,
+                (unsigned int)m_indirectCommands.size(), 0});
+        }
+        m_indirectCommands.push_back(DrawElementsIndirectCommand{
+            object->GetIndexCount(), batch.instanceCount,
+            object->GetFirstIndex(), (GLint)object->GetBaseVertex(),
+            batch.firstInstance});
+        m_buckets.back().commandCount++;
+    }
+}
+
+// Distance from the camera to the front of a node's bounds,
+// divided by the far plane (so 0 is at the camera and 1 is as
+// far as we can see).
+float Renderer::GetDepth(unsigned int index) const{
+    const BoundingSphere& bounds = SceneTree::Instance().GetWorldBounds(index);
+    // The camera looks down -z in view space
+    float distance = -(m_frameUniforms.view * glm::vec4(bounds.center, 1.0f)).z;
+    return (distance - bounds.radius) / FAR_PLANE;
+}
+
+void Renderer::BindProgram(Shader& shader){
+    if(m_boundProgram == shader.GetID()){
+        ++m_skippedStateChanges;
+        return;
+    }
+    shader.Bind();
+    m_boundProgram = shader.GetID();
+    ++m_stateChanges;
+}
+
+void Renderer::BindVertexArray(GLuint id){
+    if(m_boundVertexArray == id){
+        ++m_skippedStateChanges;
+        return;
+    }
+    glBindVertexArray(id);
+    m_boundVertexArray = id;
+    ++m_stateChanges;
+}
+
+void Renderer::BindTexture(GLuint id){
+    if(m_boundTexture == id){
+        ++m_skippedStateChanges;
+        return;
+    }
+    // Every object's diffuse map goes in slot 0, which
+    // is the slot left active for us.
+    glBindTexture(GL_TEXTURE_2D, id);
+    m_boundTexture = id;
+    ++m_stateChanges;
+}
+
 // Initialize clear color
 // Setup our OpenGL State machine
 // Then render the scene
@@ -62,10 +304,102 @@ void Renderer::Render(){
     // Nice way to debug your scene in wireframe!
     //glPolygonMode(GL_FRONT_AND_BACK,GL_LINE);
     
-    // Now we render our objects from our scenegraph
-    if(m_root!=nullptr){
-        m_root->Draw();
+    // Make every node's model matrix, and which node each
+    // instance is, available to the vertex shader
+    m_modelMatrices.Bind(MODEL_MATRIX_TEXTURE_SLOT);
+    m_instanceBuffer.Bind(INSTANCE_INDEX_TEXTURE_SLOT);
+
+    // We do not know what was left bound before this frame, so
+    // pick an id that never matches and bind everything once.
+    m_boundProgram = UNKNOWN_ID;
+    m_boundVertexArray = UNKNOWN_ID;
+    m_boundTexture = UNKNOWN_ID;
+    m_stateChanges = 0;
+    m_skippedStateChanges = 0;
+
+    if(m_usingIndirect){
+        // One call per bucket draws all of its batches, each reading
+        // its object indices from the instance buffer.
+        m_indirectBuffer.Bind();
+        for(unsigned int b=0; b < m_buckets.size(); ++b){
+            const DrawBucket& bucket = m_buckets[b];
+            BindProgram(*bucket.node->m_shader);
+            BindVertexArray(bucket.vertexArray);
+            BindTexture(bucket.node->GetObject()->GetDiffuseTextureID());
+            bucket.node->DrawIndirect(bucket.firstCommand, bucket.commandCount);
+        }
+        m_indirectBuffer.Unbind();
+        return;
+    }
+
+    // Now we render our objects from our scenegraph, using the
+    // batches built in Update, in the order of the render queue.
+    // Only what differs from the previous draw is bound.
+    const std::vector<RenderQueue::Item>& items = m_renderQueue.GetItems();
+    for(unsigned int i=0; i < items.size(); ++i){
+        const DrawBatch& batch = m_batches[items[i].value];
+        Object* object = batch.node->GetObject();
+        BindProgram(*batch.node->m_shader);
+        BindVertexArray(object->GetVertexArrayID());
+        BindTexture(object->GetDiffuseTextureID());
+        batch.node->DrawInstances(batch.firstInstance, batch.instanceCount);
+    }
+}
+
+// Counts the nodes in [begin, end) of the scene tree that have an object
+static unsigned int CountObjects(unsigned int begin, unsigned int end){
+    SceneTree& tree = SceneTree::Instance();
+    unsigned int count = 0;
+    for(unsigned int i = begin; i < end; ++i){
+        if(tree.GetNode(i)->HasObject()){
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Gathers the objects in a chunk that the camera can see
+void Renderer::CullChunk(unsigned int chunk){
+    SceneTree& tree = SceneTree::Instance();
+    const SceneTree::Chunk& c = tree.GetChunk(chunk);
+    std::vector<DrawCommand>& commands = m_chunkCommands[chunk];
+    commands.clear();
+    unsigned int culled = 0;
+
+    // If a serial chunk above us was hidden, so are we
+    int parent = tree.GetParent(c.begin);
+    bool parentHidden = c.begin != tree.GetIndex(m_root->GetID()) &&
+                        parent >= 0 && m_hiddenSubtrees[parent];
+    if(c.serial){
+        // Remember for the chunks below this one
+        m_hiddenSubtrees[c.begin] = parentHidden ||
+            !m_frustum.IsVisible(tree.GetSubtreeBounds(c.begin));
+    }
+    if(parentHidden){
+        m_chunkCulledCounts[chunk] = CountObjects(c.begin, c.end);
+        return;
+    }
+
+    unsigned int i = c.begin;
+    while(i < c.end){
+        // When everything below a node is off-screen, skip all of it
+        if(!m_frustum.IsVisible(tree.GetSubtreeBounds(i))){
+            unsigned int skipTo = std::min(tree.GetSubtreeEnd(i), c.end);
+            culled += CountObjects(i, skipTo);
+            i = skipTo;
+            continue;
+        }
+        SceneNode* node = tree.GetNode(i);
+        if(node->HasObject()){
+            if(m_frustum.IsVisible(tree.GetWorldBounds(i))){
+                commands.push_back(DrawCommand{node, i});
+            }else{
+                ++culled;
+            }
+        }
+        ++i;
     }
+    m_chunkCulledCounts[chunk] = culled;
 }
 
 // Determines what the root is of the renderer, so the
@@ -1,7 +1,13 @@
 #include "SDLGraphicsProgram.hpp"
 #include "Camera.hpp"
+#include "GeometryArena.hpp"
+#include "MeshRegistry.hpp"
 #include "Sphere.hpp"
+#include "SceneTree.hpp"
+#include "ShaderManager.hpp"
 #include "Terrain.hpp"
+#include "TextureCache.hpp"
+#include "VertexArrayCache.hpp"
 
 #include <fstream>
 #include <iostream>
@@ -92,6 +98,13 @@ SDLGraphicsProgram::~SDLGraphicsProgram() {
   if (m_renderer != nullptr) {
     delete m_renderer;
   }
+  // Release our shaders while the OpenGL context still exists
+  ShaderManager::Instance().RemoveAll();
+  // and our meshes' buffers and vertex arrays
+  GeometryArena::Instance().RemoveAll();
+  VertexArrayCache::Instance().RemoveAll();
+  // Stop our worker threads
+  JobSystem::Instance().Shutdown();
 
   // Destroy window
   SDL_DestroyWindow(m_window);
@@ -216,6 +229,17 @@ void SDLGraphicsProgram::Loop() {
   sphere->LoadTexture("sun.ppm");
   Sun = new SceneNode(sphere);
 
+  // Each file is only loaded once, no matter how many spheres use it.
+  SDL_Log("Unique textures loaded: %u (rock.ppm shared by %ld spheres)",
+          TextureCache::Instance().GetTextureCount(),
+          TextureCache::Instance().GetReferenceCount("rock.ppm"));
+  // Every sphere has the same bands, so they all share one mesh.
+  SDL_Log("Unique meshes loaded: %u (%u bytes on the GPU)",
+          MeshRegistry::Instance().GetMeshCount(),
+          MeshRegistry::Instance().GetSizeInBytes());
+  SDL_Log("Shader programs linked: %u",
+          ShaderManager::Instance().GetProgramCount());
+
   // Render our scene starting from the sun.
   m_renderer->setRoot(Sun);
   // Make the Earth a child of the Sun
@@ -286,6 +310,16 @@ void SDLGraphicsProgram::Loop() {
         case SDLK_RCTRL:
           m_renderer->GetCamera(0)->MoveDown(cameraSpeed);
           break;
+        case SDLK_i:
+          // Switch between a draw call per batch and one indirect
+          // multi-draw per shader, mesh buffer and texture
+          m_renderer->SetIndirectDrawing(!m_renderer->IsIndirectDrawing());
+          SDL_Log("Indirect drawing: %s",
+                  m_renderer->IsIndirectDrawing()
+                      ? "on"
+                      : (IndirectDraw::IsSupported() ? "off"
+                                                     : "not supported"));
+          break;
         }
         break;
       }
@@ -392,6 +426,19 @@ void SDLGraphicsProgram::Loop() {
     m_renderer->Update();
     // Render our scene using our selected renderer
     m_renderer->Render();
+    // Every so often, report how much of the scene actually moved
+    static unsigned int frameCount = 0;
+    if (++frameCount % 100 == 0) {
+      SDL_Log("World transforms recomputed: %u of %u nodes",
+              SceneTree::Instance().GetRecomputedCount(),
+              SceneTree::Instance().GetVisitedCount());
+      SDL_Log("Objects drawn: %u in %u draw calls, objects culled: %u",
+              m_renderer->GetDrawnCount(), m_renderer->GetDrawCallCount(),
+              m_renderer->GetCulledCount());
+      SDL_Log("State changes: %u, redundant binds skipped: %u",
+              m_renderer->GetStateChangeCount(),
+              m_renderer->GetSkippedStateChangeCount());
+    }
     // Delay to slow things down just a bit!
     SDL_Delay(35); // TODO: You can change this or implement a frame
                    // independent movement method if you like.
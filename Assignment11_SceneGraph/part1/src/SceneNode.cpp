@@ -1,4 +1,7 @@
 #include "SceneNode.hpp"
+#include "FrameUniforms.hpp"
+#include "IndirectDraw.hpp"
+#include "ShaderManager.hpp"
 
 #include <iostream>
 #include <string>
@@ -11,102 +14,94 @@ SceneNode::SceneNode(Object *ob) {
   // at the time of construction of this node.
   // If the SceneNode is the root of the tree,
   // then there is no parent.
-  m_parent = nullptr;
+  m_id = SceneTree::Instance().CreateNode(this);
+  // Objects that are not drawn need no bounds
+  if (m_object != nullptr) {
+    SceneTree::Instance().SetLocalBounds(m_id, m_object->GetBoundingSphere());
+  }
 
   // Setup shaders for the node.
-  std::string vertexShader = m_shader.LoadShader("./shaders/vert.glsl");
-  std::string fragmentShader = m_shader.LoadShader("./shaders/frag.glsl");
-  // Actually create our shader
-  m_shader.CreateShader(vertexShader, fragmentShader);
+  // Every node uses the same shader files, so they all share one
+  // program, which is only compiled for the first node. Objects in
+  // the compact vertex format need a vertex shader that unpacks it.
+  bool compact = m_object != nullptr &&
+                 m_object->GetVertexFormat() == VertexFormat::Compact;
+  m_shader = ShaderManager::Instance().LoadShader(
+      compact ? "./shaders/vert_compact.glsl" : "./shaders/vert.glsl",
+      "./shaders/frag.glsl");
+
+  // The camera and light come from the per frame uniform buffer, and
+  // the texture slots never change, so these only need setting once.
+  m_shader->Bind();
+  m_shader->BindUniformBlock("FrameData", FRAME_DATA_BINDING);
+  // Note that we set the diffuse map to 0, because each object
+  // binds its texture to slot 0.
+  m_shader->SetUniform(m_shader->GetUniformHandle<int>("u_DiffuseMap"), 0);
+  m_shader->SetUniform(m_shader->GetUniformHandle<int>("u_ModelMatrices"),
+                       (int)MODEL_MATRIX_TEXTURE_SLOT);
+  m_shader->SetUniform(m_shader->GetUniformHandle<int>("u_InstanceIndices"),
+                       (int)INSTANCE_INDEX_TEXTURE_SLOT);
+  // Find our per draw uniform once, rather than by name every frame.
+  m_instanceBaseUniform = m_shader->GetUniformHandle<int>("u_InstanceBase");
 }
 
 // The destructor
 SceneNode::~SceneNode() {
-  // Remove each object
-  for (unsigned int i = 0; i < m_children.size(); ++i) {
-    delete m_children[i];
+  SceneTree &tree = SceneTree::Instance();
+  // Remove each object (copying the ids first, since
+  // deleting a child removes it from our list).
+  std::vector<unsigned int> children = tree.GetChildren(m_id);
+  for (unsigned int i = 0; i < children.size(); ++i) {
+    delete tree.GetNodeFromID(children[i]);
   }
+  tree.DestroyNode(m_id);
 }
 
 // Adds a child node to our current node.
 void SceneNode::AddChild(SceneNode *n) {
   // For the node we have added, we can set
   // it's parent now to our current node.
-  // 'this' is the current instance of our
-  // object, which is a pointer to our current
-  // SceneNode.
-  n->m_parent = this;
-  // Add a child node into our SceneNode
-  m_children.push_back(n);
+  SceneTree::Instance().SetParent(n->m_id, m_id);
 }
 
-// Draw simply draws the current nodes
-// object and all of its children. This is done by calling directly
-// the objects draw method.
-void SceneNode::Draw() {
-  // Bind the shader for this node or series of nodes
-  m_shader.Bind();
-  // Render our object
-  if (m_object != nullptr) {
-    // Render our object
-    m_object->Render();
-    // For any 'child nodes' also call the drawing routine.
-    for (int i = 0; i < m_children.size(); ++i) {
-      m_children[i]->Draw();
-    }
-  }
+void SceneNode::DrawInstances(unsigned int firstInstance,
+                              unsigned int instanceCount) {
+  // The program is shared with other nodes, so we select where
+  // our instances are stored right before we draw.
+  m_shader->SetUniform(m_instanceBaseUniform, (int)firstInstance);
+  // Render our object. Its mesh shares the vertex and index buffer
+  // with others (see GeometryArena), so start at its first index and
+  // offset every index by its base vertex.
+  glDrawElementsInstancedBaseVertex(
+      GL_TRIANGLES,
+      m_object->GetIndexCount(), // The number of indices
+      GL_UNSIGNED_INT,
+      (char *)(sizeof(unsigned int) * m_object->GetFirstIndex()),
+      instanceCount, m_object->GetBaseVertex());
 }
 
-// Update simply updates the current nodes
-// object. This is done by calling directly
-// the objects update method.
-// TODO: Consider not passting projection and camera here
-void SceneNode::Update(glm::mat4 projectionMatrix, Camera *camera) {
-  if (m_object != nullptr) {
-    // TODO: Implement here!
-    if (m_parent != nullptr) {
-      // Combine parent's world transform with this node's local transform
-      m_worldTransform = m_parent->GetWorldTransform() * GetLocalTransform();
-
-    } else {
-      // If no parent, world transform is the local transform
-      m_worldTransform = GetLocalTransform();
-    }
-
-    // Now apply our shader
-    m_shader.Bind();
-    // Set the uniforms in our current shader
-
-    // For our object, we apply the texture in the following way
-    // Note that we set the value to 0, because we have bound
-    // our texture to slot 0.
-    m_shader.SetUniform1i("u_DiffuseMap", 0);
-    // Set the MVP Matrix for our object
-    // Send it into our shader
-    m_shader.SetUniformMatrix4fv("model",
-                                 &m_worldTransform.GetInternalMatrix()[0][0]);
-    m_shader.SetUniformMatrix4fv("view", &camera->GetWorldToViewmatrix()[0][0]);
-    m_shader.SetUniformMatrix4fv("projection", &projectionMatrix[0][0]);
-
-    // Create a 'light'
-    m_shader.SetUniform3f("lightColor", 1.0f, 1.0f, 1.0f);
-    m_shader.SetUniform3f(
-        "lightPos", camera->GetEyeXPosition() + camera->GetViewXDirection(),
-        camera->GetEyeYPosition() + camera->GetViewYDirection(),
-        camera->GetEyeZPosition() + camera->GetViewZDirection());
-    m_shader.SetUniform1f("ambientIntensity", 0.5f);
-
-    // Iterate through all of the children
-    for (int i = 0; i < m_children.size(); ++i) {
-      m_children[i]->Update(projectionMatrix, camera);
-    }
-  }
+void SceneNode::DrawIndirect(unsigned int first, unsigned int drawCount) {
+  // Each command has its own first instance, which a uniform cannot
+  // follow. -1 tells the shader to read each instance's object index
+  // from its instance attribute instead, which the GPU offsets by the
+  // command's base instance.
+  m_shader->SetUniform(m_instanceBaseUniform, -1);
+  IndirectDraw::MultiDrawElements(GL_TRIANGLES, first, drawCount);
 }
 
+// Update computes the world transform of the current node
+// and all of its children, in one pass over the SceneTree.
+// The camera and light are shared by every node, so the
+// Renderer sets them once per frame instead.
+void SceneNode::Update() { SceneTree::Instance().Update(m_id); }
+
 // Returns the actual local transform stored in our SceneNode
 // which can then be modified
-Transform &SceneNode::GetLocalTransform() { return m_localTransform; }
+Transform &SceneNode::GetLocalTransform() {
+  return SceneTree::Instance().GetLocalTransform(m_id);
+}
 
-// Returns the worled  transform stored in our SceneNode
-// which can then be modified
-Transform &SceneNode::GetWorldTransform() { return m_worldTransform; }
\ No newline at end of file
+// Returns the world transform computed by the last Update
+const glm::mat4 &SceneNode::GetWorldMatrix() {
+  return SceneTree::Instance().GetWorldMatrix(m_id);
+}
@@ -0,0 +1,266 @@
+#include "SceneTree.hpp"
+
+#include <algorithm>
+
+// Marks an id that no longer has an entry in the arrays
+static const unsigned int REMOVED_INDEX = 0xFFFFFFFF;
+
+// Constructor
+SceneTree::SceneTree() {}
+
+// Destructor
+SceneTree::~SceneTree() {}
+
+unsigned int SceneTree::CreateNode(SceneNode *node) {
+  unsigned int id = m_indices.size();
+  // New nodes have no parent, so they can go at the end
+  // of the arrays without breaking the sorted order.
+  m_indices.push_back(m_nodes.size());
+  m_parentIds.push_back(-1);
+  m_childIds.push_back(std::vector<unsigned int>());
+
+  m_localTransforms.push_back(Transform());
+  m_worldMatrices.push_back(glm::mat4(1.0f));
+  m_parents.push_back(-1);
+  m_subtreeEnds.push_back(m_nodes.size() + 1);
+  m_worldChanged.push_back(0);
+  m_localBounds.push_back(BoundingSphere());
+  m_worldBounds.push_back(BoundingSphere());
+  m_subtreeBounds.push_back(BoundingSphere());
+  m_nodes.push_back(node);
+  return id;
+}
+
+void SceneTree::DestroyNode(unsigned int id) {
+  // Detach ourselves from our parent
+  if (m_parentIds[id] >= 0) {
+    std::vector<unsigned int> &siblings = m_childIds[m_parentIds[id]];
+    siblings.erase(std::find(siblings.begin(), siblings.end(), id));
+  }
+  // Any remaining children become root nodes
+  for (unsigned int child : m_childIds[id]) {
+    m_parentIds[child] = -1;
+    m_localTransforms[m_indices[child]].MarkDirty();
+  }
+  m_childIds[id].clear();
+  m_parentIds[id] = -1;
+  // Our entry is dropped the next time the arrays are sorted
+  m_nodes[m_indices[id]] = nullptr;
+  m_indices[id] = REMOVED_INDEX;
+  m_needsSort = true;
+}
+
+void SceneTree::SetParent(unsigned int child, unsigned int parent) {
+  if (m_parentIds[child] >= 0) {
+    std::vector<unsigned int> &siblings = m_childIds[m_parentIds[child]];
+    siblings.erase(std::find(siblings.begin(), siblings.end(), child));
+  }
+  m_parentIds[child] = parent;
+  m_childIds[parent].push_back(child);
+  // Our world transform now depends on a different parent
+  m_localTransforms[m_indices[child]].MarkDirty();
+  // Indices stay valid until the next Sort, so the local transforms
+  // can still be modified before then.
+  m_needsSort = true;
+}
+
+// Rebuilds the arrays in depth first order. Only happens when the
+// hierarchy changes, which is rare compared to updating transforms.
+void SceneTree::Sort() {
+  if (!m_needsSort) {
+    return;
+  }
+  m_needsSort = false;
+
+  std::vector<Transform> localTransforms;
+  std::vector<glm::mat4> worldMatrices;
+  std::vector<int> parents;
+  std::vector<unsigned int> subtreeEnds;
+  std::vector<SceneNode *> nodes;
+  std::vector<BoundingSphere> localBounds;
+  std::vector<BoundingSphere> worldBounds;
+  localTransforms.reserve(m_nodes.size());
+  worldMatrices.reserve(m_nodes.size());
+  parents.reserve(m_nodes.size());
+  subtreeEnds.reserve(m_nodes.size());
+  nodes.reserve(m_nodes.size());
+  localBounds.reserve(m_nodes.size());
+  worldBounds.reserve(m_nodes.size());
+
+  // Walk each root depth first with our own stack (rather than
+  // recursion, so very deep trees cannot overflow the call stack).
+  // Each entry is an id, and the index of its parent in the new arrays.
+  std::vector<std::pair<unsigned int, int>> stack;
+  for (unsigned int root = 0; root < m_indices.size(); ++root) {
+    if (m_parentIds[root] >= 0 || m_indices[root] == REMOVED_INDEX) {
+      continue;
+    }
+    stack.push_back(std::make_pair(root, -1));
+    while (!stack.empty()) {
+      unsigned int id = stack.back().first;
+      int parent = stack.back().second;
+      stack.pop_back();
+
+      unsigned int oldIndex = m_indices[id];
+      unsigned int newIndex = nodes.size();
+      m_indices[id] = newIndex;
+      localTransforms.push_back(m_localTransforms[oldIndex]);
+      worldMatrices.push_back(m_worldMatrices[oldIndex]);
+      parents.push_back(parent);
+      subtreeEnds.push_back(newIndex + 1);
+      nodes.push_back(m_nodes[oldIndex]);
+      localBounds.push_back(m_localBounds[oldIndex]);
+      worldBounds.push_back(m_worldBounds[oldIndex]);
+
+      // Push in reverse, so the first child is visited first
+      const std::vector<unsigned int> &children = m_childIds[id];
+      for (int i = (int)children.size() - 1; i >= 0; --i) {
+        stack.push_back(std::make_pair(children[i], (int)newIndex));
+      }
+    }
+  }
+  // A node's subtree ends where the subtree of its last descendent
+  // ends. Children come after their parents, so walking backwards
+  // finishes each child before its parent reads it.
+  for (int i = (int)nodes.size() - 1; i >= 0; --i) {
+    if (parents[i] >= 0) {
+      subtreeEnds[parents[i]] =
+          std::max(subtreeEnds[parents[i]], subtreeEnds[i]);
+    }
+  }
+
+  m_localTransforms.swap(localTransforms);
+  m_worldMatrices.swap(worldMatrices);
+  m_parents.swap(parents);
+  m_subtreeEnds.swap(subtreeEnds);
+  m_nodes.swap(nodes);
+  m_localBounds.swap(localBounds);
+  m_worldBounds.swap(worldBounds);
+  m_subtreeBounds.assign(m_nodes.size(), BoundingSphere());
+  m_worldChanged.assign(m_nodes.size(), 0);
+}
+
+// Computes world transforms in one pass over the arrays.
+// Every parent comes before its children, so a parent's world
+// matrix is always ready by the time its children read it.
+// A node is recomputed when its local transform is dirty, or when
+// its parent was recomputed, so unchanged subtrees are skipped.
+unsigned int SceneTree::UpdateRange(unsigned int begin, unsigned int end,
+                                    bool parentUpdated) {
+  unsigned int recomputed = 0;
+  for (unsigned int i = begin; i < end; ++i) {
+    int parent = m_parents[i];
+    bool parentChanged =
+        parent >= 0 && (i != begin || parentUpdated) && m_worldChanged[parent];
+    if (!parentChanged && !m_localTransforms[i].IsDirty()) {
+      m_worldChanged[i] = 0;
+      m_subtreeBounds[i] = m_worldBounds[i];
+      continue;
+    }
+    if (parent >= 0) {
+      m_worldMatrices[i] =
+          m_worldMatrices[parent] * m_localTransforms[i].GetInternalMatrix();
+    } else {
+      m_worldMatrices[i] = m_localTransforms[i].GetInternalMatrix();
+    }
+    m_worldBounds[i] = m_localBounds[i].Transformed(m_worldMatrices[i]);
+    m_subtreeBounds[i] = m_worldBounds[i];
+    m_localTransforms[i].ClearDirty();
+    m_worldChanged[i] = 1;
+    ++recomputed;
+  }
+  // Grow each parent's subtree bounds to enclose its children.
+  // Walking backwards finishes every child before its parent.
+  for (unsigned int i = end - 1; i > begin; --i) {
+    m_subtreeBounds[m_parents[i]].Merge(m_subtreeBounds[i]);
+  }
+  return recomputed;
+}
+
+void SceneTree::Update(unsigned int id) {
+  Sort();
+  unsigned int first = m_indices[id];
+  unsigned int end = m_subtreeEnds[first];
+  m_visitedCount = end - first;
+  // The first node is the top of the subtree we are updating,
+  // so its parent is not part of this update.
+  m_recomputedCount = UpdateRange(first, end, false);
+}
+
+unsigned int SceneTree::SplitIntoChunks(unsigned int id,
+                                        unsigned int chunkSize) {
+  Sort();
+  m_chunks.clear();
+  m_chunksFirst = m_indices[id];
+  m_visitedCount = m_subtreeEnds[m_chunksFirst] - m_chunksFirst;
+  m_recomputedCount = 0;
+
+  // Walk down the tree depth first, stopping at the first
+  // subtree on each path that is small enough to be a chunk.
+  std::vector<unsigned int> stack;
+  stack.push_back(m_chunksFirst);
+  while (!stack.empty()) {
+    unsigned int index = stack.back();
+    stack.pop_back();
+    unsigned int end = m_subtreeEnds[index];
+    if (end - index <= chunkSize) {
+      m_chunks.push_back(Chunk{index, end, false});
+      continue;
+    }
+    // Too big, so this node is done by itself, followed by its children
+    m_chunks.push_back(Chunk{index, index + 1, true});
+    std::vector<unsigned int>::size_type firstChild = stack.size();
+    for (unsigned int child = index + 1; child < end;
+         child = m_subtreeEnds[child]) {
+      stack.push_back(child);
+    }
+    // Reverse them, so the first child is visited first
+    std::reverse(stack.begin() + firstChild, stack.end());
+  }
+  return m_chunks.size();
+}
+
+void SceneTree::UpdateChunk(unsigned int chunk) {
+  const Chunk &c = m_chunks[chunk];
+  m_recomputedCount += UpdateRange(c.begin, c.end, c.begin != m_chunksFirst);
+}
+
+void SceneTree::MergeChunkBounds() {
+  // Serial chunks are parents of the chunks after them,
+  // so go backwards to finish the children first.
+  for (int chunk = (int)m_chunks.size() - 1; chunk >= 0; --chunk) {
+    if (!m_chunks[chunk].serial) {
+      continue;
+    }
+    unsigned int index = m_chunks[chunk].begin;
+    unsigned int end = m_subtreeEnds[index];
+    for (unsigned int child = index + 1; child < end;
+         child = m_subtreeEnds[child]) {
+      m_subtreeBounds[index].Merge(m_subtreeBounds[child]);
+    }
+  }
+}
+
+Transform &SceneTree::GetLocalTransform(unsigned int id) {
+  return m_localTransforms[m_indices[id]];
+}
+
+const glm::mat4 &SceneTree::GetWorldMatrix(unsigned int id) {
+  return m_worldMatrices[m_indices[id]];
+}
+
+void SceneTree::SetLocalBounds(unsigned int id, const BoundingSphere &bounds) {
+  m_localBounds[m_indices[id]] = bounds;
+  // Make sure the world bounds are recomputed
+  m_localTransforms[m_indices[id]].MarkDirty();
+}
+
+const std::vector<unsigned int> &
+SceneTree::GetChildren(unsigned int id) const {
+  return m_childIds[id];
+}
+
+unsigned int SceneTree::GetIndex(unsigned int id) {
+  Sort();
+  return m_indices[id];
+}
@@ -3,24 +3,36 @@
 #include <iostream>
 #include <fstream>
 
+// Many objects share the same shader, so we remember which
+// program is in use and skip redundant calls to glUseProgram.
+GLuint Shader::s_boundShaderID = 0;
+
 // Constructor
 Shader::Shader(){}
 
 // Destructor
 Shader::~Shader(){
+	// The id may be reused by a new program, so forget it.
+	if(s_boundShaderID == m_shaderID){
+		s_boundShaderID = 0;
+	}
 	// Deallocate Program
 	glDeleteProgram(m_shaderID);
 }
 
 // Use our shader
 void Shader::Bind() const{
-	glUseProgram(m_shaderID);
+	if(s_boundShaderID != m_shaderID){
+		glUseProgram(m_shaderID);
+		s_boundShaderID = m_shaderID;
+	}
 }
 
 
 // Turns off our shader
 void Shader::Unbind() const{
 	glUseProgram(0);
+	s_boundShaderID = 0;
 }
 
 void Shader::Log(const char* system, const char* message){
@@ -77,6 +89,51 @@ void Shader::CreateShader(const std::string& vertexShaderSource, const std::stri
     }
 
     m_shaderID = program;
+
+    // Look up all of our uniforms once, so setting them
+    // every frame does not need to ask OpenGL.
+    ReflectUniforms();
+}
+
+// Queries every active uniform in the program and stores its
+// location. Arrays are stored both by their base name and by
+// each element (i.e. 'lights', 'lights[0]', 'lights[1]', ...).
+void Shader::ReflectUniforms(){
+    m_uniformLocations.clear();
+
+    GLint uniformCount = 0;
+    glGetProgramiv(m_shaderID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    GLint maxNameLength = 0;
+    glGetProgramiv(m_shaderID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    if(uniformCount <= 0 || maxNameLength <= 0){
+        return;
+    }
+
+    std::string name(maxNameLength, '\0');
+    for(GLint i = 0; i < uniformCount; ++i){
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_shaderID, i, maxNameLength, &length, &size, &type, &name[0]);
+        std::string uniformName = name.substr(0, length);
+        GLint location = glGetUniformLocation(m_shaderID, uniformName.c_str());
+        // Uniforms inside of a uniform block do not have a location.
+        if(location < 0){
+            continue;
+        }
+        m_uniformLocations[uniformName] = location;
+
+        // Arrays are reported as 'name[0]'
+        std::string::size_type bracket = uniformName.rfind("[0]");
+        if(bracket != std::string::npos && bracket + 3 == uniformName.size()){
+            std::string baseName = uniformName.substr(0, bracket);
+            m_uniformLocations[baseName] = location;
+            for(GLint element = 1; element < size; ++element){
+                std::string elementName = baseName + "[" + std::to_string(element) + "]";
+                m_uniformLocations[elementName] = glGetUniformLocation(m_shaderID, elementName.c_str());
+            }
+        }
+    }
 }
 
 
@@ -149,11 +206,21 @@ GLuint Shader::GetID() const{
 }
 
 
+// Returns the location of a uniform from the table built when
+// the shader was linked. -1 is silently ignored by glUniform*.
+GLint Shader::GetUniformLocation(const GLchar* name) const{
+    auto it = m_uniformLocations.find(name);
+    if(it == m_uniformLocations.end()){
+        return -1;
+    }
+    return it->second;
+}
+
 // Set our uniforms for our shader.
 void Shader::SetUniformMatrix4fv(const GLchar* name, const GLfloat* value){
     // Note that we are now 'looking' inside the shader for a particular
     // variable. This means the name has to exactly match!
-    GLint location = glGetUniformLocation(m_shaderID,name);
+    GLint location = GetUniformLocation(name);
 
     // Now update this information through our uniforms.
     // glUniformMatrix4v means a 4x4 matrix of floats
@@ -162,18 +229,46 @@ void Shader::SetUniformMatrix4fv(const GLchar* name, const GLfloat* value){
 
 // Set our uniforms for our shader (Useful for a vec3).
 void Shader::SetUniform3f(const GLchar* name, float v0, float v1, float v2){
-    GLint location = glGetUniformLocation(m_shaderID,name);
+    GLint location = GetUniformLocation(name);
     glUniform3f(location, v0, v1, v2);
 }
 
 // Sets 1 int value in our uniform (That is why the suffix is 1i).
 void Shader::SetUniform1i(const GLchar* name, int value){
-    GLint location = glGetUniformLocation(m_shaderID,name);
+    GLint location = GetUniformLocation(name);
     glUniform1i(location, value);
 }
 
 // Sets 1 float value in our uniform (That is why the suffix is 1f).
 void Shader::SetUniform1f(const GLchar* name, float value){
-    GLint location = glGetUniformLocation(m_shaderID,name);
+    GLint location = GetUniformLocation(name);
     glUniform1f(location, value);
 }
+
+// The handle versions skip the name lookup entirely.
+void Shader::SetUniform(UniformHandle<glm::mat4> handle, const glm::mat4& value){
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, &value[0][0]);
+}
+
+void Shader::SetUniform(UniformHandle<glm::vec3> handle, const glm::vec3& value){
+    glUniform3f(handle.location, value.x, value.y, value.z);
+}
+
+void Shader::SetUniform(UniformHandle<int> handle, int value){
+    glUniform1i(handle.location, value);
+}
+
+void Shader::SetUniform(UniformHandle<float> handle, float value){
+    glUniform1f(handle.location, value);
+}
+
+// Connects a uniform block (e.g. 'FrameData') to the uniform buffer
+// attached at 'bindingPoint'. Does nothing if the shader has no
+// active block with that name.
+void Shader::BindUniformBlock(const GLchar* blockName, GLuint bindingPoint){
+    GLuint blockIndex = glGetUniformBlockIndex(m_shaderID, blockName);
+    if(blockIndex == GL_INVALID_INDEX){
+        return;
+    }
+    glUniformBlockBinding(m_shaderID, blockIndex, bindingPoint);
+}
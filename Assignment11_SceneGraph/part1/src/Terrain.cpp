@@ -43,6 +43,10 @@ Terrain::~Terrain(){
 // http://www.learnopengles.com/wordpress/wp-content/uploads/2012/05/vbo.png
 // of what we are trying to do.
 void Terrain::Init(){
+    // Every terrain has its own heights, so it gets its own mesh
+    m_mesh = std::make_shared<Mesh>();
+    // The grid goes into m_mesh->GetGeometry()
+
     // Create the initial grid of vertices.
 
     // TODO: (Inclass) Build grid of vertices! 
@@ -71,16 +75,12 @@ void Terrain::Init(){
 
 
    // Finally generate a simple 'array of bytes' that contains
-   // everything for our buffer to work with.
-   m_geometry.Gen();  
-   // Create a buffer and set the stride of information
-   m_vertexBufferLayout.CreateNormalBufferLayout(m_geometry.GetBufferDataSize(),
-                                        m_geometry.GetIndicesSize(),
-                                        m_geometry.GetBufferDataPtr(),
-                                        m_geometry.GetIndicesDataPtr());
+   // everything for our buffer to work with, and create
+   // a buffer and set the stride of information.
+   m_mesh->Upload();
 }
 
 // Loads an image and uses it to set the heights of the terrain.
-void Terrain::LoadHeightMap(Image image){
+void Terrain::LoadHeightMap(Image &image){
 
 }
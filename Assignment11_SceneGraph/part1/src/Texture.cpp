@@ -1,6 +1,7 @@
 #include <SDL2/SDL.h>
 
 #include "Texture.hpp"
+#include "Image.hpp"
 
 #include <stdio.h>
 #include <string.h>
@@ -18,11 +19,6 @@ Texture::Texture() {}
 Texture::~Texture() {
   // Delete our texture from the GPU
   glDeleteTextures(1, &m_textureID);
-
-  // Delete our image
-  if (m_image != nullptr) {
-    delete m_image;
-  }
 }
 
 void Texture::LoadTexture(const std::string filepath) {
@@ -30,8 +26,11 @@ void Texture::LoadTexture(const std::string filepath) {
   m_filepath = filepath;
   // Load our actual image data
   // This method loads .ppm files of pixel data
-  m_image = new Image(filepath);
-  m_image->LoadPPM(true);
+  // The image only needs to live until it has been
+  // uploaded to the GPU, so it is released at the end
+  // of this function.
+  Image image(filepath);
+  image.LoadPPM(true);
 
   glEnable(GL_TEXTURE_2D);
   // Generate a buffer for our texture
@@ -51,9 +50,9 @@ void Texture::LoadTexture(const std::string filepath) {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   // At this point, we are now ready to load and send some data to OpenGL.
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_image->GetWidth(),
-               m_image->GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE,
-               m_image->GetPixelDataPtr()); // Here is the raw pixel data
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.GetWidth(),
+               image.GetHeight(), 0, GL_RGB, GL_UNSIGNED_BYTE,
+               image.GetPixelDataPtr()); // Here is the raw pixel data
   // We are done with our texture data so we can unbind.
   // Generate a mipmap
   glGenerateMipmap(GL_TEXTURE_2D);
@@ -0,0 +1,39 @@
+#include "TextureBuffer.hpp"
+
+// Constructor
+TextureBuffer::TextureBuffer(GLenum format) : m_format(format) {}
+
+// Destructor
+TextureBuffer::~TextureBuffer() {
+  glDeleteTextures(1, &m_textureID);
+  glDeleteBuffers(1, &m_bufferID);
+}
+
+// Upload all of our data at once.
+void TextureBuffer::Upload(const void *data, GLsizeiptr size) {
+  if (m_bufferID == 0) {
+    glGenBuffers(1, &m_bufferID);
+    glGenTextures(1, &m_textureID);
+  }
+  glBindBuffer(GL_TEXTURE_BUFFER, m_bufferID);
+  if (size > m_capacity) {
+    // Grow the buffer (with some room to spare), and tell
+    // our texture about the new storage
+    m_capacity = size + size / 2;
+    glBufferData(GL_TEXTURE_BUFFER, m_capacity, nullptr, GL_DYNAMIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, m_textureID);
+    glTexBuffer(GL_TEXTURE_BUFFER, m_format, m_bufferID);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+  }
+  if (size > 0) {
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+  }
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::Bind(unsigned int slot) const {
+  glActiveTexture(GL_TEXTURE0 + slot);
+  glBindTexture(GL_TEXTURE_BUFFER, m_textureID);
+  // Leave slot 0 active, which is what the rest of our code expects
+  glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,65 @@
+#include "TextureCache.hpp"
+
+#include <iostream>
+
+// Constructor is empty
+TextureCache::TextureCache() {}
+
+// Destructor is empty, the textures are
+// owned by the objects that use them.
+TextureCache::~TextureCache() {}
+
+TextureCache &TextureCache::Instance() {
+  static TextureCache *instance = new TextureCache();
+  return *instance;
+}
+
+// Returns a shared texture, only loading it
+// from disk if it is not already on the GPU.
+std::shared_ptr<Texture> TextureCache::Get(const std::string &filepath) {
+  auto it = m_textures.find(filepath);
+  if (it != m_textures.end()) {
+    // lock() returns nullptr if the texture was already deleted
+    std::shared_ptr<Texture> texture = it->second.lock();
+    if (texture != nullptr) {
+      return texture;
+    }
+  }
+
+  std::cout << "(TextureCache.cpp) Loading texture: " << filepath << "\n";
+  std::shared_ptr<Texture> texture = std::make_shared<Texture>();
+  texture->LoadTexture(filepath);
+  m_textures[filepath] = texture;
+
+  // Good time to forget about textures that are no longer used
+  RemoveExpired();
+  return texture;
+}
+
+long TextureCache::GetReferenceCount(const std::string &filepath) const {
+  auto it = m_textures.find(filepath);
+  if (it == m_textures.end()) {
+    return 0;
+  }
+  return it->second.use_count();
+}
+
+unsigned int TextureCache::GetTextureCount() const {
+  unsigned int count = 0;
+  for (const auto &entry : m_textures) {
+    if (!entry.second.expired()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+void TextureCache::RemoveExpired() {
+  for (auto it = m_textures.begin(); it != m_textures.end();) {
+    if (it->second.expired()) {
+      it = m_textures.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
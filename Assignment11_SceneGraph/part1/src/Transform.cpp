@@ -13,6 +13,7 @@ Transform::~Transform(){
 // Resets the model transform as the identity matrix.
 void Transform::LoadIdentity(){
     m_modelTransformMatrix = glm::mat4(1.0f);
+    m_dirty = true;
 }
 
 void Transform::Translate(float x, float y, float z){
@@ -24,48 +25,58 @@ void Transform::Translate(float x, float y, float z){
         // We supply the first argument which is the matrix we want to apply
         // this transformation to (Our previous transformation matrix.
         m_modelTransformMatrix = glm::translate(m_modelTransformMatrix,glm::vec3(x,y,z));                            
+        m_dirty = true;
 }
 
 void Transform::Rotate(float radians, float x, float y, float z){
     m_modelTransformMatrix = glm::rotate(m_modelTransformMatrix, radians,glm::vec3(x,y,z));        
+    m_dirty = true;
 }
 
 void Transform::Scale(float x, float y, float z){
     m_modelTransformMatrix = glm::scale(m_modelTransformMatrix,glm::vec3(x,y,z));        
+    m_dirty = true;
 }
 
 // Returns the actual transform matrix
 // Useful for sending 
+// The matrix could be written through this pointer, so we
+// have to assume it changed.
 GLfloat* Transform::GetTransformMatrix(){
+    m_dirty = true;
     return &m_modelTransformMatrix[0][0];
 }
 
 
 // Get the raw internal matrix from the class
-glm::mat4 Transform::GetInternalMatrix() const{
+const glm::mat4& Transform::GetInternalMatrix() const{
     return m_modelTransformMatrix;
 }
 
 void Transform::ApplyTransform(Transform t){
     m_modelTransformMatrix = t.GetInternalMatrix();
+    m_dirty = true;
 }
 
 
 // Perform a matrix multiplication with our Transform
 Transform& Transform::operator*=(const Transform& t) {
     m_modelTransformMatrix =  m_modelTransformMatrix * t.GetInternalMatrix();
+    m_dirty = true;
     return *this;
 }
 
 // Perform a matrix addition with our Transform
 Transform& Transform::operator+=(const Transform& t) {
     m_modelTransformMatrix =  m_modelTransformMatrix + t.GetInternalMatrix();
+    m_dirty = true;
     return *this;
 }
 
 // Matrix assignment
 Transform& Transform::operator=(const Transform& t) {
     m_modelTransformMatrix =  t.GetInternalMatrix();
+    m_dirty = true;
     return *this;
 }
 
@@ -0,0 +1,32 @@
+#include "UniformBuffer.hpp"
+
+#include <iostream>
+
+// Constructor
+UniformBuffer::UniformBuffer() {}
+
+// Destructor
+UniformBuffer::~UniformBuffer() { glDeleteBuffers(1, &m_bufferID); }
+
+// Create our buffer and attach it to a binding point.
+// Any uniform block bound to the same point reads from this buffer.
+void UniformBuffer::Create(GLsizeiptr size, GLuint bindingPoint) {
+  m_size = size;
+  glGenBuffers(1, &m_bufferID);
+  glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+  // We update this buffer every frame
+  glBufferData(GL_UNIFORM_BUFFER, m_size, nullptr, GL_DYNAMIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, m_bufferID);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Upload new data into our buffer
+void UniformBuffer::Update(const void *data, GLsizeiptr size) {
+  if (size > m_size) {
+    std::cout << "(UniformBuffer.cpp) ERROR, update is larger than buffer\n";
+    return;
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
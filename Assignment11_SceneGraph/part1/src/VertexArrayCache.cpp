@@ -0,0 +1,142 @@
+#include "VertexArrayCache.hpp"
+
+#include <functional>
+
+// Constructor is empty
+VertexArrayCache::VertexArrayCache() {}
+
+// Destructor is empty, RemoveAll must be called while
+// there is still an OpenGL context to delete from.
+VertexArrayCache::~VertexArrayCache() {}
+
+VertexArrayCache &VertexArrayCache::Instance() {
+  static VertexArrayCache *instance = new VertexArrayCache();
+  return *instance;
+}
+
+std::size_t VertexArrayCache::KeyHash::operator()(const Key &key) const {
+  // Mixes each value in, as in boost::hash_combine
+  std::size_t hash = 0;
+  auto combine = [&hash](std::size_t value) {
+    hash ^= std::hash<std::size_t>()(value) + 0x9e3779b9 + (hash << 6) +
+            (hash >> 2);
+  };
+  combine(key.vertexBuffer);
+  combine(key.indexBuffer);
+  combine(key.instanceBuffer);
+  for (const VertexLayout *layout : {&key.layout, &key.instanceLayout}) {
+    combine(layout->stride);
+    for (unsigned int i = 0; i < layout->attributeCount; ++i) {
+      const VertexAttribute &attribute = layout->attributes[i];
+      combine(attribute.location);
+      combine(attribute.offset);
+      combine(attribute.type);
+    }
+  }
+  return hash;
+}
+
+GLuint VertexArrayCache::Get(const VertexLayout &layout, GLuint vertexBuffer,
+                             GLuint indexBuffer) {
+  return Get(Key{layout, vertexBuffer, indexBuffer, VertexLayout{0, 0, {}}, 0});
+}
+
+GLuint VertexArrayCache::Get(const VertexLayout &layout, GLuint vertexBuffer,
+                             GLuint indexBuffer,
+                             const VertexLayout &instanceLayout,
+                             GLuint instanceBuffer) {
+  return Get(
+      Key{layout, vertexBuffer, indexBuffer, instanceLayout, instanceBuffer});
+}
+
+GLuint VertexArrayCache::Get(const Key &key) {
+  auto it = m_vertexArrays.find(key);
+  if (it != m_vertexArrays.end()) {
+    return it->second;
+  }
+  GLuint vertexArray = Create(key);
+  m_vertexArrays.emplace(key, vertexArray);
+  return vertexArray;
+}
+
+// Records the layout of each attribute in a new vertex array
+GLuint VertexArrayCache::Create(const Key &key) {
+  GLuint vertexArray = 0;
+  glGenVertexArrays(1, &vertexArray);
+  glBindVertexArray(vertexArray);
+  // The vertex array remembers the index buffer bound while it is
+  // bound, but not the vertex buffer. glVertexAttribPointer reads
+  // the buffer bound to GL_ARRAY_BUFFER at the time it is called.
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, key.indexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, key.vertexBuffer);
+
+  SetAttributes(key.layout);
+  if (key.instanceBuffer != 0) {
+    glBindBuffer(GL_ARRAY_BUFFER, key.instanceBuffer);
+    SetAttributes(key.instanceLayout);
+  }
+  glBindVertexArray(0);
+  return vertexArray;
+}
+
+void VertexArrayCache::SetAttributes(const VertexLayout &layout) {
+  for (unsigned int i = 0; i < layout.attributeCount; ++i) {
+    const VertexAttribute &attribute = layout.attributes[i];
+    glEnableVertexAttribArray(attribute.location);
+    if (attribute.integer) {
+      // Note the 'I', which passes the bits to the shader as
+      // integers rather than converting them to floats.
+      glVertexAttribIPointer(attribute.location, attribute.components,
+                             attribute.type, layout.stride,
+                             (char *)(std::size_t)attribute.offset);
+    } else {
+      glVertexAttribPointer(
+          attribute.location,   // Attribute location, which will match
+                                // layout(location=...) in the shader
+          attribute.components, // size (Number of components (2=x,y)
+                                // (3=x,y,z), etc.)
+          attribute.type,       // Type of data
+          attribute.normalized, // Is the data normalized
+          layout.stride,        // Stride - Amount of bytes between each
+                                // vertex. If we only have positions,
+                                // then this is sizeof(float)*3. If we
+                                // add in normals (3 more floats), then
+                                // this becomes sizeof(float)*6, as we
+                                // move 6 floats to get to the next
+                                // vertex.
+          (char *)(std::size_t)attribute.offset // Pointer to the starting
+                                // point of our data. The first attribute
+                                // is usually at 0. If we had some data
+                                // after (say normals), then they would
+                                // have an offset of sizeof(float)*3 for
+                                // example.
+      );
+    }
+    // 0 advances the attribute every vertex, n every n instances
+    glVertexAttribDivisor(attribute.location, attribute.divisor);
+  }
+}
+
+void VertexArrayCache::Remove(GLuint buffer) {
+  for (auto it = m_vertexArrays.begin(); it != m_vertexArrays.end();) {
+    const Key &key = it->first;
+    if (key.vertexBuffer == buffer || key.indexBuffer == buffer ||
+        key.instanceBuffer == buffer) {
+      glDeleteVertexArrays(1, &it->second);
+      it = m_vertexArrays.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+unsigned int VertexArrayCache::GetVertexArrayCount() const {
+  return m_vertexArrays.size();
+}
+
+void VertexArrayCache::RemoveAll() {
+  for (auto &entry : m_vertexArrays) {
+    glDeleteVertexArrays(1, &entry.second);
+  }
+  m_vertexArrays.clear();
+}
@@ -0,0 +1,104 @@
+#include "VertexFormat.hpp"
+
+#include <cmath>
+
+#include "glm/gtc/packing.hpp"
+
+// -1 for negative numbers, otherwise 1 (so 0 folds the same way
+// in the encoder as in the shader)
+static glm::vec2 SignNotZero(const glm::vec2 &v) {
+  return glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+// Rounds 'value' (from -1 to 1) to a signed integer of 'bits' bits,
+// returned in the low bits of the result
+static uint32_t PackSnorm(float value, unsigned int bits) {
+  float scale = (float)((1u << (bits - 1)) - 1);
+  int quantized = (int)std::round(glm::clamp(value, -1.0f, 1.0f) * scale);
+  return (uint32_t)quantized & ((1u << bits) - 1);
+}
+
+// Reverses PackSnorm on the field of 'bits' bits starting at 'shift'
+static float UnpackSnorm(uint32_t packed, unsigned int shift,
+                         unsigned int bits) {
+  // Move the field to the top, then shift it back down keeping the sign
+  int quantized = (int32_t)(packed << (32 - shift - bits)) >> (32 - bits);
+  float scale = (float)((1u << (bits - 1)) - 1);
+  return glm::max(quantized / scale, -1.0f);
+}
+
+// Projects onto the octahedron |x| + |y| + |z| = 1, then unfolds the
+// lower half over the corners of the upper half's square.
+glm::vec2 VertexPacking::OctahedralEncode(const glm::vec3 &v) {
+  float length = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+  if (length == 0.0f) {
+    return glm::vec2(0.0f);
+  }
+  glm::vec2 p = glm::vec2(v.x, v.y) / length;
+  if (v.z < 0.0f) {
+    p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * SignNotZero(p);
+  }
+  return p;
+}
+
+glm::vec3 VertexPacking::OctahedralDecode(const glm::vec2 &e) {
+  glm::vec3 v(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+  // Fold the corners back under the octahedron
+  float t = glm::max(-v.z, 0.0f);
+  v.x += v.x >= 0.0f ? -t : t;
+  v.y += v.y >= 0.0f ? -t : t;
+  return glm::normalize(v);
+}
+
+uint32_t VertexPacking::PackTangentFrame(const glm::vec3 &normal,
+                                         const glm::vec3 &tangent,
+                                         const glm::vec3 &bitangent) {
+  glm::vec2 n = OctahedralEncode(normal);
+  glm::vec2 t = OctahedralEncode(tangent);
+  uint32_t frame = PackSnorm(n.x, 8) | PackSnorm(n.y, 8) << 8 |
+                   PackSnorm(t.x, 8) << 16 | PackSnorm(t.y, 7) << 24;
+  if (glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f) {
+    frame |= 1u << 31;
+  }
+  return frame;
+}
+
+// Note: this is what DecodeTangentFrame in vert_compact.glsl does
+void VertexPacking::UnpackTangentFrame(uint32_t frame, glm::vec3 &normal,
+                                       glm::vec3 &tangent,
+                                       glm::vec3 &bitangent) {
+  normal = OctahedralDecode(
+      glm::vec2(UnpackSnorm(frame, 0, 8), UnpackSnorm(frame, 8, 8)));
+  tangent = OctahedralDecode(
+      glm::vec2(UnpackSnorm(frame, 16, 8), UnpackSnorm(frame, 24, 7)));
+  float sign = (frame & (1u << 31)) != 0 ? -1.0f : 1.0f;
+  bitangent = sign * glm::cross(normal, tangent);
+}
+
+CompactVertex VertexPacking::Pack(const glm::vec3 &position,
+                                  const glm::vec3 &normal,
+                                  const glm::vec2 &texCoords,
+                                  const glm::vec3 &tangent,
+                                  const glm::vec3 &bitangent) {
+  CompactVertex vertex;
+  vertex.position[0] = glm::packHalf1x16(position.x);
+  vertex.position[1] = glm::packHalf1x16(position.y);
+  vertex.position[2] = glm::packHalf1x16(position.z);
+  vertex.position[3] = 0;
+  vertex.tangentFrame = PackTangentFrame(normal, tangent, bitangent);
+  // packUnorm1x16 clamps to 0..1
+  vertex.texCoords[0] = glm::packUnorm1x16(texCoords.x);
+  vertex.texCoords[1] = glm::packUnorm1x16(texCoords.y);
+  return vertex;
+}
+
+glm::vec3 VertexPacking::UnpackPosition(const CompactVertex &vertex) {
+  return glm::vec3(glm::unpackHalf1x16(vertex.position[0]),
+                   glm::unpackHalf1x16(vertex.position[1]),
+                   glm::unpackHalf1x16(vertex.position[2]));
+}
+
+glm::vec2 VertexPacking::UnpackTexCoords(const CompactVertex &vertex) {
+  return glm::vec2(glm::unpackUnorm1x16(vertex.texCoords[0]),
+                   glm::unpackUnorm1x16(vertex.texCoords[1]));
+}
@@ -0,0 +1,268 @@
+/* Benchmark for MeshSimplifier and LODSelector
+ *
+ * Parses every .obj file under common/objects and builds its levels of
+ * detail the way OBJModel::buildLODs does. For each level it prints the
+ * number of triangles, the largest distance (in model units) the
+ * surface moved, as a percentage of the model's bounding radius, and
+ * how long simplifying took. If the OpenGL driver supports
+ * GL_ARB_pipeline_statistics_query, every level is also drawn into a
+ * hidden window and the vertex shader runs the driver reports are
+ * printed.
+ *
+ * Last, a camera is flown away from a model and back with a little
+ * jitter in its distance, and the number of times the level changes is
+ * printed with LODSelector (which has hysteresis) and without.
+ *
+ * Compilation on Linux (from the part1 directory):
+ g++ -std=c++17 -O2 -D LINUX ./bench/LODBenchmark.cpp
+ ./src/OBJModel.cpp ./src/MeshSimplifier.cpp ./src/LODSelector.cpp
+ ./src/MeshOptimizer.cpp ./src/MeshCache.cpp ./src/MappedFile.cpp
+ ./src/Texture.cpp ./src/Image.cpp ./src/glad.cpp
+ -o lodbench -I ./include/ -I ./../../common/thirdparty/glm/
+ -lSDL2 -ldl -pthread
+ *
+ * Run with: ./lodbench [object directory]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "LODSelector.hpp"
+#include "MeshSimplifier.hpp"
+#include "OBJModel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// From GL_ARB_pipeline_statistics_query, which glad was not built with
+#define GL_VERTEX_SHADER_INVOCATIONS_ARB 0x82F0
+
+static const char *s_vertexSource = R"(#version 330 core
+layout(location=0)in vec3 position;
+void main(){
+    gl_Position = vec4(position * 0.01, 1.0);
+})";
+static const char *s_fragmentSource = R"(#version 330 core
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(1.0);
+})";
+
+// Draws the triangles once and returns how many times the vertex
+// shader ran
+static GLuint64 CountVertexShaderRuns(
+    const std::vector<OBJModel::Vertex> &vertices,
+    const std::vector<GLuint> &indices) {
+  GLuint vao, buffers[2], query;
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(2, buffers);
+  glGenQueries(1, &query);
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(OBJModel::Vertex),
+               vertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
+               indices.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(OBJModel::Vertex),
+                        (void *)0);
+  glEnableVertexAttribArray(0);
+
+  glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB, query);
+  glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+  glEndQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB);
+  GLuint64 runs = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &runs);
+
+  glDeleteQueries(1, &query);
+  glDeleteBuffers(2, buffers);
+  glDeleteVertexArrays(1, &vao);
+  return runs;
+}
+
+// Returns true if the driver has the extension called 'name'
+static bool HasExtension(const char *name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+    if (extension != nullptr && std::strcmp(extension, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static GLuint CompileProgram() {
+  GLuint program = glCreateProgram();
+  const char *sources[2] = {s_vertexSource, s_fragmentSource};
+  GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+  for (int i = 0; i < 2; ++i) {
+    GLuint shader = glCreateShader(types[i]);
+    glShaderSource(shader, 1, &sources[i], nullptr);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
+  }
+  glLinkProgram(program);
+  return program;
+}
+
+// Flies the camera from 1 to 20 bounding radii away and back, and
+// counts how often the level changes
+static void CountLODSwitches(unsigned int lodCount) {
+  const float fovY = 0.785398f; // 45 degrees, as in main.cpp
+  const int steps = 2000;
+  LODSelector selector;
+  unsigned int naiveLOD = 0;
+  int switches = 0, naiveSwitches = 0;
+  for (int step = 0; step <= steps; ++step) {
+    float t = (float)step / steps;
+    float distance = 1.0f + 19.0f * (t < 0.5f ? t * 2.0f : 2.0f - t * 2.0f);
+    // A little wobble, like a camera held by a hand
+    distance *= 1.0f + 0.03f * std::sin(step * 1.7f);
+    glm::vec3 eye(0.0f, 0.0f, distance);
+    float size = LODSelector::ScreenSize(glm::vec3(0.0f), 1.0f,
+                                         glm::mat4(1.0f), eye, fovY);
+    unsigned int lod = selector.GetLOD();
+    switches += selector.Select(size, lodCount) != lod;
+    // The same thresholds without hysteresis
+    unsigned int naive = 0;
+    while (naive + 1 < lodCount &&
+           size < std::ldexp(LODSelector::FIRST_THRESHOLD, -(int)naive)) {
+      ++naive;
+    }
+    naiveSwitches += naive != naiveLOD;
+    naiveLOD = naive;
+  }
+  std::printf("\nLevel changes over %d frames of a camera flying away and "
+              "back (%u levels):\n  with hysteresis %d, without %d\n",
+              steps, lodCount, switches, naiveSwitches);
+}
+
+int main(int argc, char **argv) {
+  fs::path directory = argc > 1 ? argv[1] : "../../common/objects";
+  std::vector<fs::path> files;
+  for (const auto &entry : fs::recursive_directory_iterator(directory)) {
+    if (entry.path().extension() == ".obj") {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  // The vertex shader counts are optional, everything else runs
+  // without OpenGL.
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_Window *window =
+      SDL_CreateWindow("lodbench", SDL_WINDOWPOS_UNDEFINED,
+                       SDL_WINDOWPOS_UNDEFINED, 64, 64,
+                       SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context =
+      window != nullptr ? SDL_GL_CreateContext(window) : nullptr;
+  bool countRuns = context != nullptr &&
+                   gladLoadGLLoader(SDL_GL_GetProcAddress) &&
+                   HasExtension("GL_ARB_pipeline_statistics_query");
+  if (countRuns) {
+    std::printf("Renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+    glUseProgram(CompileProgram());
+  } else {
+    std::printf("No GL_ARB_pipeline_statistics_query, so the vertex shader "
+                "runs are not counted\n");
+  }
+
+  // Keep the logging from the OBJModel constructor out of the table
+  std::ostringstream sink;
+  std::streambuf *coutBuffer = std::cout.rdbuf(sink.rdbuf());
+
+  std::printf("%-40s %3s %9s %8s %8s %10s\n", "file", "LOD", "triangles",
+              "error %", "ms", "VS runs");
+  for (const fs::path &file : files) {
+    OBJModel model;
+    model.parseModelFromFile(file.string());
+    const std::vector<OBJModel::Vertex> &vertices = model.getVertices();
+    glm::vec3 boundsMin = vertices.empty() ? glm::vec3(0.0f)
+                                           : vertices[0].position;
+    glm::vec3 boundsMax = boundsMin;
+    for (const OBJModel::Vertex &vertex : vertices) {
+      boundsMin = glm::min(boundsMin, vertex.position);
+      boundsMax = glm::max(boundsMax, vertex.position);
+    }
+    float radius = glm::length(boundsMax - boundsMin) * 0.5f;
+
+    // The same steps and limits as OBJModel::buildLODs, one index list
+    // per level
+    std::vector<std::vector<GLuint>> levels;
+    std::vector<std::vector<OBJModel::Submesh>> levelSubmeshes;
+    levels.push_back(model.getIndices());
+    levelSubmeshes.push_back(model.getSubmeshes());
+    std::vector<float> errors(1, 0.0f);
+    std::vector<double> times(1, 0.0);
+    while (levels.size() < OBJModel::MAX_LOD_COUNT &&
+           levels.back().size() / 3 >= 128) {
+      const std::vector<GLuint> &previous = levels.back();
+      std::vector<GLuint> level;
+      std::vector<OBJModel::Submesh> submeshes;
+      float error = 0.0f;
+      auto start = std::chrono::steady_clock::now();
+      for (const OBJModel::Submesh &submesh : levelSubmeshes.back()) {
+        float submeshError = 0.0f;
+        std::vector<GLuint> simplified = MeshSimplifier::Simplify(
+            previous.data() + submesh.firstIndex, submesh.indexCount,
+            vertices.data(), vertices.size(), sizeof(OBJModel::Vertex),
+            submesh.indexCount / 2, &submeshError);
+        submeshes.push_back({(GLuint)level.size(), (GLuint)simplified.size(),
+                             submesh.materialName, 0, 0});
+        level.insert(level.end(), simplified.begin(), simplified.end());
+        error = std::max(error, submeshError);
+      }
+      auto end = std::chrono::steady_clock::now();
+      if (level.size() > previous.size() * 0.9 ||
+          errors.back() + error > radius * 0.25f) {
+        break;
+      }
+      errors.push_back(errors.back() + error);
+      times.push_back(
+          std::chrono::duration<double, std::milli>(end - start).count());
+      levels.push_back(std::move(level));
+      levelSubmeshes.push_back(std::move(submeshes));
+    }
+
+    for (std::size_t lod = 0; lod < levels.size(); ++lod) {
+      std::printf("%-40s %3zu %9zu %8.3f %8.2f",
+                  lod == 0 ? fs::relative(file, directory).string().c_str()
+                           : "",
+                  lod, levels[lod].size() / 3,
+                  radius > 0.0f ? 100.0f * errors[lod] / radius : 0.0f,
+                  times[lod]);
+      if (countRuns) {
+        std::printf(" %10llu", (unsigned long long)CountVertexShaderRuns(
+                                   vertices, levels[lod]));
+      }
+      std::printf("\n");
+    }
+  }
+  std::cout.rdbuf(coutBuffer);
+
+  CountLODSwitches(OBJModel::MAX_LOD_COUNT);
+
+  if (context != nullptr) {
+    SDL_GL_DeleteContext(context);
+  }
+  if (window != nullptr) {
+    SDL_DestroyWindow(window);
+  }
+  SDL_Quit();
+  return 0;
+}
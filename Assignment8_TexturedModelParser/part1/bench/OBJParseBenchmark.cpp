@@ -0,0 +1,329 @@
+/* Benchmark for OBJModel::parseModelFromFile
+ *
+ * Parses every .obj file under common/objects with the memory mapped
+ * parser in OBJModel.cpp and with the original istringstream/sscanf
+ * parser, and checks that both produce the same vertices. The original
+ * parser only understands v/vt/vn faces, so files written with v//vn
+ * faces are only timed with the new parser. Both are timed on one
+ * thread.
+ *
+ * Next, for every file, the number of corners is compared with the
+ * number of unique vertices the parser keeps.
+ *
+ * Each file is then written to a binary mesh cache, and loading the
+ * cache (with and without hashing the source) is compared with
+ * parsing it and with simply reading the cache file.
+ *
+ * Then the largest files are parsed on 1, 2, 4 and 8 threads, and the
+ * results are checked against the single threaded parse.
+ *
+ * Parsing makes no OpenGL calls, so no window or context is needed.
+ *
+ * Compilation on Linux (from the part1 directory):
+ g++ -std=c++17 -O2 -D LINUX ./bench/OBJParseBenchmark.cpp ./src/OBJModel.cpp
+ ./src/MappedFile.cpp ./src/MeshCache.cpp ./src/MeshOptimizer.cpp
+ ./src/MeshSimplifier.cpp ./src/Texture.cpp ./src/Image.cpp ./src/glad.cpp
+ -o objbench -I ./include/ -I ./../../common/thirdparty/glm/ -ldl -pthread
+ *
+ * Run with: ./objbench [object directory]
+ */
+#include "MeshCache.hpp"
+#include "OBJModel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// The parser as it was originally written (without the material and
+// OpenGL steps). Kept here so the benchmark always has the same
+// baseline to compare against.
+static void LegacyParse(const std::string &filepath,
+                        std::vector<OBJModel::Vertex> &vertices,
+                        std::vector<GLuint> &indices) {
+  std::ifstream objFile(filepath);
+  std::string line;
+  std::vector<glm::vec3> temp_vertices;
+  std::vector<glm::vec2> temp_texCoords;
+  std::vector<glm::vec3> temp_normals;
+
+  while (std::getline(objFile, line)) {
+    std::istringstream ss(line);
+    std::string prefix;
+    ss >> prefix;
+
+    if (prefix == "v") {
+      glm::vec3 vertex;
+      ss >> vertex.x >> vertex.y >> vertex.z;
+      temp_vertices.push_back(vertex);
+    } else if (prefix == "vt") {
+      glm::vec2 texCoord;
+      ss >> texCoord.x >> texCoord.y;
+      temp_texCoords.push_back(texCoord);
+    } else if (prefix == "vn") {
+      glm::vec3 normal;
+      ss >> normal.x >> normal.y >> normal.z;
+      temp_normals.push_back(normal);
+    } else if (prefix == "f") {
+      std::string vertex1, vertex2, vertex3;
+      unsigned int vIndex[3], uvIndex[3], nIndex[3];
+
+      ss >> vertex1 >> vertex2 >> vertex3;
+      sscanf(vertex1.c_str(), "%d/%d/%d", &vIndex[0], &uvIndex[0], &nIndex[0]);
+      sscanf(vertex2.c_str(), "%d/%d/%d", &vIndex[1], &uvIndex[1], &nIndex[1]);
+      sscanf(vertex3.c_str(), "%d/%d/%d", &vIndex[2], &uvIndex[2], &nIndex[2]);
+
+      for (int i = 0; i < 3; i++) {
+        OBJModel::Vertex vertex;
+        vertex.position = temp_vertices[vIndex[i] - 1];
+        vertex.texCoords = temp_texCoords[uvIndex[i] - 1];
+        vertex.normal = temp_normals[nIndex[i] - 1];
+        vertices.push_back(vertex);
+        indices.push_back(vertices.size() - 1);
+      }
+    }
+  }
+}
+
+// True if every face in the file is written as v/vt/vn
+static bool LegacyCanParse(const std::string &filepath) {
+  std::ifstream objFile(filepath);
+  std::string line;
+  while (std::getline(objFile, line)) {
+    if (line.compare(0, 2, "f ") == 0 &&
+        (line.find("//") != std::string::npos ||
+         std::count(line.begin(), line.end(), '/') != 6)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the average time of 'runs' calls to 'f' in milliseconds
+template <typename F> static double TimeMS(int runs, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / runs;
+}
+
+int main(int argc, char **argv) {
+  std::string directory = argc > 1 ? argv[1] : "../../common/objects";
+
+  std::vector<fs::path> files;
+  for (const auto &entry : fs::recursive_directory_iterator(directory)) {
+    if (entry.path().extension() == ".obj") {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  // Keep the logging from the OBJModel constructor out of the table
+  std::ostringstream sink;
+  std::streambuf *coutBuffer = std::cout.rdbuf(sink.rdbuf());
+
+  const int runs = 5;
+  std::printf("%-48s %8s %10s %10s %10s %8s\n", "file", "KB", "triangles",
+              "legacy ms", "new ms", "speedup");
+  double legacyTotal = 0.0, newTotal = 0.0, newOnlyTotal = 0.0;
+  for (const fs::path &file : files) {
+    std::string path = file.string();
+    std::string name = fs::relative(file, directory).string();
+    double kilobytes = fs::file_size(file) / 1024.0;
+
+    OBJModel model;
+    double newMS =
+        TimeMS(runs, [&]() { model.parseModelFromFile(path, 1); });
+    unsigned int triangles = model.getIndices().size() / 3;
+
+    if (!LegacyCanParse(path)) {
+      newOnlyTotal += newMS;
+      std::printf("%-48s %8.0f %10u %10s %10.2f %8s\n", name.c_str(),
+                  kilobytes, triangles, "-", newMS, "(v//vn)");
+      continue;
+    }
+
+    std::vector<OBJModel::Vertex> legacyVertices;
+    std::vector<GLuint> legacyIndices;
+    double legacyMS = TimeMS(runs, [&]() {
+      legacyVertices.clear();
+      legacyIndices.clear();
+      LegacyParse(path, legacyVertices, legacyIndices);
+    });
+    // Verify both parsers agree. The legacy parser gives every corner
+    // its own vertex, so compare the vertex of every corner.
+    const std::vector<OBJModel::Vertex> &vertices = model.getVertices();
+    const std::vector<GLuint> &indices = model.getIndices();
+    bool same = legacyIndices.size() == indices.size();
+    for (std::size_t i = 0; same && i < indices.size(); ++i) {
+      same = std::memcmp(&legacyVertices[i], &vertices[indices[i]],
+                         sizeof(OBJModel::Vertex)) == 0;
+    }
+
+    legacyTotal += legacyMS;
+    newTotal += newMS;
+    std::printf("%-48s %8.0f %10u %10.2f %10.2f %7.1fx%s\n", name.c_str(),
+                kilobytes, triangles, legacyMS, newMS, legacyMS / newMS,
+                same ? "" : "  (parsers disagree)");
+  }
+  std::printf("%-48s %8s %10s %10.2f %10.2f %7.1fx\n", "total (v/vt/vn files)",
+              "", "", legacyTotal, newTotal, legacyTotal / newTotal);
+  std::printf("%-48s %8s %10s %10s %10.2f\n", "total (v//vn files)", "", "",
+              "-", newOnlyTotal);
+
+  // How much sharing vertices between corners saves. Before, every
+  // corner had its own vertex (and the indices were just 0..N-1).
+  std::printf("\nVertex deduplication\n");
+  std::printf("%-48s %10s %10s %8s %12s %12s\n", "file", "corners",
+              "vertices", "ratio", "before KB", "after KB");
+  for (const fs::path &file : files) {
+    OBJModel model;
+    model.parseModelFromFile(file.string(), 1);
+    std::size_t corners = model.getIndices().size();
+    std::size_t unique = model.getVertices().size();
+    // Vertex buffer plus index buffer
+    double beforeKB =
+        corners * (sizeof(OBJModel::Vertex) + sizeof(GLuint)) / 1024.0;
+    double afterKB = (unique * sizeof(OBJModel::Vertex) +
+                      corners * sizeof(GLuint)) /
+                     1024.0;
+    std::printf("%-48s %10zu %10zu %7.2fx %12.1f %12.1f\n",
+                fs::relative(file, directory).string().c_str(), corners,
+                unique, (double)corners / unique, beforeKB, afterKB);
+  }
+
+  // Loading from the binary mesh cache. Each file is copied to a
+  // temporary directory and its cache written next to the copy, so
+  // nothing is written into the object directory.
+  fs::path cacheDirectory = fs::temp_directory_path() / "objbench_cache";
+  fs::create_directories(cacheDirectory);
+  std::printf("\nMesh cache\n");
+  std::printf("%-48s %9s %9s %9s %9s %9s\n", "file", "cache KB", "parse ms",
+              "cache ms", "hash ms", "read ms");
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    fs::path source = cacheDirectory / (std::to_string(i) + ".obj");
+    fs::copy_file(files[i], source, fs::copy_options::overwrite_existing);
+    std::string sourcePath = source.string();
+    std::string cachePath = MeshCache::GetCachePath(sourcePath);
+
+    OBJModel model;
+    double parseMS =
+        TimeMS(runs, [&]() { model.parseModelFromFile(sourcePath); });
+    const std::vector<OBJModel::Vertex> &vertices = model.getVertices();
+    const std::vector<GLuint> &indices = model.getIndices();
+    std::vector<MeshCache::Submesh> submeshes;
+    for (const OBJModel::Submesh &submesh : model.getSubmeshes()) {
+      submeshes.push_back({submesh.firstIndex, submesh.indexCount,
+                           submesh.materialName, submesh.lod});
+    }
+    MeshCache::Write(sourcePath, cachePath, vertices.data(),
+                     (uint32_t)vertices.size(), sizeof(OBJModel::Vertex),
+                     indices.data(), (uint32_t)indices.size(), submeshes, "");
+
+    // Mapping does no work until the pages are touched, so read every
+    // byte once (as glBufferData would) to keep this fair.
+    volatile unsigned int checksum = 0;
+    auto touch = [&checksum](const void *data, std::size_t bytes) {
+      const uint8_t *p = static_cast<const uint8_t *>(data);
+      unsigned int sum = 0;
+      for (std::size_t b = 0; b < bytes; b += 4) {
+        sum += p[b];
+      }
+      checksum = checksum + sum;
+    };
+    bool same = false;
+    double cacheMS = TimeMS(runs, [&]() {
+      MeshCache cache;
+      if (!cache.Open(sourcePath, cachePath, sizeof(OBJModel::Vertex))) {
+        return;
+      }
+      const MeshCacheHeader &header = cache.GetHeader();
+      touch(cache.GetVertexData(),
+            header.vertexCount * sizeof(OBJModel::Vertex));
+      touch(cache.GetIndexData(), header.indexCount * sizeof(GLuint));
+      same = header.vertexCount == vertices.size() &&
+             header.indexCount == indices.size() &&
+             std::memcmp(cache.GetVertexData(), vertices.data(),
+                         vertices.size() * sizeof(OBJModel::Vertex)) == 0 &&
+             std::memcmp(cache.GetIndexData(), indices.data(),
+                         indices.size() * sizeof(GLuint)) == 0;
+    });
+    // When the source's time has changed the source is hashed as well
+    double hashMS = 0.0;
+    for (int run = 0; run < runs; ++run) {
+      fs::last_write_time(source, fs::last_write_time(source) +
+                                      std::chrono::seconds(1));
+      hashMS += TimeMS(1, [&]() {
+        MeshCache cache;
+        same = cache.Open(sourcePath, cachePath, sizeof(OBJModel::Vertex)) &&
+               same;
+      });
+    }
+    hashMS /= runs;
+    // Reading the cache file into memory, for comparison
+    std::size_t cacheBytes = fs::file_size(cachePath);
+    std::vector<char> buffer(cacheBytes);
+    double readMS = TimeMS(runs, [&]() {
+      std::ifstream in(cachePath.c_str(), std::ios::binary);
+      in.read(buffer.data(), cacheBytes);
+      touch(buffer.data(), cacheBytes);
+    });
+
+    std::printf("%-48s %9zu %9.2f %9.3f %9.3f %9.3f%s\n",
+                fs::relative(files[i], directory).string().c_str(),
+                cacheBytes / 1024, parseMS, cacheMS, hashMS, readMS,
+                same ? "" : "  (cache differs)");
+  }
+  fs::remove_all(cacheDirectory);
+
+  // Thread scaling on the largest files
+  std::sort(files.begin(), files.end(),
+            [](const fs::path &a, const fs::path &b) {
+              return fs::file_size(a) > fs::file_size(b);
+            });
+  files.resize(std::min<std::size_t>(files.size(), 3));
+  const unsigned int threadCounts[] = {1, 2, 4, 8};
+  std::printf("\nThreads (this machine has %u cores)\n",
+              std::thread::hardware_concurrency());
+  std::printf("%-48s", "file");
+  for (unsigned int threads : threadCounts) {
+    std::printf(" %7u ms", threads);
+  }
+  std::printf(" %8s\n", "speedup");
+  for (const fs::path &file : files) {
+    std::string path = file.string();
+    OBJModel serial;
+    serial.parseModelFromFile(path, 1);
+    std::printf("%-48s", fs::relative(file, directory).string().c_str());
+    double serialMS = 0.0, fastestMS = 0.0;
+    bool same = true;
+    for (unsigned int threads : threadCounts) {
+      OBJModel model;
+      double ms =
+          TimeMS(runs, [&]() { model.parseModelFromFile(path, threads); });
+      same = same && model.getIndices() == serial.getIndices() &&
+             std::memcmp(model.getVertices().data(),
+                         serial.getVertices().data(),
+                         serial.getVertices().size() *
+                             sizeof(OBJModel::Vertex)) == 0;
+      serialMS = threads == 1 ? ms : serialMS;
+      fastestMS = threads == 1 ? ms : std::min(fastestMS, ms);
+      std::printf(" %10.2f", ms);
+    }
+    std::printf(" %7.1fx%s\n", serialMS / fastestMS,
+                same ? "" : "  (results differ)");
+  }
+  std::cout.rdbuf(coutBuffer);
+  return 0;
+}
@@ -0,0 +1,250 @@
+/* Benchmark for MeshOptimizer
+ *
+ * Parses every .obj file under common/objects, then reorders its
+ * triangles and vertices the way OBJModel::loadModelFromFile does.
+ * For each file it prints the ACMR (vertex shader runs per triangle)
+ * for a 16 and a 32 entry first-in first-out cache before and after,
+ * the ATVR (vertex shader runs per vertex, 1.0 is the best possible)
+ * after, and how long the optimization took. It also checks that the
+ * reordered mesh still has exactly the same triangles.
+ *
+ * If the OpenGL driver supports GL_ARB_pipeline_statistics_query, both
+ * versions of every mesh are drawn into a hidden window, and the number
+ * of vertex shader runs the driver reports is printed as well.
+ *
+ * Compilation on Linux (from the part1 directory):
+ g++ -std=c++17 -O2 -D LINUX ./bench/VertexCacheBenchmark.cpp
+ ./src/OBJModel.cpp ./src/MeshOptimizer.cpp ./src/MeshSimplifier.cpp
+ ./src/MeshCache.cpp ./src/MappedFile.cpp ./src/Texture.cpp ./src/Image.cpp
+ ./src/glad.cpp
+ -o vcachebench -I ./include/ -I ./../../common/thirdparty/glm/
+ -lSDL2 -ldl -pthread
+ *
+ * Run with: ./vcachebench [object directory]
+ */
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+
+#include "MeshOptimizer.hpp"
+#include "OBJModel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// From GL_ARB_pipeline_statistics_query, which glad was not built with
+#define GL_VERTEX_SHADER_INVOCATIONS_ARB 0x82F0
+
+static const char *s_vertexSource = R"(#version 330 core
+layout(location=0)in vec3 position;
+layout(location=1)in vec2 texCoords;
+layout(location=2)in vec3 normal;
+out vec3 color;
+void main(){
+    gl_Position = vec4(position * 0.01, 1.0);
+    color = normal + vec3(texCoords, 0.0);
+})";
+static const char *s_fragmentSource = R"(#version 330 core
+in vec3 color;
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(color, 1.0);
+})";
+
+// Every triangle as the bytes of its three vertices, sorted, so two
+// meshes can be compared regardless of triangle and vertex order.
+static std::vector<std::array<OBJModel::Vertex, 3>>
+SortedTriangles(const std::vector<OBJModel::Vertex> &vertices,
+                const std::vector<GLuint> &indices) {
+  std::vector<std::array<OBJModel::Vertex, 3>> triangles(indices.size() / 3);
+  for (std::size_t t = 0; t < triangles.size(); ++t) {
+    for (int k = 0; k < 3; ++k) {
+      triangles[t][k] = vertices[indices[t * 3 + k]];
+    }
+  }
+  std::sort(triangles.begin(), triangles.end(),
+            [](const std::array<OBJModel::Vertex, 3> &a,
+               const std::array<OBJModel::Vertex, 3> &b) {
+              return std::memcmp(a.data(), b.data(), sizeof(a)) < 0;
+            });
+  return triangles;
+}
+
+// Draws the mesh once and returns how many times the vertex shader ran
+static GLuint64 CountVertexShaderRuns(
+    const std::vector<OBJModel::Vertex> &vertices,
+    const std::vector<GLuint> &indices) {
+  GLuint vao, buffers[2], query;
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(2, buffers);
+  glGenQueries(1, &query);
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(OBJModel::Vertex),
+               vertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
+               indices.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(OBJModel::Vertex),
+                        (void *)0);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(OBJModel::Vertex),
+                        (void *)offsetof(OBJModel::Vertex, texCoords));
+  glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(OBJModel::Vertex),
+                        (void *)offsetof(OBJModel::Vertex, normal));
+  for (GLuint attribute = 0; attribute < 3; ++attribute) {
+    glEnableVertexAttribArray(attribute);
+  }
+
+  glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB, query);
+  glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+  glEndQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB);
+  GLuint64 runs = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &runs);
+
+  glDeleteQueries(1, &query);
+  glDeleteBuffers(2, buffers);
+  glDeleteVertexArrays(1, &vao);
+  return runs;
+}
+
+// Returns true if the driver has the extension called 'name'
+static bool HasExtension(const char *name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+    if (extension != nullptr && std::strcmp(extension, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static GLuint CompileProgram() {
+  GLuint program = glCreateProgram();
+  const char *sources[2] = {s_vertexSource, s_fragmentSource};
+  GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+  for (int i = 0; i < 2; ++i) {
+    GLuint shader = glCreateShader(types[i]);
+    glShaderSource(shader, 1, &sources[i], nullptr);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
+  }
+  glLinkProgram(program);
+  return program;
+}
+
+int main(int argc, char **argv) {
+  fs::path directory = argc > 1 ? argv[1] : "../../common/objects";
+  std::vector<fs::path> files;
+  for (const auto &entry : fs::recursive_directory_iterator(directory)) {
+    if (entry.path().extension() == ".obj") {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  // The vertex shader counts are optional, everything else runs
+  // without OpenGL.
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_Window *window =
+      SDL_CreateWindow("vcachebench", SDL_WINDOWPOS_UNDEFINED,
+                       SDL_WINDOWPOS_UNDEFINED, 64, 64,
+                       SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  SDL_GLContext context =
+      window != nullptr ? SDL_GL_CreateContext(window) : nullptr;
+  bool countRuns = context != nullptr &&
+                   gladLoadGLLoader(SDL_GL_GetProcAddress) &&
+                   HasExtension("GL_ARB_pipeline_statistics_query");
+  if (countRuns) {
+    std::printf("Renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+    glUseProgram(CompileProgram());
+  } else {
+    std::printf("No GL_ARB_pipeline_statistics_query, so the vertex shader "
+                "runs are not counted\n");
+  }
+
+  // Keep the logging from the OBJModel constructor out of the table
+  std::ostringstream sink;
+  std::streambuf *coutBuffer = std::cout.rdbuf(sink.rdbuf());
+
+  std::printf("%-40s %9s %7s %7s %7s %7s %6s %8s %10s %10s\n", "file",
+              "triangles", "16 old", "16 new", "32 old", "32 new", "ATVR",
+              "opt ms", "VS old", "VS new");
+  for (const fs::path &file : files) {
+    OBJModel model;
+    model.parseModelFromFile(file.string());
+    std::vector<OBJModel::Vertex> vertices = model.getVertices();
+    std::vector<GLuint> indices = model.getIndices();
+    const std::vector<OBJModel::Vertex> &oldVertices = model.getVertices();
+    const std::vector<GLuint> &oldIndices = model.getIndices();
+
+    double old16 = MeshOptimizer::ComputeACMR(
+        oldIndices.data(), oldIndices.size(), oldVertices.size(), 16);
+    double old32 = MeshOptimizer::ComputeACMR(
+        oldIndices.data(), oldIndices.size(), oldVertices.size(), 32);
+
+    // The same steps as OBJModel::optimizeMesh
+    auto start = std::chrono::steady_clock::now();
+    for (const OBJModel::Submesh &submesh : model.getSubmeshes()) {
+      MeshOptimizer::OptimizeVertexCache(indices.data() + submesh.firstIndex,
+                                         submesh.indexCount, vertices.size());
+    }
+    MeshOptimizer::OptimizeVertexFetch(vertices.data(), vertices.size(),
+                                       sizeof(OBJModel::Vertex),
+                                       indices.data(), indices.size());
+    auto end = std::chrono::steady_clock::now();
+    double optimizeMS =
+        std::chrono::duration<double, std::milli>(end - start).count();
+
+    double new16 = MeshOptimizer::ComputeACMR(indices.data(), indices.size(),
+                                              vertices.size(), 16);
+    double new32 = MeshOptimizer::ComputeACMR(indices.data(), indices.size(),
+                                              vertices.size(), 32);
+    double atvr = new32 * (indices.size() / 3) / vertices.size();
+    std::vector<std::array<OBJModel::Vertex, 3>> oldTriangles =
+        SortedTriangles(oldVertices, oldIndices);
+    std::vector<std::array<OBJModel::Vertex, 3>> newTriangles =
+        SortedTriangles(vertices, indices);
+    bool same = oldTriangles.size() == newTriangles.size() &&
+                std::memcmp(oldTriangles.data(), newTriangles.data(),
+                            oldTriangles.size() * sizeof(oldTriangles[0])) ==
+                    0;
+
+    std::printf("%-40s %9zu %7.3f %7.3f %7.3f %7.3f %6.3f %8.2f",
+                fs::relative(file, directory).string().c_str(),
+                indices.size() / 3, old16, new16, old32, new32, atvr,
+                optimizeMS);
+    if (countRuns) {
+      std::printf(" %10llu %10llu",
+                  (unsigned long long)CountVertexShaderRuns(oldVertices,
+                                                            oldIndices),
+                  (unsigned long long)CountVertexShaderRuns(vertices,
+                                                            indices));
+    }
+    std::printf("%s\n", same ? "" : "  (triangles differ)");
+  }
+  std::cout.rdbuf(coutBuffer);
+
+  if (context != nullptr) {
+    SDL_GL_DeleteContext(context);
+  }
+  if (window != nullptr) {
+    SDL_DestroyWindow(window);
+  }
+  SDL_Quit();
+  return 0;
+}
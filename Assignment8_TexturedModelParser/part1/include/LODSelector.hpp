@@ -0,0 +1,52 @@
+/** @file LODSelector.hpp
+ *  @brief Picks which level of detail to draw a model at.
+ *
+ *  A model's level of detail is chosen from how big it looks: the
+ *  diameter of its bounding sphere, as a fraction of the screen height.
+ *  Level 0 is used down to half the screen, level 1 down to a quarter,
+ *  and so on, each level covering half the size of the one before (as
+ *  each level has about half the triangles).
+ *
+ *  So that a model sitting right on a threshold does not switch back
+ *  and forth every frame, it only moves to a coarser level once it is
+ *  HYSTERESIS smaller than the threshold, and back to the finer level
+ *  once it is HYSTERESIS bigger. One LODSelector remembers the level of
+ *  one model.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef LODSELECTOR_HPP
+#define LODSELECTOR_HPP
+
+#include "glm/glm.hpp"
+
+class LODSelector {
+public:
+  // Fraction of the screen height below which level 1 is used
+  static constexpr float FIRST_THRESHOLD = 0.5f;
+  // How far past a threshold the size must go to switch levels
+  static constexpr float HYSTERESIS = 0.1f;
+
+  // Constructor (starts at the full detail level)
+  LODSelector();
+  // Updates the level from the model's size on screen (see
+  // ScreenSize), for a model with 'lodCount' levels, and returns it
+  unsigned int Select(float screenSize, unsigned int lodCount);
+  // Returns the level picked by the last Select
+  unsigned int GetLOD() const;
+
+  // The diameter of a bounding sphere (given in model space) as a
+  // fraction of the screen height, seen from 'eye' with a vertical
+  // field of view of 'fovY' radians. Returns 1 if the eye is inside
+  // the sphere.
+  static float ScreenSize(const glm::vec3 &center, float radius,
+                          const glm::mat4 &model, const glm::vec3 &eye,
+                          float fovY);
+
+private:
+  // The level drawn last
+  unsigned int m_lod;
+};
+
+#endif
@@ -0,0 +1,48 @@
+/** @file MappedFile.hpp
+ *  @brief Maps a file on disk into memory for fast, copy-free reading.
+ *
+ *  On Linux and Mac the file is memory mapped with mmap, so the
+ *  operating system pages the data in as it is touched. The mapping
+ *  is private (copy-on-write), so callers may modify the bytes without
+ *  changing the file on disk. On other platforms (i.e. MINGW) the
+ *  file is simply read into a heap allocated buffer.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile {
+public:
+  // Constructor (nothing is mapped until Open is called)
+  MappedFile();
+  // Destructor unmaps (or frees) the file data
+  ~MappedFile();
+  // A mapping owns a resource, so it cannot be copied.
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  // Maps the file at 'filepath' into memory.
+  // Returns false if the file could not be opened or mapped.
+  bool Open(const std::string &filepath);
+  // Unmaps the file (called automatically by the destructor)
+  void Close();
+  // Returns true if a file is currently mapped
+  inline bool IsOpen() const { return m_data != nullptr; }
+  // Pointer to the first byte of the file
+  inline uint8_t *GetData() const { return m_data; }
+  // Size of the file in bytes
+  inline std::size_t GetSize() const { return m_size; }
+
+private:
+  // Start of the mapped (or loaded) file
+  uint8_t *m_data{nullptr};
+  // Number of bytes in the file
+  std::size_t m_size{0};
+};
+
+#endif
@@ -0,0 +1,142 @@
+/** @file MeshCache.hpp
+ *  @brief A binary copy of a parsed model, so it can be loaded without
+ *         parsing the text again.
+ *
+ *  After an .obj file is parsed the first time, its vertex and index
+ *  buffers are written next to it (as 'model.obj.meshcache'). Later
+ *  runs map the cache file into memory and hand the buffers straight
+ *  to glBufferData.
+ *
+ *  The cache stores the source file's modification time, size and a
+ *  hash of its contents. If the time and size still match, the cache
+ *  is used as is. If they do not (e.g. the file was copied or touched),
+ *  the source is hashed, and the cache is only used if the hash still
+ *  matches. Otherwise the caller parses the source again and rewrites
+ *  the cache.
+ *
+ *  The file is laid out as:
+ *    MeshCacheHeader
+ *    vertexCount * vertexStride bytes of interleaved vertex data
+ *    indexCount 32-bit indices
+ *    submeshCount MeshCacheSubmesh ranges
+ *    stringBytes of names (not null terminated)
+ *  Every section starts on a 4 byte boundary. The data is written in
+ *  the machine's own byte order, as the cache never leaves the machine.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef MESHCACHE_HPP
+#define MESHCACHE_HPP
+
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Everything needed to validate and read the rest of the file
+struct MeshCacheHeader {
+  char magic[8];          // Always "MESHCACH"
+  uint32_t version;       // MESHCACHE_VERSION when written
+  uint32_t vertexStride;  // Bytes per vertex
+  int64_t sourceTime;     // Modification time of the source file
+  uint64_t sourceSize;    // Size of the source file in bytes
+  uint64_t sourceHash;    // MeshCache::HashFile of the source file
+  uint32_t vertexCount;   // Number of vertices
+  uint32_t indexCount;    // Number of indices
+  uint32_t submeshCount;  // Number of submeshes
+  uint32_t stringBytes;   // Size of the string table at the end
+  float boundsMin[3];     // Smallest x, y and z of any vertex
+  float boundsMax[3];     // Largest x, y and z of any vertex
+  uint32_t materialLibraryOffset; // The .mtl path in the string table
+  uint32_t materialLibraryLength;
+};
+
+// A range of indices drawn with one material
+struct MeshCacheSubmesh {
+  uint32_t firstIndex;   // First index of the range
+  uint32_t indexCount;   // Number of indices in the range
+  uint32_t nameOffset;   // The material's name in the string table
+  uint32_t nameLength;
+  uint32_t lod;          // Level of detail (0 is the full model)
+};
+
+// Bump this whenever the layout above, the vertex format or what the
+// parser produces changes (2: triangles grouped by material,
+// 3: triangles and vertices reordered by MeshOptimizer, 4: simplified
+// levels of detail)
+const uint32_t MESHCACHE_VERSION = 4;
+
+class MeshCache {
+public:
+  // What is written to (and read back from) a cache file
+  struct Submesh {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    std::string material;
+    uint32_t lod;
+  };
+
+  // Constructor (nothing is loaded until Open is called)
+  MeshCache();
+  // Destructor unmaps the cache file
+  ~MeshCache();
+  // The cache owns a mapping, so it cannot be copied.
+  MeshCache(const MeshCache &) = delete;
+  MeshCache &operator=(const MeshCache &) = delete;
+
+  // Where the cache for 'sourcePath' lives
+  static std::string GetCachePath(const std::string &sourcePath);
+  // Hash of a file's contents. Returns false if it cannot be read.
+  static bool HashFile(const std::string &filepath, uint64_t &hash);
+
+  // Maps the cache file at 'cachePath' made from 'sourcePath'.
+  // Returns false (and maps nothing) if there is no cache, it was
+  // written by a different version, or the source has changed.
+  // 'vertexStride' must match the stride the cache was written with.
+  bool Open(const std::string &sourcePath, const std::string &cachePath,
+            uint32_t vertexStride);
+  // Same as above with the cache next to the source
+  bool Open(const std::string &sourcePath, uint32_t vertexStride) {
+    return Open(sourcePath, GetCachePath(sourcePath), vertexStride);
+  }
+  // Writes the cache for 'sourcePath' to 'cachePath'. Each vertex must
+  // start with its x, y and z position, which are used for the bounds.
+  // Returns false if the file could not be written.
+  static bool Write(const std::string &sourcePath,
+                    const std::string &cachePath, const void *vertexData,
+                    uint32_t vertexCount, uint32_t vertexStride,
+                    const uint32_t *indexData, uint32_t indexCount,
+                    const std::vector<Submesh> &submeshes,
+                    const std::string &materialLibrary);
+
+  // Returns true if a valid cache is mapped
+  inline bool IsOpen() const { return m_header != nullptr; }
+  // The header of the mapped cache
+  inline const MeshCacheHeader &GetHeader() const { return *m_header; }
+  // The interleaved vertex data, GetHeader().vertexCount vertices
+  inline const void *GetVertexData() const { return m_vertexData; }
+  // The indices, GetHeader().indexCount of them
+  inline const uint32_t *GetIndexData() const { return m_indexData; }
+  // The submeshes, GetHeader().submeshCount of them
+  inline const MeshCacheSubmesh *GetSubmeshes() const { return m_submeshes; }
+  // Looks up a name in the string table
+  std::string_view GetString(uint32_t offset, uint32_t length) const;
+  // The path of the .mtl file, or an empty string if there is none
+  std::string_view GetMaterialLibrary() const;
+
+private:
+  // The cache file
+  MappedFile m_file;
+  // Pointers into the mapping (all nullptr when nothing is open)
+  const MeshCacheHeader *m_header{nullptr};
+  const void *m_vertexData{nullptr};
+  const uint32_t *m_indexData{nullptr};
+  const MeshCacheSubmesh *m_submeshes{nullptr};
+  const char *m_strings{nullptr};
+};
+
+#endif
@@ -0,0 +1,50 @@
+/** @file MeshSimplifier.hpp
+ *  @brief Removes triangles from a mesh while keeping its shape, to
+ *         build cheaper levels of detail (LODs) for far away models.
+ *
+ *  Edges are collapsed one at a time, cheapest first, where the cost of
+ *  a collapse is the quadric error from Garland and Heckbert's "Surface
+ *  Simplification Using Quadric Error Metrics": the sum of squared
+ *  distances from the new position to the planes of the triangles that
+ *  were merged into it.
+ *
+ *  Only half-edge collapses are done. A vertex is always replaced by
+ *  one of its neighbours, so the simplified triangles use the same
+ *  vertex buffer as the original mesh, and only a new index buffer is
+ *  needed for each level of detail. Vertices are welded by position
+ *  first, so that texture and normal seams collapse together instead of
+ *  tearing apart (a corner across a seam takes the closest attributes
+ *  the kept vertex has, which blurs hard edges a little on the coarse
+ *  levels). Vertices on the border of the mesh (which includes
+ *  the edges between two materials, when each submesh is simplified on
+ *  its own) are never removed, so neighbouring meshes still line up.
+ *
+ *  @author Mike
+ *  @bug No known bugs.
+ */
+#ifndef MESHSIMPLIFIER_HPP
+#define MESHSIMPLIFIER_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+class MeshSimplifier {
+public:
+  // Collapses edges of the triangles in 'indices' until there are at
+  // most 'targetIndexCount' indices, or nothing more can be collapsed
+  // without flipping a triangle or moving a border. Each vertex is
+  // 'vertexStride' bytes and starts with its x, y and z position.
+  // Returns the new indices. If 'error' is given, it is set to the
+  // largest distance (in model units) a collapse moved the surface.
+  static std::vector<GLuint> Simplify(const GLuint *indices,
+                                      std::size_t indexCount,
+                                      const void *vertices,
+                                      std::size_t vertexCount,
+                                      std::size_t vertexStride,
+                                      std::size_t targetIndexCount,
+                                      float *error = nullptr);
+};
+
+#endif
@@ -17,6 +17,7 @@
 
 // Structure to represent the material properties of an object
 struct Material {
+  std::string name; // Name given by 'newmtl'
   float ns;         // Specular exponent
   float ka[3];      // Ambient color
   float kd[3];      // Diffuse color
@@ -25,25 +26,15 @@ struct Material {
   float ni;         // Optical density (index of refraction)
   float d;          // Dissolve (transparency)
   int illum;        // Illumination model
-  Texture map_kd;   // Diffuse texture map
-  Texture map_bump; // Bump map texture
-  Texture map_ks;   // Specular texture map
+  // Textures are shared by every material that uses the same file
+  const Texture *map_kd{nullptr};   // Diffuse texture map
+  const Texture *map_bump{nullptr}; // Bump map texture
+  const Texture *map_ks{nullptr};   // Specular texture map
 };
 
 // Class to represent an OBJ model
 class OBJModel {
 public:
-  OBJModel();                            // Default constructor
-  OBJModel(const std::string &filepath); // Constructor to load model from file
-  ~OBJModel();                           // Destructor to clean up resources
-
-  void render() const; // Render the model
-  void
-  loadModelFromFile(const std::string &filepath); // Load model data from file
-  void SetShaderMaterialUniforms(
-      GLuint shaderProgram); // Set material properties in the shader
-
-private:
   // Vertex structure to represent a vertex with position, texture coordinates,
   // and normal vector
   struct Vertex {
@@ -52,21 +43,91 @@ private:
     glm::vec3 normal;    // Normal vector
   };
 
+  // A range of indices that is drawn with one material
+  struct Submesh {
+    GLuint firstIndex;        // First index of the range
+    GLuint indexCount;        // Number of indices in the range
+    std::string materialName; // Name given by 'usemtl' (may be empty)
+    unsigned int material;    // Index into the material table
+    unsigned int lod;         // Level of detail (0 is the full model)
+  };
+
+  // The most levels of detail buildLODs makes (including the full model)
+  static const unsigned int MAX_LOD_COUNT = 4;
+
+  OBJModel();                            // Default constructor
+  OBJModel(const std::string &filepath); // Constructor to load model from file
+  ~OBJModel();                           // Destructor to clean up resources
+
+  // Render the model at level of detail 'lod' (clamped to the coarsest
+  // level there is)
+  void render(unsigned int lod = 0) const;
+  void
+  loadModelFromFile(const std::string &filepath); // Load model data from file
+  // Reads the vertices and faces of an .obj file, without loading
+  // materials or touching OpenGL. Returns false if the file could not
+  // be read. Called by loadModelFromFile.
+  // Large files are read on up to 'threadCount' threads (0 means one
+  // per core).
+  bool parseModelFromFile(const std::string &filepath,
+                          unsigned int threadCount = 0);
+  // Points the shader's samplers at our texture units, and remembers
+  // where its material colors are so render() can set them
+  void SetShaderMaterialUniforms(GLuint shaderProgram);
+
+  // The parsed model data
+  const std::vector<Vertex> &getVertices() const { return vertices; }
+  const std::vector<GLuint> &getIndices() const { return indices; }
+  // The indices of each material are one range, in the order render()
+  // draws them
+  const std::vector<Submesh> &getSubmeshes() const { return submeshes; }
+  const std::vector<Material> &getMaterials() const { return materials; }
+  // Number of levels of detail, 1 if the model was too small to simplify
+  unsigned int getLODCount() const { return lodCount; }
+  // A sphere around every vertex, in model space
+  const glm::vec3 &getBoundsCenter() const { return boundsCenter; }
+  float getBoundsRadius() const { return boundsRadius; }
+
+private:
   // Model data
   std::vector<Vertex> vertices; // List of vertices
   std::vector<GLuint> indices;  // Indices for indexed drawing
+  std::vector<Submesh> submeshes; // One range of indices per material
+                                  // and level of detail
+  unsigned int lodCount{1};       // Levels of detail in 'submeshes'
+  glm::vec3 boundsCenter{0.0f};   // Bounding sphere of the vertices
+  float boundsRadius{0.0f};
+  std::vector<Material> materials; // Every material in the .mtl file
   std::unordered_map<std::string, Texture>
       texturesLoaded; // Map of loaded textures to avoid duplication
+  std::string materialLibraryPath; // The .mtl file named by the .obj file
 
   // OpenGL buffer objects
-  GLuint vao, vbo, ebo; // Vertex Array Object, Vertex Buffer Object, and
-                        // Element Buffer Object
+  GLuint vao{0}, vbo{0}, ebo{0}; // Vertex Array Object, Vertex Buffer Object,
+                                 // and Element Buffer Object
+
+  GLsizei elementCount{0};       // Number of indices uploaded to the EBO
+  // Where the shader's material colors are (-1 if it has none)
+  GLint kaLocation{-1}, kdLocation{-1}, ksLocation{-1};
 
-  Material material;   // Material properties of the model
-  void setupBuffers(); // Setup the VAO, VBO, and EBO
+  // Setup the VAO, VBO, and EBO from 'vertexCount' vertices and
+  // 'indexCount' indices (which may come from parsing or the cache)
+  void setupBuffers(const void *vertexData, std::size_t vertexCount,
+                    const GLuint *indexData, std::size_t indexCount);
   void
   LoadMaterials(const std::string
                     &mtlFilePath); // Load material properties from a .mtl file
+  // Reorders the triangles and vertices to draw faster (see
+  // MeshOptimizer). Called between parsing and setupBuffers.
+  void optimizeMesh();
+  // Appends simplified copies of every submesh (see MeshSimplifier),
+  // each level with about half the triangles of the one before. Called
+  // between parsing and optimizeMesh.
+  void buildLODs();
+  // Finds the material of every submesh, and orders the submeshes of
+  // each level of detail so that the ones using the same textures are
+  // drawn together
+  void sortSubmeshes();
 };
 
 #endif // OBJMODEL_HPP
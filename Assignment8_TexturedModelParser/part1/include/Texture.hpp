@@ -32,11 +32,11 @@ public:
 
 private:
   // Store a unique ID for the texture
-  GLuint m_textureID;
+  GLuint m_textureID{0};
   // Filepath to the image loaded
   std::string m_filepath;
   // Store whatever image data inside of our texture class.
-  Image *m_image;
+  Image *m_image{nullptr};
 };
 
 #endif
\ No newline at end of file
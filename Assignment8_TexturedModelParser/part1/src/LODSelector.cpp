@@ -0,0 +1,46 @@
+#include "LODSelector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+LODSelector::LODSelector() : m_lod(0) {}
+
+// The threshold between level i - 1 and level i is
+// FIRST_THRESHOLD / 2^(i - 1)
+unsigned int LODSelector::Select(float screenSize, unsigned int lodCount) {
+  if (lodCount == 0) {
+    m_lod = 0;
+    return m_lod;
+  }
+  m_lod = std::min(m_lod, lodCount - 1);
+  // Too small for this level: go coarser
+  while (m_lod + 1 < lodCount &&
+         screenSize < std::ldexp(FIRST_THRESHOLD, -(int)m_lod) *
+                          (1.0f - HYSTERESIS)) {
+    ++m_lod;
+  }
+  // Too big for this level: go finer
+  while (m_lod > 0 && screenSize > std::ldexp(FIRST_THRESHOLD, 1 - (int)m_lod) *
+                                       (1.0f + HYSTERESIS)) {
+    --m_lod;
+  }
+  return m_lod;
+}
+
+unsigned int LODSelector::GetLOD() const { return m_lod; }
+
+float LODSelector::ScreenSize(const glm::vec3 &center, float radius,
+                              const glm::mat4 &model, const glm::vec3 &eye,
+                              float fovY) {
+  glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+  // The model matrix may scale the sphere, take the largest axis
+  float scale = std::max({glm::length(glm::vec3(model[0])),
+                          glm::length(glm::vec3(model[1])),
+                          glm::length(glm::vec3(model[2]))});
+  float worldRadius = radius * scale;
+  float distance = glm::length(worldCenter - eye);
+  if (distance <= worldRadius) {
+    return 1.0f;
+  }
+  return worldRadius / (distance * std::tan(fovY * 0.5f));
+}
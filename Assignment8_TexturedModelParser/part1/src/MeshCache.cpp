@@ -0,0 +1,257 @@
+#include "MeshCache.hpp"
+#include "OBJModel.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char MAGIC[8] = {'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H'};
+
+// Reads the modification time and size of a file.
+// Returns false if the file does not exist.
+bool GetFileStamp(const std::string &filepath, int64_t &time,
+                  uint64_t &size) {
+  std::error_code error;
+  fs::file_time_type writeTime = fs::last_write_time(filepath, error);
+  if (error) {
+    return false;
+  }
+  size = fs::file_size(filepath, error);
+  if (error) {
+    return false;
+  }
+  time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+  return true;
+}
+
+// Rounds a section size up so the next section starts 4 byte aligned
+inline std::size_t Align4(std::size_t bytes) { return (bytes + 3) & ~3u; }
+
+} // namespace
+
+// Constructor
+MeshCache::MeshCache() {}
+
+// Destructor
+MeshCache::~MeshCache() {}
+
+// The cache sits next to the source, e.g. 'model.obj.meshcache'
+std::string MeshCache::GetCachePath(const std::string &sourcePath) {
+  return sourcePath + ".meshcache";
+}
+
+// FNV-1a, but over eight bytes at a time so hashing runs at close
+// to the speed the file can be read.
+bool MeshCache::HashFile(const std::string &filepath, uint64_t &hash) {
+  MappedFile file;
+  if (!file.Open(filepath)) {
+    return false;
+  }
+  const uint64_t prime = 1099511628211ull;
+  hash = 14695981039346656037ull;
+  const uint8_t *data = file.GetData();
+  std::size_t size = file.GetSize();
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    hash = (hash ^ word) * prime;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ data[i]) * prime;
+  }
+  hash ^= size;
+  return true;
+}
+
+// Maps the cache and checks it still matches its source
+bool MeshCache::Open(const std::string &sourcePath,
+                     const std::string &cachePath, uint32_t vertexStride) {
+  m_file.Close();
+  m_header = nullptr;
+
+  int64_t sourceTime;
+  uint64_t sourceSize;
+  std::error_code error;
+  if (!fs::exists(cachePath, error) ||
+      !GetFileStamp(sourcePath, sourceTime, sourceSize) ||
+      !m_file.Open(cachePath)) {
+    return false;
+  }
+
+  // Check the header before trusting any of the counts in it
+  const uint8_t *data = m_file.GetData();
+  std::size_t size = m_file.GetSize();
+  if (size < sizeof(MeshCacheHeader)) {
+    m_file.Close();
+    return false;
+  }
+  const MeshCacheHeader *header =
+      reinterpret_cast<const MeshCacheHeader *>(data);
+  std::size_t vertexBytes =
+      Align4((std::size_t)header->vertexCount * header->vertexStride);
+  std::size_t indexBytes = (std::size_t)header->indexCount * sizeof(uint32_t);
+  std::size_t submeshBytes =
+      (std::size_t)header->submeshCount * sizeof(MeshCacheSubmesh);
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->version != MESHCACHE_VERSION ||
+      header->vertexStride != vertexStride ||
+      header->sourceSize != sourceSize ||
+      size != sizeof(MeshCacheHeader) + vertexBytes + indexBytes +
+                  submeshBytes + header->stringBytes) {
+    m_file.Close();
+    return false;
+  }
+  // Every submesh is drawn straight from the index buffer, so a range
+  // past its end must never get that far. Nor may a level of detail
+  // that OBJModel::render could never pick.
+  const MeshCacheSubmesh *ranges = reinterpret_cast<const MeshCacheSubmesh *>(
+      data + sizeof(MeshCacheHeader) + vertexBytes + indexBytes);
+  for (uint32_t i = 0; i < header->submeshCount; ++i) {
+    if ((uint64_t)ranges[i].firstIndex + ranges[i].indexCount >
+            header->indexCount ||
+        ranges[i].lod >= OBJModel::MAX_LOD_COUNT) {
+      m_file.Close();
+      return false;
+    }
+  }
+
+  // A different time alone does not mean different contents (copying
+  // or checking out a file changes it), so compare the hashes too.
+  if (header->sourceTime != sourceTime) {
+    uint64_t sourceHash;
+    if (!HashFile(sourcePath, sourceHash) || sourceHash != header->sourceHash) {
+      m_file.Close();
+      return false;
+    }
+    // Store the new time, so we do not hash the source again next run
+    std::fstream cacheFile(cachePath.c_str(),
+                           std::ios::in | std::ios::out | std::ios::binary);
+    cacheFile.seekp(offsetof(MeshCacheHeader, sourceTime));
+    cacheFile.write(reinterpret_cast<const char *>(&sourceTime),
+                    sizeof(sourceTime));
+  }
+
+  const uint8_t *section = data + sizeof(MeshCacheHeader);
+  m_vertexData = section;
+  section += vertexBytes;
+  m_indexData = reinterpret_cast<const uint32_t *>(section);
+  section += indexBytes;
+  m_submeshes = reinterpret_cast<const MeshCacheSubmesh *>(section);
+  section += submeshBytes;
+  m_strings = reinterpret_cast<const char *>(section);
+  m_header = header;
+  return true;
+}
+
+// Writes to a temporary file first, then renames it, so that another
+// run never maps a half written cache.
+bool MeshCache::Write(const std::string &sourcePath,
+                      const std::string &cachePath, const void *vertexData,
+                      uint32_t vertexCount, uint32_t vertexStride,
+                      const uint32_t *indexData, uint32_t indexCount,
+                      const std::vector<Submesh> &submeshes,
+                      const std::string &materialLibrary) {
+  MeshCacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = MESHCACHE_VERSION;
+  header.vertexStride = vertexStride;
+  if (!GetFileStamp(sourcePath, header.sourceTime, header.sourceSize) ||
+      !HashFile(sourcePath, header.sourceHash)) {
+    return false;
+  }
+  header.vertexCount = vertexCount;
+  header.indexCount = indexCount;
+  header.submeshCount = static_cast<uint32_t>(submeshes.size());
+
+  // Bounds of the positions at the start of each vertex
+  const uint8_t *vertexBytes = static_cast<const uint8_t *>(vertexData);
+  for (int axis = 0; axis < 3; ++axis) {
+    header.boundsMin[axis] = vertexCount > 0 ? FLT_MAX : 0.0f;
+    header.boundsMax[axis] = vertexCount > 0 ? -FLT_MAX : 0.0f;
+  }
+  for (uint32_t v = 0; v < vertexCount; ++v) {
+    float position[3];
+    std::memcpy(position, vertexBytes + (std::size_t)v * vertexStride,
+                sizeof(position));
+    for (int axis = 0; axis < 3; ++axis) {
+      header.boundsMin[axis] = std::min(header.boundsMin[axis], position[axis]);
+      header.boundsMax[axis] = std::max(header.boundsMax[axis], position[axis]);
+    }
+  }
+
+  // The string table holds the material library, then every name
+  std::string strings = materialLibrary;
+  header.materialLibraryOffset = 0;
+  header.materialLibraryLength = static_cast<uint32_t>(materialLibrary.size());
+  std::vector<MeshCacheSubmesh> ranges(submeshes.size());
+  for (std::size_t i = 0; i < submeshes.size(); ++i) {
+    ranges[i].firstIndex = submeshes[i].firstIndex;
+    ranges[i].indexCount = submeshes[i].indexCount;
+    ranges[i].nameOffset = static_cast<uint32_t>(strings.size());
+    ranges[i].nameLength = static_cast<uint32_t>(submeshes[i].material.size());
+    ranges[i].lod = submeshes[i].lod;
+    strings += submeshes[i].material;
+  }
+  header.stringBytes = static_cast<uint32_t>(strings.size());
+
+  std::string temporaryPath = cachePath + ".tmp";
+  {
+    std::ofstream out(temporaryPath.c_str(), std::ios::binary);
+    if (!out.is_open()) {
+      std::cerr << "Unable to write mesh cache: " << cachePath << std::endl;
+      return false;
+    }
+    const char padding[4] = {0, 0, 0, 0};
+    std::size_t vertexSize = (std::size_t)vertexCount * vertexStride;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(static_cast<const char *>(vertexData), vertexSize);
+    out.write(padding, Align4(vertexSize) - vertexSize);
+    out.write(reinterpret_cast<const char *>(indexData),
+              (std::size_t)indexCount * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char *>(ranges.data()),
+              ranges.size() * sizeof(MeshCacheSubmesh));
+    out.write(strings.data(), strings.size());
+    if (!out.good()) {
+      std::cerr << "Unable to write mesh cache: " << cachePath << std::endl;
+      out.close();
+      std::remove(temporaryPath.c_str());
+      return false;
+    }
+  }
+  std::error_code error;
+  fs::rename(temporaryPath, cachePath, error);
+  if (error) {
+    std::cerr << "Unable to write mesh cache: " << cachePath << std::endl;
+    fs::remove(temporaryPath, error);
+    return false;
+  }
+  return true;
+}
+
+// Looks up a name in the string table
+std::string_view MeshCache::GetString(uint32_t offset, uint32_t length) const {
+  if (m_header == nullptr ||
+      (uint64_t)offset + length > m_header->stringBytes) {
+    return std::string_view();
+  }
+  return std::string_view(m_strings + offset, length);
+}
+
+// The path of the .mtl file, or an empty string if there is none
+std::string_view MeshCache::GetMaterialLibrary() const {
+  if (m_header == nullptr) {
+    return std::string_view();
+  }
+  return GetString(m_header->materialLibraryOffset,
+                   m_header->materialLibraryLength);
+}
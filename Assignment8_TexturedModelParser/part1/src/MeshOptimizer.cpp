@@ -0,0 +1,234 @@
+#include "MeshOptimizer.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Constants from Forsyth's paper
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+// Vertices with more triangles left than this get the same boost
+const unsigned int MAX_VALENCE = 32;
+
+// Scores for a vertex by its position in the cache and by how many
+// triangles still use it, worked out once.
+struct ScoreTables {
+  float cache[MeshOptimizer::CACHE_SIZE];
+  float valence[MAX_VALENCE + 1];
+
+  ScoreTables() {
+    for (unsigned int i = 0; i < MeshOptimizer::CACHE_SIZE; ++i) {
+      if (i < 3) {
+        // The last triangle's vertices are about to be used anyway, so
+        // do not favour them as much as the ones just behind.
+        cache[i] = LAST_TRIANGLE_SCORE;
+      } else {
+        float scale = 1.0f / (MeshOptimizer::CACHE_SIZE - 3);
+        cache[i] = std::pow(1.0f - (i - 3) * scale, CACHE_DECAY_POWER);
+      }
+    }
+    valence[0] = 0.0f;
+    for (unsigned int i = 1; i <= MAX_VALENCE; ++i) {
+      // Vertices with few triangles left are finished off first
+      valence[i] =
+          VALENCE_BOOST_SCALE * std::pow((float)i, -VALENCE_BOOST_POWER);
+    }
+  }
+};
+
+// 'cachePosition' is -1 for a vertex that is not in the cache
+inline float VertexScore(const ScoreTables &tables, int cachePosition,
+                         unsigned int remaining) {
+  if (remaining == 0) {
+    return -1.0f;
+  }
+  float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+  return score + tables.valence[remaining < MAX_VALENCE ? remaining
+                                                        : MAX_VALENCE];
+}
+
+} // namespace
+
+// Greedily adds the triangle with the best score, where a triangle's
+// score is the sum of its vertices' scores. Only triangles that use a
+// vertex in the cache are rescored after each step, which keeps this
+// close to linear in the number of triangles.
+void MeshOptimizer::OptimizeVertexCache(GLuint *indices,
+                                        std::size_t indexCount,
+                                        std::size_t vertexCount) {
+  static const ScoreTables tables;
+  std::size_t triangleCount = indexCount / 3;
+  if (triangleCount < 2) {
+    return;
+  }
+
+  // The triangles that use each vertex, all in one list. The triangles
+  // of vertex v start at triangleStarts[v], and the first remaining[v]
+  // of them have not been added yet.
+  std::vector<unsigned int> triangleStarts(vertexCount + 1, 0);
+  for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+    ++triangleStarts[indices[i] + 1];
+  }
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    triangleStarts[v + 1] += triangleStarts[v];
+  }
+  std::vector<unsigned int> remaining(vertexCount, 0);
+  std::vector<unsigned int> vertexTriangles(triangleCount * 3);
+  for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+    GLuint v = indices[i];
+    vertexTriangles[triangleStarts[v] + remaining[v]++] = i / 3;
+  }
+
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> vertexScores(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    vertexScores[v] = VertexScore(tables, -1, remaining[v]);
+  }
+  std::vector<float> triangleScores(triangleCount);
+  std::vector<bool> added(triangleCount, false);
+  std::size_t bestTriangle = 0;
+  for (std::size_t t = 0; t < triangleCount; ++t) {
+    triangleScores[t] = vertexScores[indices[t * 3]] +
+                        vertexScores[indices[t * 3 + 1]] +
+                        vertexScores[indices[t * 3 + 2]];
+    if (triangleScores[t] > triangleScores[bestTriangle]) {
+      bestTriangle = t;
+    }
+  }
+
+  // Most recently used first, with room for the three being added
+  GLuint cache[CACHE_SIZE + 3];
+  unsigned int cacheCount = 0;
+  std::vector<GLuint> output(triangleCount * 3);
+  std::size_t nextUnadded = 0;
+  for (std::size_t outputTriangle = 0; outputTriangle < triangleCount;
+       ++outputTriangle) {
+    const GLuint *triangle = &indices[bestTriangle * 3];
+    std::memcpy(&output[outputTriangle * 3], triangle, 3 * sizeof(GLuint));
+    added[bestTriangle] = true;
+
+    // The triangle no longer counts towards its vertices' remaining
+    // triangles (once per corner, as degenerate triangles are listed
+    // twice for the same vertex)
+    for (unsigned int k = 0; k < 3; ++k) {
+      GLuint v = triangle[k];
+      unsigned int *first = &vertexTriangles[triangleStarts[v]];
+      for (unsigned int i = 0; i < remaining[v]; ++i) {
+        if (first[i] == bestTriangle) {
+          first[i] = first[--remaining[v]];
+          break;
+        }
+      }
+    }
+
+    // Its vertices go to the front of the cache
+    GLuint newCache[CACHE_SIZE + 3];
+    unsigned int newCount = 0;
+    for (unsigned int k = 0; k < 3; ++k) {
+      GLuint v = triangle[k];
+      if (newCount == 0 || (newCache[0] != v && newCache[newCount - 1] != v)) {
+        newCache[newCount++] = v;
+      }
+    }
+    for (unsigned int i = 0; i < cacheCount; ++i) {
+      GLuint v = cache[i];
+      if (v != newCache[0] && (newCount < 2 || v != newCache[1]) &&
+          (newCount < 3 || v != newCache[2])) {
+        newCache[newCount++] = v;
+      }
+    }
+
+    // Rescore every vertex that moved, including the ones that fell out
+    // of the cache, and pass the change on to their triangles.
+    for (unsigned int i = 0; i < newCount; ++i) {
+      GLuint v = newCache[i];
+      cachePosition[v] = i < CACHE_SIZE ? (int)i : -1;
+      float score = VertexScore(tables, cachePosition[v], remaining[v]);
+      float change = score - vertexScores[v];
+      vertexScores[v] = score;
+      const unsigned int *first = &vertexTriangles[triangleStarts[v]];
+      for (unsigned int t = 0; t < remaining[v]; ++t) {
+        triangleScores[first[t]] += change;
+      }
+    }
+    cacheCount = newCount < CACHE_SIZE ? newCount : CACHE_SIZE;
+    std::memcpy(cache, newCache, cacheCount * sizeof(GLuint));
+
+    // The next triangle is the best one that uses a cached vertex
+    float bestScore = -1.0f;
+    for (unsigned int i = 0; i < cacheCount; ++i) {
+      GLuint v = cache[i];
+      const unsigned int *first = &vertexTriangles[triangleStarts[v]];
+      for (unsigned int t = 0; t < remaining[v]; ++t) {
+        if (triangleScores[first[t]] > bestScore) {
+          bestScore = triangleScores[first[t]];
+          bestTriangle = first[t];
+        }
+      }
+    }
+    // If the cache has nothing left to offer, start again anywhere
+    if (bestScore < 0.0f) {
+      while (nextUnadded < triangleCount && added[nextUnadded]) {
+        ++nextUnadded;
+      }
+      bestTriangle = nextUnadded;
+    }
+  }
+  std::memcpy(indices, output.data(), output.size() * sizeof(GLuint));
+}
+
+// Numbers the vertices in the order they are first used
+void MeshOptimizer::OptimizeVertexFetch(void *vertices,
+                                        std::size_t vertexCount,
+                                        std::size_t vertexStride,
+                                        GLuint *indices,
+                                        std::size_t indexCount) {
+  const GLuint UNUSED = ~0u;
+  std::vector<GLuint> remap(vertexCount, UNUSED);
+  GLuint next = 0;
+  for (std::size_t i = 0; i < indexCount; ++i) {
+    if (remap[indices[i]] == UNUSED) {
+      remap[indices[i]] = next++;
+    }
+    indices[i] = remap[indices[i]];
+  }
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    if (remap[v] == UNUSED) {
+      remap[v] = next++;
+    }
+  }
+
+  uint8_t *data = static_cast<uint8_t *>(vertices);
+  std::vector<uint8_t> original(data, data + vertexCount * vertexStride);
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    std::memcpy(data + remap[v] * vertexStride, &original[v * vertexStride],
+                vertexStride);
+  }
+}
+
+// A vertex is in a first-in first-out cache if fewer than 'cacheSize'
+// misses have happened since it was loaded.
+double MeshOptimizer::ComputeACMR(const GLuint *indices,
+                                  std::size_t indexCount,
+                                  std::size_t vertexCount,
+                                  unsigned int cacheSize) {
+  std::size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0) {
+    return 0.0;
+  }
+  // The miss that loaded each vertex (0 if it was never loaded)
+  std::vector<std::size_t> loadedAt(vertexCount, 0);
+  std::size_t misses = 0;
+  for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+    GLuint v = indices[i];
+    if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize) {
+      loadedAt[v] = ++misses;
+    }
+  }
+  return (double)misses / triangleCount;
+}
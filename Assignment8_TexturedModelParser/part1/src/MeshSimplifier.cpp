@@ -0,0 +1,360 @@
+#include "MeshSimplifier.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+// The sum of squared distances to a set of planes, as a symmetric 4x4
+// matrix (only the upper triangle is stored). Each plane is weighted by
+// the area of its triangle, and 'weight' is the total area, so that
+// Distance() can turn the error back into a length.
+struct Quadric {
+  double a00{0}, a01{0}, a02{0}, a03{0};
+  double a11{0}, a12{0}, a13{0};
+  double a22{0}, a23{0};
+  double a33{0};
+  double weight{0};
+
+  // Adds the plane dot(normal, p) + d = 0
+  void AddPlane(const glm::dvec3 &n, double d, double area) {
+    a00 += area * n.x * n.x;
+    a01 += area * n.x * n.y;
+    a02 += area * n.x * n.z;
+    a03 += area * n.x * d;
+    a11 += area * n.y * n.y;
+    a12 += area * n.y * n.z;
+    a13 += area * n.y * d;
+    a22 += area * n.z * n.z;
+    a23 += area * n.z * d;
+    a33 += area * d * d;
+    weight += area;
+  }
+
+  void Add(const Quadric &q) {
+    a00 += q.a00;
+    a01 += q.a01;
+    a02 += q.a02;
+    a03 += q.a03;
+    a11 += q.a11;
+    a12 += q.a12;
+    a13 += q.a13;
+    a22 += q.a22;
+    a23 += q.a23;
+    a33 += q.a33;
+    weight += q.weight;
+  }
+
+  // Area weighted sum of squared distances from 'p' to the planes
+  double Error(const glm::vec3 &p) const {
+    double x = p.x, y = p.y, z = p.z;
+    double error = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z +
+                   2.0 * a03 * x + a11 * y * y + 2.0 * a12 * y * z +
+                   2.0 * a13 * y + a22 * z * z + 2.0 * a23 * z + a33;
+    return std::max(error, 0.0);
+  }
+
+  // Average distance from 'p' to the planes
+  double Distance(const glm::vec3 &p) const {
+    return weight > 0.0 ? std::sqrt(Error(p) / weight) : 0.0;
+  }
+};
+
+// Moving 'from' onto 'to' (both welded vertices)
+struct Collapse {
+  GLuint from;
+  GLuint to;
+  double cost;
+};
+
+struct PositionHash {
+  std::size_t operator()(const glm::vec3 &p) const {
+    std::hash<float> hash;
+    return hash(p.x) * 73856093u ^ hash(p.y) * 19349663u ^
+           hash(p.z) * 83492791u;
+  }
+};
+
+// Squared distance between the attributes (the floats after the
+// position) of two vertices
+float AttributeDistance(const uint8_t *a, const uint8_t *b,
+                        std::size_t vertexStride) {
+  float distance = 0.0f;
+  std::size_t end = vertexStride - vertexStride % sizeof(float);
+  for (std::size_t offset = sizeof(glm::vec3); offset < end;
+       offset += sizeof(float)) {
+    float x, y;
+    std::memcpy(&x, a + offset, sizeof(float));
+    std::memcpy(&y, b + offset, sizeof(float));
+    distance += (x - y) * (x - y);
+  }
+  return distance;
+}
+
+inline uint64_t EdgeKey(GLuint a, GLuint b) {
+  return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+}
+
+} // namespace
+
+// Works in passes. Each pass scores every edge, then collapses the
+// cheapest ones, skipping any edge next to a triangle that already
+// changed in this pass (its score would be out of date).
+std::vector<GLuint> MeshSimplifier::Simplify(const GLuint *indices,
+                                             std::size_t indexCount,
+                                             const void *vertices,
+                                             std::size_t vertexCount,
+                                             std::size_t vertexStride,
+                                             std::size_t targetIndexCount,
+                                             float *error) {
+  std::vector<GLuint> result(indices, indices + indexCount / 3 * 3);
+  if (error != nullptr) {
+    *error = 0.0f;
+  }
+  if (result.size() <= targetIndexCount) {
+    return result;
+  }
+
+  std::vector<glm::vec3> positions(vertexCount);
+  const uint8_t *bytes = static_cast<const uint8_t *>(vertices);
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    std::memcpy(&positions[v], bytes + v * vertexStride, sizeof(glm::vec3));
+  }
+
+  // Weld every vertex to the first vertex with the same position. From
+  // here on, 'welded' vertices are what gets collapsed, and the real
+  // vertices (with their own texture coordinates and normals) follow.
+  std::vector<GLuint> welded(vertexCount);
+  std::unordered_map<glm::vec3, GLuint, PositionHash> firstAt;
+  firstAt.reserve(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    welded[v] = firstAt.emplace(positions[v], (GLuint)v).first->second;
+  }
+
+  // Lock the border: welded edges that are not shared by exactly two
+  // triangles.
+  std::vector<bool> locked(vertexCount, false);
+  {
+    std::unordered_map<uint64_t, unsigned int> edgeUses;
+    edgeUses.reserve(result.size());
+    for (std::size_t t = 0; t < result.size(); t += 3) {
+      for (int k = 0; k < 3; ++k) {
+        GLuint a = welded[result[t + k]];
+        GLuint b = welded[result[t + (k + 1) % 3]];
+        if (a != b) {
+          ++edgeUses[EdgeKey(a, b)];
+        }
+      }
+    }
+    for (const auto &edge : edgeUses) {
+      if (edge.second != 2) {
+        locked[edge.first >> 32] = true;
+        locked[edge.first & 0xffffffffu] = true;
+      }
+    }
+  }
+
+  // Each welded vertex starts with the planes of its triangles
+  std::vector<Quadric> quadrics(vertexCount);
+  for (std::size_t t = 0; t < result.size(); t += 3) {
+    GLuint a = welded[result[t]];
+    GLuint b = welded[result[t + 1]];
+    GLuint c = welded[result[t + 2]];
+    glm::dvec3 p0(positions[a]), p1(positions[b]), p2(positions[c]);
+    glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+    double length = glm::length(normal);
+    if (length == 0.0) {
+      continue;
+    }
+    normal /= length;
+    double d = -glm::dot(normal, p0);
+    quadrics[a].AddPlane(normal, d, length * 0.5);
+    quadrics[b].AddPlane(normal, d, length * 0.5);
+    quadrics[c].AddPlane(normal, d, length * 0.5);
+  }
+
+  double largestDistance = 0.0;
+  std::vector<unsigned int> triangleStarts(vertexCount + 1);
+  std::vector<unsigned int> vertexTriangles;
+  std::vector<Collapse> collapses;
+  std::vector<GLuint> remap(vertexCount);
+  std::vector<bool> touched(vertexCount);
+  std::vector<std::pair<GLuint, GLuint>> partners;
+  while (result.size() > targetIndexCount) {
+    // The triangles around each welded vertex
+    std::fill(triangleStarts.begin(), triangleStarts.end(), 0);
+    for (GLuint index : result) {
+      ++triangleStarts[welded[index] + 1];
+    }
+    std::partial_sum(triangleStarts.begin(), triangleStarts.end(),
+                     triangleStarts.begin());
+    std::vector<unsigned int> cursor(triangleStarts.begin(),
+                                     triangleStarts.end() - 1);
+    vertexTriangles.resize(result.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      vertexTriangles[cursor[welded[result[i]]]++] = i / 3;
+    }
+
+    // Score each edge once (from the triangle that has it as a -> b
+    // with a < b), in whichever direction is cheaper.
+    collapses.clear();
+    for (std::size_t t = 0; t < result.size(); t += 3) {
+      for (int k = 0; k < 3; ++k) {
+        GLuint a = welded[result[t + k]];
+        GLuint b = welded[result[t + (k + 1) % 3]];
+        if (a >= b || (locked[a] && locked[b])) {
+          continue;
+        }
+        Quadric merged = quadrics[a];
+        merged.Add(quadrics[b]);
+        double infinity = std::numeric_limits<double>::infinity();
+        double costAB = locked[a] ? infinity : merged.Error(positions[b]);
+        double costBA = locked[b] ? infinity : merged.Error(positions[a]);
+        if (costAB <= costBA) {
+          collapses.push_back({a, b, costAB});
+        } else {
+          collapses.push_back({b, a, costBA});
+        }
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse &x, const Collapse &y) {
+                return x.cost < y.cost;
+              });
+
+    // Each collapse removes about two triangles
+    std::size_t budget = (result.size() - targetIndexCount) / 6 + 1;
+    std::size_t collapsed = 0;
+    std::iota(remap.begin(), remap.end(), 0);
+    std::fill(touched.begin(), touched.end(), false);
+    for (const Collapse &collapse : collapses) {
+      if (collapsed >= budget) {
+        break;
+      }
+      GLuint from = collapse.from, to = collapse.to;
+      if (touched[from] || touched[to]) {
+        continue;
+      }
+      const unsigned int *first = &vertexTriangles[triangleStarts[from]];
+      unsigned int count = triangleStarts[from + 1] - triangleStarts[from];
+
+      // Each corner at 'from' takes the attributes of the corner at
+      // 'to' that it shares a triangle with. The triangles that are
+      // not removed must not flip over.
+      partners.clear();
+      bool valid = true;
+      for (unsigned int i = 0; i < count && valid; ++i) {
+        const GLuint *triangle = &result[first[i] * 3];
+        int corner = 0;
+        while (welded[triangle[corner]] != from) {
+          ++corner;
+        }
+        GLuint next = triangle[(corner + 1) % 3];
+        GLuint previous = triangle[(corner + 2) % 3];
+        if (welded[next] == to || welded[previous] == to) {
+          GLuint partner = welded[next] == to ? next : previous;
+          partners.emplace_back(triangle[corner], partner);
+          continue;
+        }
+        glm::vec3 edge1 = positions[next] - positions[from];
+        glm::vec3 edge2 = positions[previous] - positions[from];
+        glm::vec3 moved1 = positions[next] - positions[to];
+        glm::vec3 moved2 = positions[previous] - positions[to];
+        valid = glm::dot(glm::cross(edge1, edge2), glm::cross(moved1, moved2)) >
+                0.0f;
+      }
+      if (!valid) {
+        continue;
+      }
+      // A corner that shares no triangle with 'to' is on the other side
+      // of a seam (e.g. a hard edge), and takes the closest attributes
+      // found at 'to' instead
+      for (unsigned int i = 0; i < count; ++i) {
+        GLuint corner = 0;
+        for (int k = 0; k < 3; ++k) {
+          if (welded[result[first[i] * 3 + k]] == from) {
+            corner = result[first[i] * 3 + k];
+          }
+        }
+        bool found = false;
+        for (const auto &partner : partners) {
+          found = found || partner.first == corner;
+        }
+        if (found) {
+          continue;
+        }
+        GLuint closest = to;
+        float closestDistance = std::numeric_limits<float>::max();
+        for (unsigned int j = triangleStarts[to]; j < triangleStarts[to + 1];
+             ++j) {
+          for (int k = 0; k < 3; ++k) {
+            GLuint candidate = result[vertexTriangles[j] * 3 + k];
+            if (welded[candidate] != to) {
+              continue;
+            }
+            float distance =
+                AttributeDistance(bytes + corner * vertexStride,
+                                  bytes + candidate * vertexStride,
+                                  vertexStride);
+            if (distance < closestDistance) {
+              closestDistance = distance;
+              closest = candidate;
+            }
+          }
+        }
+        partners.emplace_back(corner, closest);
+      }
+
+      for (const auto &partner : partners) {
+        if (remap[partner.first] == partner.first) {
+          remap[partner.first] = partner.second;
+        }
+      }
+      quadrics[to].Add(quadrics[from]);
+      largestDistance =
+          std::max(largestDistance, quadrics[to].Distance(positions[to]));
+      // Everything around 'from' changed shape, so leave it for the
+      // next pass
+      for (unsigned int i = 0; i < count; ++i) {
+        for (int corner = 0; corner < 3; ++corner) {
+          touched[welded[result[first[i] * 3 + corner]]] = true;
+        }
+      }
+      touched[to] = true;
+      ++collapsed;
+    }
+    if (collapsed == 0) {
+      break;
+    }
+
+    // Move the collapsed corners, and drop the triangles that
+    // collapsed to a line
+    std::size_t kept = 0;
+    for (std::size_t t = 0; t < result.size(); t += 3) {
+      GLuint a = remap[result[t]];
+      GLuint b = remap[result[t + 1]];
+      GLuint c = remap[result[t + 2]];
+      if (welded[a] == welded[b] || welded[b] == welded[c] ||
+          welded[a] == welded[c]) {
+        continue;
+      }
+      result[kept++] = a;
+      result[kept++] = b;
+      result[kept++] = c;
+    }
+    result.resize(kept);
+  }
+
+  if (error != nullptr) {
+    *error = (float)largestDistance;
+  }
+  return result;
+}
@@ -1,5 +1,391 @@
 #include "OBJModel.hpp"
+#include "MappedFile.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
 #include <sstream>
+#include <string_view>
+#include <thread>
+
+// Helpers for reading the .obj file in place. Each one takes a pointer
+// into the line and the end of the line, and returns where it stopped,
+// so no strings are ever copied out of the file.
+namespace {
+
+// Tokens on a line are separated by spaces or tabs. Lines from
+// Windows files also end in '\r', which we treat the same way.
+inline bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline const char *SkipSpaces(const char *p, const char *end) {
+  while (p < end && IsSpace(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+inline const char *SkipToken(const char *p, const char *end) {
+  while (p < end && !IsSpace(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+// Reads the next whitespace separated word
+inline std::string_view NextToken(const char *&p, const char *end) {
+  p = SkipSpaces(p, end);
+  const char *start = p;
+  p = SkipToken(p, end);
+  return std::string_view(start, p - start);
+}
+
+// The rest of the line without surrounding spaces, for names that
+// may contain spaces
+inline std::string_view RestOfLine(const char *p, const char *end) {
+  p = SkipSpaces(p, end);
+  while (end > p && IsSpace(end[-1])) {
+    --end;
+  }
+  return std::string_view(p, end - p);
+}
+
+// Reads a number, leaving 'value' at 0 if there is none.
+// from_chars does not accept a leading '+', so we skip it.
+template <typename T>
+inline const char *ParseNumber(const char *p, const char *end, T &value) {
+  value = 0;
+  if (p < end && *p == '+') {
+    ++p;
+  }
+  std::from_chars_result result = std::from_chars(p, end, value);
+  if (result.ec != std::errc()) {
+    return SkipToken(p, end);
+  }
+  return result.ptr;
+}
+
+// Turns an .obj index (counting from 1, or back from the end of the
+// list when negative) into an index into a list of 'count' items.
+// Returns -1 if the index is missing or out of range.
+inline long ResolveIndex(long index, std::size_t count) {
+  long resolved = index > 0 ? index - 1 : (long)count + index;
+  if (index == 0 || resolved < 0 || resolved >= (long)count) {
+    return -1;
+  }
+  return resolved;
+}
+
+// One corner of a face, as indices into the position,
+// texture coordinate and normal lists (-1 if not given).
+struct FaceCorner {
+  long position;
+  long texCoord;
+  long normal;
+};
+
+// Identifies a unique vertex: the position, texture coordinate and
+// normal it was built from. Corners with the same key are the same
+// vertex, so they can share one entry in the vertex buffer.
+struct VertexKey {
+  long position;
+  long texCoord;
+  // Corners without a normal get their face's normal, so they are
+  // never shared. Their key has a normal of -1.
+  long normal;
+
+  bool operator==(const VertexKey &other) const {
+    return position == other.position && texCoord == other.texCoord &&
+           normal == other.normal;
+  }
+};
+
+struct VertexKeyHash {
+  std::size_t operator()(const VertexKey &key) const {
+    return (std::size_t)key.position * 73856093u ^
+           (std::size_t)key.texCoord * 19349663u ^
+           (std::size_t)key.normal * 83492791u;
+  }
+};
+
+typedef std::unordered_map<VertexKey, GLuint, VertexKeyHash> VertexLookup;
+
+// A face as written in the file. Its indices cannot be resolved until
+// we know how many positions, texture coordinates and normals came
+// before the chunk it is in, so we remember how many the chunk had
+// read when it reached the face.
+struct RawFace {
+  unsigned int firstCorner;
+  unsigned int cornerCount;
+  unsigned int positionCount;
+  unsigned int texCoordCount;
+  unsigned int normalCount;
+  // The chunk's last usemtl before the face (-1 if there was none)
+  int material;
+};
+
+// Consecutive triangles of a chunk that use the same material
+struct MaterialRun {
+  unsigned int material;
+  std::size_t firstIndex;
+  std::size_t indexCount;
+};
+
+// Used before any usemtl line has been read
+const unsigned int NO_MATERIAL = ~0u;
+
+// Everything read from one chunk of the file
+struct OBJChunk {
+  const char *begin;
+  const char *end;
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec2> texCoords;
+  std::vector<glm::vec3> normals;
+  // The indices exactly as written (0 when not given)
+  std::vector<long> corners;
+  std::vector<RawFace> faces;
+  // Where this chunk's positions, texture coordinates and normals
+  // start in the whole file (filled in by the prefix sum)
+  unsigned int positionOffset;
+  unsigned int texCoordOffset;
+  unsigned int normalOffset;
+  // The chunk's unique vertices (and the key of each one), and its
+  // triangles as indices into them
+  std::vector<OBJModel::Vertex> vertices;
+  std::vector<VertexKey> keys;
+  std::vector<GLuint> indices;
+  // Where the chunk's indices start in the whole model
+  std::size_t indexOffset;
+  // The index of each of the chunk's vertices in the whole model
+  std::vector<GLuint> remap;
+  unsigned int skippedFaces;
+  // The last mtllib line in the chunk, if any
+  std::string materialLibrary;
+  // Every usemtl name in the chunk, and true if there are faces
+  // before the first one
+  std::vector<std::string> materialNames;
+  bool facesBeforeMaterial;
+  // The model's number for each of those names, and for the material
+  // the previous chunk ended with (filled in by step 2)
+  std::vector<unsigned int> materialIds;
+  unsigned int inheritedMaterial;
+  // The chunk's triangles, split up by material
+  std::vector<MaterialRun> runs;
+};
+
+// Don't bother handing less than this much of a file to a thread
+const std::size_t MIN_CHUNK_BYTES = 32 * 1024;
+
+// Runs 'work(i)' for i = 0..count-1, each on its own thread
+// (the last one on the calling thread).
+template <typename F> void RunOnThreads(std::size_t count, F work) {
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i + 1 < count; ++i) {
+    threads.emplace_back(work, i);
+  }
+  if (count > 0) {
+    work(count - 1);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+// Reads the positions, texture coordinates, normals and faces of one
+// chunk. Faces are stored unresolved, see RawFace.
+void ParseChunk(OBJChunk &chunk) {
+  const char *lineStart = chunk.begin;
+  while (lineStart < chunk.end) {
+    const char *lineEnd = static_cast<const char *>(
+        std::memchr(lineStart, '\n', chunk.end - lineStart));
+    if (lineEnd == nullptr) {
+      lineEnd = chunk.end;
+    }
+    const char *p = lineStart;
+    lineStart = lineEnd + 1;
+
+    std::string_view prefix = NextToken(p, lineEnd);
+    if (prefix == "v") {
+      glm::vec3 vertex;
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, vertex.x);
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, vertex.y);
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, vertex.z);
+      chunk.positions.push_back(vertex);
+    } else if (prefix == "vt") {
+      glm::vec2 texCoord;
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, texCoord.x);
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, texCoord.y);
+      chunk.texCoords.push_back(texCoord);
+    } else if (prefix == "vn") {
+      glm::vec3 normal;
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, normal.x);
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, normal.y);
+      p = ParseNumber(SkipSpaces(p, lineEnd), lineEnd, normal.z);
+      chunk.normals.push_back(normal);
+    } else if (prefix == "f") {
+      // Each corner is v, v/vt, v//vn or v/vt/vn
+      RawFace face{(unsigned int)chunk.corners.size() / 3, 0,
+                   (unsigned int)chunk.positions.size(),
+                   (unsigned int)chunk.texCoords.size(),
+                   (unsigned int)chunk.normals.size(),
+                   (int)chunk.materialNames.size() - 1};
+      chunk.facesBeforeMaterial =
+          chunk.facesBeforeMaterial || face.material < 0;
+      for (p = SkipSpaces(p, lineEnd); p < lineEnd;
+           p = SkipSpaces(p, lineEnd)) {
+        long v = 0, vt = 0, vn = 0;
+        p = ParseNumber(p, lineEnd, v);
+        if (p < lineEnd && *p == '/') {
+          ++p;
+          if (p < lineEnd && *p != '/') {
+            p = ParseNumber(p, lineEnd, vt);
+          }
+          if (p < lineEnd && *p == '/') {
+            p = ParseNumber(p + 1, lineEnd, vn);
+          }
+        }
+        chunk.corners.push_back(v);
+        chunk.corners.push_back(vt);
+        chunk.corners.push_back(vn);
+        ++face.cornerCount;
+        p = SkipToken(p, lineEnd);
+      }
+      chunk.faces.push_back(face);
+    } else if (prefix == "usemtl") {
+      chunk.materialNames.emplace_back(RestOfLine(p, lineEnd));
+    } else if (prefix == "mtllib") {
+      chunk.materialLibrary = RestOfLine(p, lineEnd);
+    }
+    // Anything else (comments, groups, s, ...) is ignored
+  }
+}
+
+// Resolves the faces of one chunk against the positions, texture
+// coordinates and normals of the whole file, and builds its triangles.
+// Corners that share a position, texture coordinate and normal share
+// one vertex. The triangles are recorded in runs of the same material.
+void BuildChunkVertices(OBJChunk &chunk,
+                        const std::vector<glm::vec3> &positions,
+                        const std::vector<glm::vec2> &texCoords,
+                        const std::vector<glm::vec3> &normals) {
+  // Reused for every face, so only the first few faces allocate
+  std::vector<FaceCorner> corners;
+  chunk.skippedFaces = 0;
+  // Most models have far fewer vertices than corners
+  VertexLookup lookup;
+  lookup.reserve(chunk.corners.size() / 3 / 4);
+  for (const RawFace &face : chunk.faces) {
+    // Indices are resolved against what had been read when the
+    // face was reached, exactly as if we had read the file in order.
+    std::size_t positionCount = chunk.positionOffset + face.positionCount;
+    std::size_t texCoordCount = chunk.texCoordOffset + face.texCoordCount;
+    std::size_t normalCount = chunk.normalOffset + face.normalCount;
+    corners.clear();
+    bool valid = face.cornerCount >= 3;
+    for (unsigned int c = 0; c < face.cornerCount; ++c) {
+      const long *raw = &chunk.corners[(face.firstCorner + c) * 3];
+      FaceCorner corner{ResolveIndex(raw[0], positionCount),
+                        ResolveIndex(raw[1], texCoordCount),
+                        ResolveIndex(raw[2], normalCount)};
+      valid = valid && corner.position >= 0 &&
+              (raw[1] == 0 || corner.texCoord >= 0) &&
+              (raw[2] == 0 || corner.normal >= 0);
+      corners.push_back(corner);
+    }
+    if (!valid) {
+      ++chunk.skippedFaces;
+      continue;
+    }
+    unsigned int material = face.material < 0
+                                ? chunk.inheritedMaterial
+                                : chunk.materialIds[face.material];
+    std::size_t firstIndex = chunk.indices.size();
+    // Faces without normals get the normal of the face itself
+    glm::vec3 faceNormal(0.0f);
+    bool missingNormals = false;
+    for (const FaceCorner &corner : corners) {
+      missingNormals = missingNormals || corner.normal < 0;
+    }
+    if (missingNormals) {
+      glm::vec3 edge0 =
+          positions[corners[1].position] - positions[corners[0].position];
+      glm::vec3 edge1 =
+          positions[corners[2].position] - positions[corners[0].position];
+      glm::vec3 cross = glm::cross(edge0, edge1);
+      float length = glm::length(cross);
+      faceNormal =
+          length > 0.0f ? cross / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+    // Faces with more than three corners are split into a fan
+    for (std::size_t i = 1; i + 1 < corners.size(); ++i) {
+      const FaceCorner *triangle[3] = {&corners[0], &corners[i],
+                                       &corners[i + 1]};
+      for (const FaceCorner *corner : triangle) {
+        VertexKey key{corner->position, corner->texCoord, corner->normal};
+        if (key.normal >= 0) {
+          auto found = lookup.find(key);
+          if (found != lookup.end()) {
+            chunk.indices.push_back(found->second);
+            continue;
+          }
+          lookup.emplace(key, (GLuint)chunk.vertices.size());
+        }
+        OBJModel::Vertex vertex;
+        vertex.position = positions[corner->position];
+        vertex.texCoords = corner->texCoord >= 0 ? texCoords[corner->texCoord]
+                                                 : glm::vec2(0.0f);
+        vertex.normal =
+            corner->normal >= 0 ? normals[corner->normal] : faceNormal;
+        chunk.indices.push_back(chunk.vertices.size());
+        chunk.vertices.push_back(vertex);
+        chunk.keys.push_back(key);
+      }
+    }
+    std::size_t indexCount = chunk.indices.size() - firstIndex;
+    if (!chunk.runs.empty() && chunk.runs.back().material == material) {
+      chunk.runs.back().indexCount += indexCount;
+    } else {
+      chunk.runs.push_back({material, firstIndex, indexCount});
+    }
+  }
+}
+
+// Levels of detail stop once a level would have fewer triangles than
+// this, would keep more than LOD_MAX_KEPT of the level before it, or
+// would move the surface further than LOD_MAX_ERROR of the bounding
+// radius (low poly models run out of detail to remove quickly)
+const std::size_t LOD_MIN_TRIANGLES = 64;
+const float LOD_MAX_KEPT = 0.9f;
+const float LOD_MAX_ERROR = 0.25f;
+
+// Number of times render() binds a texture when drawing the full
+// detail 'submeshes' in order
+unsigned int
+CountTextureBinds(const std::vector<OBJModel::Submesh> &submeshes,
+                  const std::vector<Material> &materials) {
+  unsigned int binds = 0;
+  const Texture *bound[3] = {nullptr, nullptr, nullptr};
+  for (const OBJModel::Submesh &submesh : submeshes) {
+    if (submesh.lod != 0) {
+      continue;
+    }
+    const Material &material = materials[submesh.material];
+    const Texture *textures[3] = {material.map_kd, material.map_bump,
+                                  material.map_ks};
+    for (unsigned int slot = 0; slot < 3; ++slot) {
+      if (textures[slot] != nullptr && textures[slot] != bound[slot]) {
+        bound[slot] = textures[slot];
+        ++binds;
+      }
+    }
+  }
+  return binds;
+}
+
+} // namespace
 
 // Default constructor
 OBJModel::OBJModel() {
@@ -10,7 +396,8 @@ OBJModel::OBJModel() {
 OBJModel::OBJModel(const std::string &filepath) { loadModelFromFile(filepath); }
 
 // Sets up the vertex buffer objects and vertex array object
-void OBJModel::setupBuffers() {
+void OBJModel::setupBuffers(const void *vertexData, std::size_t vertexCount,
+                            const GLuint *indexData, std::size_t indexCount) {
   glGenVertexArrays(1, &vao);
   glGenBuffers(1, &vbo);
   glGenBuffers(1, &ebo);
@@ -18,12 +405,13 @@ void OBJModel::setupBuffers() {
   glBindVertexArray(vao);
 
   glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
-               vertices.data(), GL_STATIC_DRAW);
+  glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData,
+               GL_STATIC_DRAW);
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-               indices.data(), GL_STATIC_DRAW);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int),
+               indexData, GL_STATIC_DRAW);
+  elementCount = static_cast<GLsizei>(indexCount);
 
   // Vertex positions
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
@@ -48,9 +436,10 @@ void OBJModel::setupBuffers() {
 
 // Sets the shader material uniforms
 void OBJModel::SetShaderMaterialUniforms(GLuint shaderProgram) {
-  glUniform3fv(glGetUniformLocation(shaderProgram, "ka"), 1, material.ka);
-  glUniform3fv(glGetUniformLocation(shaderProgram, "kd"), 1, material.kd);
-  glUniform3fv(glGetUniformLocation(shaderProgram, "ks"), 1, material.ks);
+  // The colors change with every submesh, so render() sets them
+  kaLocation = glGetUniformLocation(shaderProgram, "ka");
+  kdLocation = glGetUniformLocation(shaderProgram, "kd");
+  ksLocation = glGetUniformLocation(shaderProgram, "ks");
 
   // Set the uniform for the texture sampler to the appropriate texture unit
   glUniform1i(glGetUniformLocation(shaderProgram, "u_DiffuseMap"),
@@ -61,91 +450,330 @@ void OBJModel::SetShaderMaterialUniforms(GLuint shaderProgram) {
               2); // Corresponds to GL_TEXTURE2
 }
 
-// Renders the model by binding the VAO and drawing its elements
-void OBJModel::render() const {
+// Renders the model by binding the VAO and drawing the elements of
+// one level of detail
+void OBJModel::render(unsigned int lod) const {
+  lod = std::min(lod, lodCount - 1);
   glBindVertexArray(vao);
 
-  if (material.map_kd.GetImage()) {
-    glActiveTexture(GL_TEXTURE0);
-    material.map_kd.Bind(0);
+  // Submeshes with the same textures are next to each other, so
+  // only bind a texture when it differs from the last submesh's.
+  const Texture *bound[3] = {nullptr, nullptr, nullptr};
+  for (const Submesh &submesh : submeshes) {
+    if (submesh.lod != lod) {
+      continue;
+    }
+    const Material &material = materials[submesh.material];
+    const Texture *textures[3] = {material.map_kd, material.map_bump,
+                                  material.map_ks};
+    for (unsigned int slot = 0; slot < 3; ++slot) {
+      if (textures[slot] != nullptr && textures[slot] != bound[slot]) {
+        textures[slot]->Bind(slot);
+        bound[slot] = textures[slot];
+      }
+    }
+    if (kaLocation >= 0) {
+      glUniform3fv(kaLocation, 1, material.ka);
+    }
+    if (kdLocation >= 0) {
+      glUniform3fv(kdLocation, 1, material.kd);
+    }
+    if (ksLocation >= 0) {
+      glUniform3fv(ksLocation, 1, material.ks);
+    }
+    glDrawElements(GL_TRIANGLES, submesh.indexCount, GL_UNSIGNED_INT,
+                   (void *)(submesh.firstIndex * sizeof(GLuint)));
   }
+  glBindVertexArray(0);
+}
 
-  if (material.map_bump.GetImage()) {
-    glActiveTexture(GL_TEXTURE1);
-    material.map_kd.Bind(1);
+// Loads the model data from the specified .obj file. If the file has
+// not changed since it was last loaded, the buffers come straight out
+// of its mesh cache instead.
+void OBJModel::loadModelFromFile(const std::string &filepath) {
+  std::string directory = filepath.substr(0, filepath.find_last_of("/\\") + 1);
+
+  MeshCache cache;
+  if (cache.Open(filepath, sizeof(Vertex))) {
+    const MeshCacheHeader &header = cache.GetHeader();
+    std::cout << "Loaded " << filepath << " from its mesh cache: "
+              << header.vertexCount << " vertices, " << header.indexCount
+              << " indices" << std::endl;
+    vertices.clear();
+    indices.clear();
+    submeshes.clear();
+    materials.clear();
+    materialLibraryPath.clear();
+    lodCount = 1;
+    for (uint32_t i = 0; i < header.submeshCount; ++i) {
+      const MeshCacheSubmesh &range = cache.GetSubmeshes()[i];
+      submeshes.push_back(
+          {range.firstIndex, range.indexCount,
+           std::string(cache.GetString(range.nameOffset, range.nameLength)),
+           0, range.lod});
+      lodCount = std::max(lodCount, range.lod + 1);
+    }
+    glm::vec3 boundsMin(header.boundsMin[0], header.boundsMin[1],
+                        header.boundsMin[2]);
+    glm::vec3 boundsMax(header.boundsMax[0], header.boundsMax[1],
+                        header.boundsMax[2]);
+    boundsCenter = (boundsMin + boundsMax) * 0.5f;
+    boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+    if (!cache.GetMaterialLibrary().empty()) {
+      materialLibraryPath =
+          directory + std::string(cache.GetMaterialLibrary());
+      LoadMaterials(materialLibraryPath);
+    }
+    sortSubmeshes();
+    setupBuffers(cache.GetVertexData(), header.vertexCount,
+                 cache.GetIndexData(), header.indexCount);
+    return;
   }
 
-  if (material.map_ks.GetImage()) {
-    glActiveTexture(GL_TEXTURE2);
-    material.map_kd.Bind(2);
+  if (!parseModelFromFile(filepath)) {
+    return;
   }
-
-  glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()),
-                 GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+  // Each corner used to get its own vertex, report how much we saved
+  std::cout << "Loaded " << filepath << ": " << vertices.size()
+            << " vertices for " << indices.size() << " corners ("
+            << vertices.size() * sizeof(Vertex) / 1024 << " KB instead of "
+            << indices.size() * sizeof(Vertex) / 1024 << " KB)" << std::endl;
+  glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+  if (!vertices.empty()) {
+    boundsMin = boundsMax = vertices[0].position;
+  }
+  for (const Vertex &vertex : vertices) {
+    boundsMin = glm::min(boundsMin, vertex.position);
+    boundsMax = glm::max(boundsMax, vertex.position);
+  }
+  boundsCenter = (boundsMin + boundsMax) * 0.5f;
+  boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+  buildLODs();
+  optimizeMesh();
+  materials.clear();
+  if (!materialLibraryPath.empty()) {
+    LoadMaterials(materialLibraryPath);
+  }
+  sortSubmeshes();
+  setupBuffers(vertices.data(), vertices.size(), indices.data(),
+               indices.size());
+
+  // Save what we parsed for next time. The .mtl path is stored relative
+  // to the .obj, so the pair can be moved together.
+  std::vector<MeshCache::Submesh> ranges;
+  for (const Submesh &submesh : submeshes) {
+    ranges.push_back({submesh.firstIndex, submesh.indexCount,
+                      submesh.materialName, submesh.lod});
+  }
+  MeshCache::Write(filepath, MeshCache::GetCachePath(filepath),
+                   vertices.data(), static_cast<uint32_t>(vertices.size()),
+                   sizeof(Vertex), indices.data(),
+                   static_cast<uint32_t>(indices.size()), ranges,
+                   materialLibraryPath.substr(
+                       std::min(directory.size(), materialLibraryPath.size())));
 }
 
-// Loads the model data from the specified .obj file
-void OBJModel::loadModelFromFile(const std::string &filepath) {
-  std::ifstream objFile(filepath);
-  if (!objFile.is_open()) {
+// Reads the .obj file straight out of a memory mapping, without
+// building any strings or streams along the way. Large files are split
+// into chunks at line boundaries and read on several threads:
+//   1. each thread reads the lines of its chunk into its own lists,
+//   2. a prefix sum over the list sizes tells each chunk where its
+//      positions, texture coordinates and normals start in the file,
+//   3. each thread resolves its faces against the merged lists, and
+//      builds its triangles, sharing vertices that are used by more
+//      than one corner,
+//   4. the chunks' vertices are merged (again sharing duplicates), and
+//      their indices are copied into place after a second prefix sum,
+//   5. the triangles are grouped by material, so that each material's
+//      triangles are one range of indices (a submesh).
+bool OBJModel::parseModelFromFile(const std::string &filepath,
+                                  unsigned int threadCount) {
+  MappedFile objFile;
+  if (!objFile.Open(filepath)) {
     std::cerr << "Failed to open the OBJ file: " << filepath << std::endl;
-    return;
+    return false;
   }
 
-  std::string line;
+  vertices.clear();
+  indices.clear();
+  submeshes.clear();
+  materialLibraryPath.clear();
+
+  // Split the file into one chunk per thread, each
+  // ending just after a newline.
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const char *data = reinterpret_cast<const char *>(objFile.GetData());
+  const char *fileEnd = data + objFile.GetSize();
+  std::size_t chunkCount = std::max<std::size_t>(
+      1, std::min<std::size_t>(threadCount,
+                               objFile.GetSize() / MIN_CHUNK_BYTES));
+  std::vector<OBJChunk> chunks(chunkCount);
+  const char *chunkStart = data;
+  for (std::size_t i = 0; i < chunkCount; ++i) {
+    const char *chunkEnd = fileEnd;
+    if (i + 1 < chunkCount) {
+      chunkEnd = std::max(chunkStart, data + objFile.GetSize() * (i + 1) /
+                                                 chunkCount);
+      const char *newline = static_cast<const char *>(
+          std::memchr(chunkEnd, '\n', fileEnd - chunkEnd));
+      chunkEnd = newline != nullptr ? newline + 1 : fileEnd;
+    }
+    chunks[i].begin = chunkStart;
+    chunks[i].end = chunkEnd;
+    chunkStart = chunkEnd;
+  }
+
+  // 1. Read every chunk
+  RunOnThreads(chunkCount, [&chunks](std::size_t i) { ParseChunk(chunks[i]); });
+
+  // 2. Merge the lists, each chunk's after the ones before it.
+  // Materials are numbered in the order they are first used. Faces
+  // before a chunk's first usemtl use the material the chunk before it
+  // ended with, or one with no name if there was none.
+  std::size_t positionCount = 0, texCoordCount = 0, normalCount = 0;
+  std::vector<std::string> materialNames;
+  std::unordered_map<std::string, unsigned int> materialLookup;
+  auto findMaterial = [&](const std::string &name) {
+    auto inserted = materialLookup.emplace(name, materialNames.size());
+    if (inserted.second) {
+      materialNames.push_back(name);
+    }
+    return inserted.first->second;
+  };
+  unsigned int currentMaterial = NO_MATERIAL;
+  for (OBJChunk &chunk : chunks) {
+    if (chunk.facesBeforeMaterial && currentMaterial == NO_MATERIAL) {
+      currentMaterial = findMaterial(std::string());
+    }
+    chunk.inheritedMaterial = currentMaterial;
+    for (const std::string &name : chunk.materialNames) {
+      currentMaterial = findMaterial(name);
+      chunk.materialIds.push_back(currentMaterial);
+    }
+    chunk.positionOffset = positionCount;
+    chunk.texCoordOffset = texCoordCount;
+    chunk.normalOffset = normalCount;
+    positionCount += chunk.positions.size();
+    texCoordCount += chunk.texCoords.size();
+    normalCount += chunk.normals.size();
+    if (!chunk.materialLibrary.empty()) {
+      materialLibraryPath =
+          filepath.substr(0, filepath.find_last_of("/\\") + 1) +
+          chunk.materialLibrary;
+    }
+  }
   std::vector<glm::vec3> temp_vertices;
   std::vector<glm::vec2> temp_texCoords;
   std::vector<glm::vec3> temp_normals;
+  if (chunkCount == 1) {
+    // Nothing to merge
+    temp_vertices.swap(chunks[0].positions);
+    temp_texCoords.swap(chunks[0].texCoords);
+    temp_normals.swap(chunks[0].normals);
+  } else {
+    temp_vertices.resize(positionCount);
+    temp_texCoords.resize(texCoordCount);
+    temp_normals.resize(normalCount);
+    RunOnThreads(chunkCount, [&](std::size_t i) {
+      OBJChunk &chunk = chunks[i];
+      std::copy(chunk.positions.begin(), chunk.positions.end(),
+                temp_vertices.begin() + chunk.positionOffset);
+      std::copy(chunk.texCoords.begin(), chunk.texCoords.end(),
+                temp_texCoords.begin() + chunk.texCoordOffset);
+      std::copy(chunk.normals.begin(), chunk.normals.end(),
+                temp_normals.begin() + chunk.normalOffset);
+    });
+  }
 
-  while (std::getline(objFile, line)) {
-    std::istringstream ss(line);
-    std::string prefix;
-    ss >> prefix;
+  // 3. Build the triangles of every chunk
+  RunOnThreads(chunkCount, [&](std::size_t i) {
+    BuildChunkVertices(chunks[i], temp_vertices, temp_texCoords,
+                       temp_normals);
+  });
+  // 4. Merge the vertices and indices of every chunk
+  std::size_t indexCount = 0;
+  unsigned int skippedFaces = 0;
+  for (OBJChunk &chunk : chunks) {
+    chunk.indexOffset = indexCount;
+    indexCount += chunk.indices.size();
+    skippedFaces += chunk.skippedFaces;
+  }
+  if (chunkCount == 1) {
+    vertices.swap(chunks[0].vertices);
+    indices.swap(chunks[0].indices);
+  } else {
+    // Chunks may share vertices too. Each chunk has already removed
+    // its own duplicates, so only its unique vertices are looked up.
+    std::size_t chunkVertexCount = 0;
+    for (const OBJChunk &chunk : chunks) {
+      chunkVertexCount += chunk.vertices.size();
+    }
+    VertexLookup lookup;
+    lookup.reserve(chunkVertexCount);
+    vertices.reserve(chunkVertexCount);
+    for (OBJChunk &chunk : chunks) {
+      chunk.remap.resize(chunk.vertices.size());
+      for (std::size_t v = 0; v < chunk.vertices.size(); ++v) {
+        const VertexKey &key = chunk.keys[v];
+        if (key.normal >= 0) {
+          auto inserted = lookup.emplace(key, (GLuint)vertices.size());
+          if (!inserted.second) {
+            chunk.remap[v] = inserted.first->second;
+            continue;
+          }
+        }
+        chunk.remap[v] = vertices.size();
+        vertices.push_back(chunk.vertices[v]);
+      }
+    }
+    indices.resize(indexCount);
+    RunOnThreads(chunkCount, [&](std::size_t i) {
+      OBJChunk &chunk = chunks[i];
+      for (std::size_t k = 0; k < chunk.indices.size(); ++k) {
+        indices[chunk.indexOffset + k] = chunk.remap[chunk.indices[k]];
+      }
+    });
+  }
 
-    if (prefix == "mtllib") {
-      std::string mtlFileName;
-      ss >> mtlFileName;
-      LoadMaterials(filepath.substr(0, filepath.find_last_of("/\\") + 1) +
-                    mtlFileName);
-    } else if (prefix == "usemtl") {
-      std::string matName;
-      ss >> matName;
-    } else if (prefix == "v") {
-      glm::vec3 vertex;
-      ss >> vertex.x >> vertex.y >> vertex.z;
-      temp_vertices.push_back(vertex);
-    } else if (prefix == "vt") {
-      glm::vec2 texCoord;
-      ss >> texCoord.x >> texCoord.y;
-      temp_texCoords.push_back(texCoord);
-    } else if (prefix == "vn") {
-      glm::vec3 normal;
-      ss >> normal.x >> normal.y >> normal.z;
-      temp_normals.push_back(normal);
-    } else if (prefix == "f") {
-      std::string vertex1, vertex2, vertex3;
-      unsigned int vIndex[3], uvIndex[3], nIndex[3];
-      char slash;
-
-      ss >> vertex1 >> vertex2 >> vertex3;
-      sscanf(vertex1.c_str(), "%d/%d/%d", &vIndex[0], &uvIndex[0], &nIndex[0]);
-      sscanf(vertex2.c_str(), "%d/%d/%d", &vIndex[1], &uvIndex[1], &nIndex[1]);
-      sscanf(vertex3.c_str(), "%d/%d/%d", &vIndex[2], &uvIndex[2], &nIndex[2]);
-
-      for (int i = 0; i < 3; i++) {
-        Vertex vertex;
-        vertex.position = temp_vertices[vIndex[i] - 1];
-        vertex.texCoords = temp_texCoords[uvIndex[i] - 1];
-        vertex.normal = temp_normals[nIndex[i] - 1];
-        vertices.push_back(vertex);
-        indices.push_back(vertices.size() - 1);
+  // 5. Group the triangles by material. Each material's runs are moved
+  // together, keeping the order they had in the file.
+  std::vector<std::size_t> materialStarts(materialNames.size(), 0);
+  for (const OBJChunk &chunk : chunks) {
+    for (const MaterialRun &run : chunk.runs) {
+      materialStarts[run.material] += run.indexCount;
+    }
+  }
+  std::size_t firstIndex = 0;
+  for (std::size_t m = 0; m < materialNames.size(); ++m) {
+    std::size_t count = materialStarts[m];
+    materialStarts[m] = firstIndex;
+    if (count > 0) {
+      submeshes.push_back(
+          {(GLuint)firstIndex, (GLuint)count, materialNames[m], 0, 0});
+    }
+    firstIndex += count;
+  }
+  if (submeshes.size() > 1) {
+    std::vector<GLuint> grouped(indices.size());
+    for (const OBJChunk &chunk : chunks) {
+      for (const MaterialRun &run : chunk.runs) {
+        auto source = indices.begin() + chunk.indexOffset + run.firstIndex;
+        std::copy(source, source + run.indexCount,
+                  grouped.begin() + materialStarts[run.material]);
+        materialStarts[run.material] += run.indexCount;
       }
     }
+    indices.swap(grouped);
   }
 
-  objFile.close();
-  setupBuffers();
+  if (skippedFaces > 0) {
+    std::cerr << "Skipped " << skippedFaces
+              << " faces with missing or invalid indices in: " << filepath
+              << std::endl;
+  }
+  return true;
 }
 
 // Loads the material properties from a .mtl file
@@ -153,6 +781,7 @@ void OBJModel::LoadMaterials(const std::string &mtlFilePath) {
   std::ifstream mtlFile(mtlFilePath);
   std::string line;
 
+  materials.clear();
   if (!mtlFile.is_open()) {
     std::cerr << "Could not open MTL file at " << mtlFilePath << std::endl;
     return;
@@ -161,49 +790,180 @@ void OBJModel::LoadMaterials(const std::string &mtlFilePath) {
   std::string directory =
       mtlFilePath.substr(0, mtlFilePath.find_last_of("/\\") + 1);
 
+  // Materials that name the same file share one texture
+  auto loadTexture = [&](std::istringstream &lineStream) {
+    std::string textureFile;
+    lineStream >> textureFile;
+    Texture &texture = texturesLoaded[directory + textureFile];
+    if (texture.GetImage() == nullptr) {
+      texture.LoadTexture(directory + textureFile);
+    }
+    return &texture;
+  };
+
+  // Each 'newmtl' starts a new material
+  Material *material = nullptr;
   while (getline(mtlFile, line)) {
     std::istringstream lineStream(line);
     std::string prefix;
     lineStream >> prefix;
 
-    if (prefix == "Ns") {
-      lineStream >> material.ns;
+    if (prefix == "newmtl") {
+      materials.emplace_back();
+      material = &materials.back();
+      material->name = RestOfLine(line.data() + line.find("newmtl") + 6,
+                                  line.data() + line.size());
+    } else if (material == nullptr) {
+      // Nothing before the first newmtl belongs to a material
+    } else if (prefix == "Ns") {
+      lineStream >> material->ns;
     } else if (prefix == "Ka") {
-      lineStream >> material.ka[0] >> material.ka[1] >> material.ka[2];
+      lineStream >> material->ka[0] >> material->ka[1] >> material->ka[2];
     } else if (prefix == "Kd") {
-      lineStream >> material.kd[0] >> material.kd[1] >> material.kd[2];
+      lineStream >> material->kd[0] >> material->kd[1] >> material->kd[2];
     } else if (prefix == "Ks") {
-      lineStream >> material.ks[0] >> material.ks[1] >> material.ks[2];
+      lineStream >> material->ks[0] >> material->ks[1] >> material->ks[2];
     } else if (prefix == "Ni") {
-      lineStream >> material.ni;
+      lineStream >> material->ni;
     } else if (prefix == "d") {
-      lineStream >> material.d;
+      lineStream >> material->d;
     } else if (prefix == "illum") {
-      lineStream >> material.illum;
+      lineStream >> material->illum;
     } else if (prefix == "map_Kd") {
-      std::string textureFile;
-      lineStream >> textureFile;
-      material.map_kd.LoadTexture(directory + textureFile);
+      material->map_kd = loadTexture(lineStream);
     } else if (prefix == "map_Bump") {
-      std::string textureFile;
-      lineStream >> textureFile;
-      material.map_bump.LoadTexture(directory + textureFile);
+      material->map_bump = loadTexture(lineStream);
     } else if (prefix == "map_Ks") {
-      std::string textureFile;
-      lineStream >> textureFile;
-      material.map_ks.LoadTexture(directory + textureFile);
+      material->map_ks = loadTexture(lineStream);
+    }
+  }
+
+  std::cout << "Loaded " << materials.size() << " materials and "
+            << texturesLoaded.size() << " textures from " << mtlFilePath
+            << std::endl;
+}
+
+// Simplifies each submesh of the last level on its own, so every level
+// keeps the same materials (and the edges between them stay put).
+void OBJModel::buildLODs() {
+  lodCount = 1;
+  std::vector<Submesh> previous = submeshes;
+  std::size_t previousTriangles = indices.size() / 3;
+  // Each level is simplified from the one before, so its distance from
+  // the full model is at most the sum of the steps
+  float error = 0.0f;
+  for (unsigned int lod = 1; lod < MAX_LOD_COUNT; ++lod) {
+    if (previousTriangles < LOD_MIN_TRIANGLES * 2) {
+      break;
+    }
+    std::size_t levelStart = indices.size();
+    std::vector<Submesh> level;
+    float levelError = 0.0f;
+    for (const Submesh &submesh : previous) {
+      float submeshError = 0.0f;
+      std::vector<GLuint> simplified = MeshSimplifier::Simplify(
+          indices.data() + submesh.firstIndex, submesh.indexCount,
+          vertices.data(), vertices.size(), sizeof(Vertex),
+          submesh.indexCount / 2, &submeshError);
+      level.push_back({(GLuint)indices.size(), (GLuint)simplified.size(),
+                       submesh.materialName, 0, lod});
+      indices.insert(indices.end(), simplified.begin(), simplified.end());
+      levelError = std::max(levelError, submeshError);
+    }
+    std::size_t triangles = (indices.size() - levelStart) / 3;
+    // Not worth a level of its own, or too far from the real shape
+    if (triangles > previousTriangles * LOD_MAX_KEPT ||
+        error + levelError > boundsRadius * LOD_MAX_ERROR) {
+      indices.resize(levelStart);
+      break;
+    }
+    error += levelError;
+    std::cout << "LOD " << lod << ": " << triangles << " triangles, error "
+              << error << std::endl;
+    submeshes.insert(submeshes.end(), level.begin(), level.end());
+    previous.swap(level);
+    previousTriangles = triangles;
+    lodCount = lod + 1;
+  }
+}
+
+// Reorders the triangles of each submesh so the GPU's post-transform
+// cache can reuse more vertices, then stores the vertices in the order
+// they are first drawn.
+void OBJModel::optimizeMesh() {
+  double before = MeshOptimizer::ComputeACMR(indices.data(), indices.size(),
+                                             vertices.size());
+  for (const Submesh &submesh : submeshes) {
+    MeshOptimizer::OptimizeVertexCache(indices.data() + submesh.firstIndex,
+                                       submesh.indexCount, vertices.size());
+  }
+  MeshOptimizer::OptimizeVertexFetch(vertices.data(), vertices.size(),
+                                     sizeof(Vertex), indices.data(),
+                                     indices.size());
+  double after = MeshOptimizer::ComputeACMR(indices.data(), indices.size(),
+                                            vertices.size());
+  std::cout << "Vertex cache misses per triangle (ACMR): " << before
+            << " before optimizing, " << after << " after" << std::endl;
+}
+
+// Matches each submesh to its material by name, then sorts them by
+// their textures (diffuse first, as it is the one every material has).
+void OBJModel::sortSubmeshes() {
+  std::unordered_map<std::string, unsigned int> lookup;
+  for (std::size_t m = 0; m < materials.size(); ++m) {
+    lookup.emplace(materials[m].name, m);
+  }
+  for (Submesh &submesh : submeshes) {
+    auto found = lookup.find(submesh.materialName);
+    if (found != lookup.end()) {
+      submesh.material = found->second;
+    } else if (submesh.materialName.empty() && !materials.empty()) {
+      // Faces without a usemtl get the library's first material
+      submesh.material = 0;
+    } else {
+      // Unknown names get a blank material (once per name)
+      if (!submesh.materialName.empty()) {
+        std::cerr << "Unknown material: " << submesh.materialName
+                  << std::endl;
+      }
+      submesh.material = materials.size();
+      lookup.emplace(submesh.materialName, materials.size());
+      materials.emplace_back();
+      materials.back().name = submesh.materialName;
     }
   }
 
-  Image *imageD = material.map_kd.GetImage();
-  if (imageD) {
-    std::cout << imageD->GetHeight() << " " << imageD->GetWidth() << std::endl;
-    //     imageD->PrintPixels();
+  unsigned int bindsBefore = CountTextureBinds(submeshes, materials);
+  std::less<const Texture *> before;
+  std::stable_sort(submeshes.begin(), submeshes.end(),
+                   [&](const Submesh &a, const Submesh &b) {
+                     if (a.lod != b.lod) {
+                       return a.lod < b.lod;
+                     }
+                     const Material &ma = materials[a.material];
+                     const Material &mb = materials[b.material];
+                     if (ma.map_kd != mb.map_kd) {
+                       return before(ma.map_kd, mb.map_kd);
+                     }
+                     if (ma.map_bump != mb.map_bump) {
+                       return before(ma.map_bump, mb.map_bump);
+                     }
+                     return before(ma.map_ks, mb.map_ks);
+                   });
+  if (submeshes.size() > lodCount) {
+    std::cout << submeshes.size() / lodCount << " submeshes, "
+              << CountTextureBinds(submeshes, materials)
+              << " texture binds per draw (" << bindsBefore
+              << " before sorting)" << std::endl;
   }
 }
 
 // Destructor which cleans up the allocated buffers
 OBJModel::~OBJModel() {
+  // Nothing was uploaded if no model was loaded
+  if (vao == 0) {
+    return;
+  }
   glDeleteBuffers(1, &vbo);
   glDeleteBuffers(1, &ebo);
   glDeleteVertexArrays(1, &vao);
@@ -15,8 +15,10 @@ Texture::Texture() {}
 
 // Default Destructor
 Texture::~Texture() {
-  // Delete our texture from the GPU
-  glDeleteTextures(1, &m_textureID);
+  // Delete our texture from the GPU (if one was ever created)
+  if (m_textureID != 0) {
+    glDeleteTextures(1, &m_textureID);
+  }
 
   // Delete our image
   if (m_image != nullptr) {
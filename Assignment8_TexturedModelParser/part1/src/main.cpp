@@ -20,6 +20,7 @@
 
 // Our libraries
 #include "Camera.hpp"
+#include "LODSelector.hpp"
 #include "OBJModel.hpp"
 #include "Texture.hpp"
 
@@ -73,6 +74,8 @@ GLenum gPolygonMode = GL_FILL;
 // Obj file
 OBJModel objModel;
 std::string filepath;
+// Which level of detail objModel is drawn at
+LODSelector gModelLOD;
 
 // Texture
 Texture gTexture;
@@ -394,6 +397,12 @@ void PreDraw() {
   }
 
   objModel.SetShaderMaterialUniforms(gGraphicsPipelineShaderProgram);
+
+  // Pick the level of detail from how big the model is on screen
+  float screenSize = LODSelector::ScreenSize(
+      objModel.getBoundsCenter(), objModel.getBoundsRadius(), model,
+      cameraPosition, glm::radians(45.0f));
+  gModelLOD.Select(screenSize, objModel.getLODCount());
 }
 
 /**
@@ -405,7 +414,7 @@ void PreDraw() {
  * @return void
  */
 void Draw() {
-  objModel.render();
+  objModel.render(gModelLOD.GetLOD());
   // Enable our attributes
   //   glBindVertexArray(gVertexArrayObject);
 